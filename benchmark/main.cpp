@@ -1,24 +1,34 @@
 #include <PathTrace/base.h>
 #include <PathTrace/post_processing.h>
+#include <PathTrace/photon_map.h>
 #include <PathTrace/worker.h>
 #include <PathTrace/scene/scene.h>
 #include <PathTrace/scene/object.h>
 #include <PathTrace/scene/mesh.h>
 #include <PathTrace/scene/light.h>
 #include <PathTrace/camera.h>
+#include <PathTrace/util/task_scheduler.h>
 
 #include <benchmark/benchmark.h>
 
+#include <chrono>
 #include <cstdlib>
 #include <exception>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
-void benchmarkRenderScene(benchmark::State &state, const Scene &scene, const Camera &camera) {
+void benchmarkRenderScene(benchmark::State &state, const Scene &scene, const Camera &camera, Integrator integrator = Integrator::PathTracing) {
     auto image_width = 128;
     auto image_height = 128;
     auto sample_count = 256;
 
     RenderOptions options{image_width, image_height, sample_count, sample_count, 1E-3F};
-    FrameRenderJob job{camera, scene, options};
+    FrameRenderJob job{camera, scene, options, nullptr, integrator};
 
     for(auto _ : state) {
         auto output_image = processJob(job);
@@ -31,9 +41,7 @@ void benchmarkRenderScene(benchmark::State &state, const Scene &scene, const Cam
     // state.SetBytesProcessed(image_width * image_height * sizeof(T));
 }
 
-void benchmarkRenderSceneBox(benchmark::State &state) {
-    Camera camera({0.0F, 0.0F, -3.0F}, {0.0F, 0.0F, 0.0F}, {0.0F, 1.0F, 0.0F}, 1.0F, 1.0F, -1.0F);
-
+Scene createBoxScene() {
     std::vector<std::unique_ptr<Object>> objects;
     std::vector<std::unique_ptr<LightSource>> light_sources;
 
@@ -51,14 +59,123 @@ void benchmarkRenderSceneBox(benchmark::State &state) {
     }
     moveObjects(objects, ceiling_light_objects);
 
-    Scene scene(std::move(objects), std::move(light_sources));
+    return {std::move(objects), std::move(light_sources)};
+}
+
+void benchmarkRenderSceneBox(benchmark::State &state) {
+    Camera camera({0.0F, 0.0F, -3.0F}, {0.0F, 0.0F, 0.0F}, {0.0F, 1.0F, 0.0F}, 1.0F, 1.0F, -1.0F);
+    Scene scene = createBoxScene();
 
     benchmarkRenderScene(state, scene, camera);
 }
 
-void benchmarkRenderSceneDragonBox(benchmark::State &state) {
+// Renders a scene with the given options, measuring the variance of the pixel estimates
+//  as half the mean squared difference of two images rendered with different seeds
+// The variance multiplied by the time of rendering an image is the variance at equal time up to a constant factor,
+//  which compares techniques that trade speed for noise, as the variance of unbiased estimates is inversely proportional to the sample count
+void renderSceneVariance(benchmark::State &state, const Scene &scene, const Camera &camera, const RenderOptions &options,
+                         Integrator integrator = Integrator::PathTracing) {
+    RenderOptions first_options = options;
+    RenderOptions second_options = options;
+    second_options.seed = options.seed + 1;
+
+    FrameRenderJob first_job{camera, scene, first_options, nullptr, integrator};
+    FrameRenderJob second_job{camera, scene, second_options, nullptr, integrator};
+
+    double variance_sum = 0.0;
+    double variance_time_sum = 0.0;
+    for(auto _ : state) {
+        auto start = std::chrono::steady_clock::now();
+        auto first_image = processJob(first_job);
+        auto second_image = processJob(second_job);
+        std::chrono::duration<double> image_time = (std::chrono::steady_clock::now() - start) / 2;
+
+        first_options.seed += 2;
+        second_options.seed += 2;
+
+        double squared_difference = 0.0;
+        for(int y = 0; y < options.image_height; y++) {
+            for(int x = 0; x < options.image_width; x++) {
+                auto difference = first_image(x, y) - second_image(x, y);
+                squared_difference += difference[0] * difference[0] + difference[1] * difference[1] + difference[2] * difference[2];
+            }
+        }
+        double variance = squared_difference / (2.0 * 3.0 * options.image_width * options.image_height);
+        variance_sum += variance;
+        variance_time_sum += variance * image_time.count();
+    }
+
+    state.SetItemsProcessed(state.iterations() * 2 * options.image_width * options.image_height * options.max_sample_count);
+    state.SetLabel("items are paths");
+    state.counters["variance"] = benchmark::Counter(variance_sum, benchmark::Counter::kAvgIterations);
+    state.counters["variance_time"] = benchmark::Counter(variance_time_sum, benchmark::Counter::kAvgIterations);
+}
+
+// Renders the box scene with the given options, measuring the variance of the pixel estimates
+void renderSceneBoxVariance(benchmark::State &state, const RenderOptions &options) {
+    Camera camera({0.0F, 0.0F, -3.0F}, {0.0F, 0.0F, 0.0F}, {0.0F, 1.0F, 0.0F}, 1.0F, 1.0F, -1.0F);
+    Scene scene = createBoxScene();
+
+    renderSceneVariance(state, scene, camera, options);
+}
+
+// Renders the box scene with the russian roulette settings given as arguments, which are the minimum path length,
+//  the minimum continuation probability in percent and the maximum path length
+void benchmarkRenderSceneBoxRussianRoulette(benchmark::State &state) {
+    RenderOptions options{64, 64, 16, 16, 1E-3F};
+    options.russian_roulette_min_length = static_cast<int>(state.range(0));
+    options.russian_roulette_min_probability = static_cast<float>(state.range(1)) / 100.0F;
+    options.max_path_length = static_cast<int>(state.range(2));
+
+    renderSceneBoxVariance(state, options);
+}
+
+// Renders the box scene with the sampler and sample count given as arguments
+void benchmarkRenderSceneBoxSampler(benchmark::State &state, SamplerType sampler) {
+    auto sample_count = static_cast<int>(state.range(0));
+
+    RenderOptions options{64, 64, sample_count, sample_count, 1E-3F};
+    options.sampler = sampler;
+
+    renderSceneBoxVariance(state, options);
+}
+
+// Renders the box scene with or without multiple importance sampling between light sampling and BSDF sampling,
+//  using the sample count given as argument
+void benchmarkRenderSceneBoxMIS(benchmark::State &state, bool multiple_importance_sampling) {
+    auto sample_count = static_cast<int>(state.range(0));
+
+    RenderOptions options{64, 64, sample_count, sample_count, 1E-3F};
+    options.multiple_importance_sampling = multiple_importance_sampling;
+
+    renderSceneBoxVariance(state, options);
+}
+
+// Renders many small frames of the box scene, either starting the workers for every frame or reusing the workers of a context
+void benchmarkRenderSceneBoxSmallFrames(benchmark::State &state, bool reuse_context) {
+    constexpr int frame_count = 64;
+
     Camera camera({0.0F, 0.0F, -3.0F}, {0.0F, 0.0F, 0.0F}, {0.0F, 1.0F, 0.0F}, 1.0F, 1.0F, -1.0F);
+    Scene scene = createBoxScene();
 
+    RenderOptions options{32, 32, 1, 1, 1E-3F};
+    FrameRenderJob job{camera, scene, options};
+
+    RenderContext context;
+
+    for(auto _ : state) {
+        for(int frame = 0; frame < frame_count; frame++) {
+            auto output_image = reuse_context ? context.render(job) : processJob(job);
+
+            benchmark::DoNotOptimize(output_image.data());
+        }
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * frame_count);
+}
+
+Scene createDragonBoxScene() {
     std::vector<std::unique_ptr<Object>> objects;
     std::vector<std::unique_ptr<LightSource>> light_sources;
 
@@ -99,14 +216,333 @@ void benchmarkRenderSceneDragonBox(benchmark::State &state) {
         moveObjects(objects, mesh_triangles);
     }
 
+    return {std::move(objects), std::move(light_sources)};
+}
+
+void benchmarkRenderSceneDragonBox(benchmark::State &state, Integrator integrator) {
+    Camera camera({0.0F, 0.0F, -3.0F}, {0.0F, 0.0F, 0.0F}, {0.0F, 1.0F, 0.0F}, 1.0F, 1.0F, -1.0F);
+    Scene scene = createDragonBoxScene();
+
+    benchmarkRenderScene(state, scene, camera, integrator);
+}
+
+// Renders the glass dragon scene with the given integrator, measuring the variance of the pixel estimates, which is mostly caused by the caustics
+//  that path tracing only finds by chance
+void benchmarkRenderSceneDragonBoxVariance(benchmark::State &state, Integrator integrator) {
+    Camera camera({0.0F, 0.0F, -3.0F}, {0.0F, 0.0F, 0.0F}, {0.0F, 1.0F, 0.0F}, 1.0F, 1.0F, -1.0F);
+    Scene scene = createDragonBoxScene();
+
+    RenderOptions options{64, 64, 64, 64, 1E-3F};
+
+    renderSceneVariance(state, scene, camera, options, integrator);
+}
+
+// Renders the glass dragon scene with or without path guiding, measuring the variance of the pixel estimates,
+//  where the time of rendering an image includes the training passes of the path guide
+void benchmarkRenderSceneDragonBoxGuiding(benchmark::State &state, bool path_guiding) {
+    Camera camera({0.0F, 0.0F, -3.0F}, {0.0F, 0.0F, 0.0F}, {0.0F, 1.0F, 0.0F}, 1.0F, 1.0F, -1.0F);
+    Scene scene = createDragonBoxScene();
+
+    RenderOptions options{64, 64, 64, 64, 1E-3F};
+    options.path_guiding = path_guiding;
+
+    renderSceneVariance(state, scene, camera, options);
+}
+
+void benchmarkTriangleIntersection(benchmark::State &state) {
+    constexpr int triangle_count = 1024;
+    constexpr int ray_count = 256;
+
+    RandomEngine re(1234);
+    std::uniform_real_distribution<float> dist(-1.0F, 1.0F);
+
+    std::vector<Triangle> triangles;
+    triangles.reserve(triangle_count);
+    for(int i = 0; i < triangle_count; i++) {
+        vec3<float> center{dist(re), dist(re), dist(re)};
+        triangles.emplace_back(center + vec3<float>{dist(re), dist(re), dist(re)} * 0.2F, center + vec3<float>{dist(re), dist(re), dist(re)} * 0.2F,
+                               center + vec3<float>{dist(re), dist(re), dist(re)} * 0.2F, i % 2 == 0);
+    }
+
+    std::vector<Ray> rays;
+    rays.reserve(ray_count);
+    for(int i = 0; i < ray_count; i++) {
+        rays.push_back({vec3<float>{dist(re), dist(re), -3.0F}, vec3<float>{dist(re) * 0.2F, dist(re) * 0.2F, 1.0F}.normalize()});
+    }
+
+    for(auto _ : state) {
+        for(const auto &ray : rays) {
+            for(const auto &triangle : triangles) {
+                benchmark::DoNotOptimize(triangle.getIntersection(ray));
+            }
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * triangle_count * ray_count);
+}
+
+void benchmarkTriangleSampling(benchmark::State &state) {
+    constexpr int triangle_count = 1024;
+
+    RandomEngine re(1234);
+    std::uniform_real_distribution<float> dist(-1.0F, 1.0F);
+
+    std::vector<Triangle> triangles;
+    triangles.reserve(triangle_count);
+    for(int i = 0; i < triangle_count; i++) {
+        triangles.emplace_back(vec3<float>{dist(re), dist(re), dist(re)}, vec3<float>{dist(re), dist(re), dist(re)}, vec3<float>{dist(re), dist(re), dist(re)});
+    }
+
+    for(auto _ : state) {
+        for(const auto &triangle : triangles) {
+            benchmark::DoNotOptimize(triangle.sampleSurface(re));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * triangle_count);
+}
+
+// Generates uniform random numbers in range [0, 1) in the given way, reporting the number of draws per nanosecond
+template<typename Function>
+void benchmarkRandomFloats(benchmark::State &state, Function function) {
+    constexpr int draw_count = 4096;
+
+    RandomEngine re(1234);
+
+    for(auto _ : state) {
+        float sum = 0.0F;
+        for(int i = 0; i < draw_count; i += 16) {
+            sum += function(re);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * draw_count);
+    state.counters["draws_per_ns"] = benchmark::Counter(static_cast<double>(state.iterations()) * draw_count * 1E-9, benchmark::Counter::kIsRate);
+}
+
+void benchmarkSampleLights(benchmark::State &state) {
+    constexpr int light_count = 1024;
+    constexpr int position_count = 256;
+
+    RandomEngine re(1234);
+    std::uniform_real_distribution<float> dist(-1.0F, 1.0F);
+
+    std::vector<std::unique_ptr<Object>> objects;
+    std::vector<std::unique_ptr<LightSource>> light_sources;
+
+    auto light_material = std::make_shared<ConstantMaterial>(Color<float>(1.0F, 1.0F, 1.0F, 1.0F), 1.0F, Spectrum(Color<float>{1.0F, 1.0F, 1.0F, 1.0F}));
+    auto light_material_handler = std::make_shared<ConstantMaterialHandler>(light_material, std::make_shared<LambertianBRDF>());
+
+    for(int i = 0; i < light_count; i++) {
+        vec3<float> center{dist(re), dist(re), dist(re)};
+        auto triangle = std::make_unique<Triangle>(center + vec3<float>{dist(re), dist(re), dist(re)} * 0.1F,
+                                                   center + vec3<float>{dist(re), dist(re), dist(re)} * 0.1F,
+                                                   center + vec3<float>{dist(re), dist(re), dist(re)} * 0.1F);
+        triangle->setMaterialHandler(light_material_handler);
+        objects.push_back(std::move(triangle));
+    }
+
     Scene scene(std::move(objects), std::move(light_sources));
 
-    benchmarkRenderScene(state, scene, camera);
+    std::vector<vec3<float>> positions;
+    positions.reserve(position_count);
+    for(int i = 0; i < position_count; i++) {
+        positions.push_back(vec3<float>{dist(re), dist(re), dist(re)} * 2.0F);
+    }
+
+    std::vector<LightSample> lights(scene.getMaxLightSampleCount());
+
+    for(auto _ : state) {
+        for(const auto &pos : positions) {
+            benchmark::DoNotOptimize(scene.sampleLights(pos, vec3<float>{0.0F, 1.0F, 0.0F}, re, lights));
+        }
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * position_count);
+}
+
+void benchmarkBuildPhotonMap(benchmark::State &state) {
+    constexpr int photon_count = 1 << 20;
+
+    TaskScheduler scheduler(std::max(static_cast<int>(std::thread::hardware_concurrency()), 1));
+    int worker_count = scheduler.getWorkerCount();
+
+    RandomEngine re(1234);
+    std::uniform_real_distribution<float> dist(-1.0F, 1.0F);
+
+    std::vector<std::vector<Photon>> batches(worker_count);
+    for(int i = 0; i < photon_count; i++) {
+        batches[i % worker_count].push_back({{dist(re), dist(re), dist(re)}, {0.0F, 1.0F, 0.0F}, {}});
+    }
+
+    for(auto _ : state) {
+        PhotonMap photon_map(batches, 0.01F, scheduler);
+
+        benchmark::DoNotOptimize(photon_map.size());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * photon_count);
+}
+
+// Runs many tiny tasks on all cores, either using the work-stealing scheduler or a single queue guarded by a mutex,
+//  which measures the overhead of distributing tasks over workers
+void benchmarkScheduleTasks(benchmark::State &state, bool work_stealing) {
+    const int task_count = static_cast<int>(state.range(0));
+
+    TaskScheduler scheduler(std::max(static_cast<int>(std::thread::hardware_concurrency()), 1));
+    std::vector<float> results(task_count);
+
+    auto runTask = [&](int task) {
+        float value = static_cast<float>(task);
+        for(int i = 0; i < 64; i++) {
+            value = value * 0.999F + 1.0F;
+        }
+        results[task] = value;
+    };
+
+    for(auto _ : state) {
+        if(work_stealing) {
+            scheduler.run(task_count, [&](int task, int) { runTask(task); });
+        }
+        else {
+            std::queue<int> queue;
+            for(int task = 0; task < task_count; task++) {
+                queue.push(task);
+            }
+            std::mutex mutex_queue;
+
+            std::vector<std::thread> threads;
+            for(int worker = 0; worker < scheduler.getWorkerCount(); worker++) {
+                threads.emplace_back([&]() {
+                    for(;;) {
+                        int task = 0;
+                        {
+                            std::lock_guard<std::mutex> lock(mutex_queue);
+                            if(queue.empty()) {
+                                break;
+                            }
+                            task = queue.front();
+                            queue.pop();
+                        }
+                        runTask(task);
+                    }
+                });
+            }
+            for(auto &thread : threads) {
+                thread.join();
+            }
+        }
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * task_count);
 }
 
 void registerBenchmarks() {
     benchmark::RegisterBenchmark("renderSceneBox", &benchmarkRenderSceneBox)->UseRealTime()->Unit(benchmark::TimeUnit::kMillisecond); // NOLINT
-    benchmark::RegisterBenchmark("renderSceneDragonBox", &benchmarkRenderSceneDragonBox)->UseRealTime()->Unit(benchmark::TimeUnit::kMillisecond); // NOLINT
+    benchmark::RegisterBenchmark("renderSceneBoxRussianRoulette", &benchmarkRenderSceneBoxRussianRoulette) // NOLINT
+      ->ArgNames({"min_length", "min_probability", "max_length"})
+      ->Args({4, 5, 64})
+      ->Args({1, 5, 64})
+      ->Args({8, 5, 64})
+      ->Args({4, 25, 64})
+      ->Args({4, 100, 64})
+      ->Args({4, 5, 4})
+      ->UseRealTime()
+      ->Unit(benchmark::TimeUnit::kMillisecond);
+    for(auto [name, sampler] : {std::make_pair("Independent", SamplerType::Independent), std::make_pair("Sobol", SamplerType::Sobol),
+                                std::make_pair("Halton", SamplerType::Halton), std::make_pair("BlueNoise", SamplerType::BlueNoise)}) {
+        benchmark::RegisterBenchmark((std::string("renderSceneBoxSampler") + name).c_str(), &benchmarkRenderSceneBoxSampler, sampler) // NOLINT
+          ->ArgName("sample_count")
+          ->Arg(4)
+          ->Arg(16)
+          ->Arg(64)
+          ->UseRealTime()
+          ->Unit(benchmark::TimeUnit::kMillisecond);
+    }
+    for(auto [name, multiple_importance_sampling] : {std::make_pair("MIS", true), std::make_pair("NoMIS", false)}) {
+        benchmark::RegisterBenchmark((std::string("renderSceneBox") + name).c_str(), &benchmarkRenderSceneBoxMIS, multiple_importance_sampling) // NOLINT
+          ->ArgName("sample_count")
+          ->Arg(16)
+          ->Arg(64)
+          ->UseRealTime()
+          ->Unit(benchmark::TimeUnit::kMillisecond);
+    }
+    benchmark::RegisterBenchmark("renderSceneBoxSmallFrames", &benchmarkRenderSceneBoxSmallFrames, false) // NOLINT
+      ->UseRealTime()
+      ->Unit(benchmark::TimeUnit::kMillisecond);
+    benchmark::RegisterBenchmark("renderSceneBoxSmallFramesContext", &benchmarkRenderSceneBoxSmallFrames, true) // NOLINT
+      ->UseRealTime()
+      ->Unit(benchmark::TimeUnit::kMillisecond);
+    benchmark::RegisterBenchmark("renderSceneDragonBox", &benchmarkRenderSceneDragonBox, Integrator::PathTracing) // NOLINT
+      ->UseRealTime()
+      ->Unit(benchmark::TimeUnit::kMillisecond);
+    benchmark::RegisterBenchmark("renderSceneDragonBoxBidirectional", &benchmarkRenderSceneDragonBox, Integrator::Bidirectional) // NOLINT
+      ->UseRealTime()
+      ->Unit(benchmark::TimeUnit::kMillisecond);
+    benchmark::RegisterBenchmark("renderSceneDragonBoxPhotonMapping", &benchmarkRenderSceneDragonBox, Integrator::PhotonMapping) // NOLINT
+      ->UseRealTime()
+      ->Unit(benchmark::TimeUnit::kMillisecond);
+    benchmark::RegisterBenchmark("renderSceneDragonBoxMetropolis", &benchmarkRenderSceneDragonBox, Integrator::Metropolis) // NOLINT
+      ->UseRealTime()
+      ->Unit(benchmark::TimeUnit::kMillisecond);
+    benchmark::RegisterBenchmark("renderSceneDragonBoxVariance", &benchmarkRenderSceneDragonBoxVariance, Integrator::PathTracing) // NOLINT
+      ->UseRealTime()
+      ->Unit(benchmark::TimeUnit::kMillisecond);
+    benchmark::RegisterBenchmark("renderSceneDragonBoxVarianceBidirectional", &benchmarkRenderSceneDragonBoxVariance, Integrator::Bidirectional) // NOLINT
+      ->UseRealTime()
+      ->Unit(benchmark::TimeUnit::kMillisecond);
+    for(auto [name, path_guiding] : {std::make_pair("Guiding", true), std::make_pair("NoGuiding", false)}) {
+        benchmark::RegisterBenchmark((std::string("renderSceneDragonBox") + name).c_str(), &benchmarkRenderSceneDragonBoxGuiding, path_guiding) // NOLINT
+          ->UseRealTime()
+          ->Unit(benchmark::TimeUnit::kMillisecond);
+    }
+    benchmark::RegisterBenchmark("triangleIntersection", &benchmarkTriangleIntersection)->Unit(benchmark::TimeUnit::kMicrosecond); // NOLINT
+    benchmark::RegisterBenchmark("triangleSampling", &benchmarkTriangleSampling)->Unit(benchmark::TimeUnit::kMicrosecond); // NOLINT
+    benchmark::RegisterBenchmark("randomFloatsDistribution", &benchmarkRandomFloats<float (*)(RandomEngine &)>, // NOLINT
+                                 [](RandomEngine &re) {
+                                     std::uniform_real_distribution<float> dist(0, 1);
+
+                                     float sum = 0.0F;
+                                     for(int i = 0; i < 16; i++) {
+                                         sum += dist(re);
+                                     }
+                                     return sum;
+                                 })
+      ->Unit(benchmark::TimeUnit::kMicrosecond);
+    benchmark::RegisterBenchmark("randomFloats", &benchmarkRandomFloats<float (*)(RandomEngine &)>, // NOLINT
+                                 [](RandomEngine &re) {
+                                     float sum = 0.0F;
+                                     for(int i = 0; i < 16; i++) {
+                                         sum += re.getFloat();
+                                     }
+                                     return sum;
+                                 })
+      ->Unit(benchmark::TimeUnit::kMicrosecond);
+    benchmark::RegisterBenchmark("randomFloatsBatch", &benchmarkRandomFloats<float (*)(RandomEngine &)>, // NOLINT
+                                 [](RandomEngine &re) {
+                                     auto values = re.getFloats<16>();
+
+                                     float sum = 0.0F;
+                                     for(float value : values) {
+                                         sum += value;
+                                     }
+                                     return sum;
+                                 })
+      ->Unit(benchmark::TimeUnit::kMicrosecond);
+    benchmark::RegisterBenchmark("sampleLights", &benchmarkSampleLights)->Unit(benchmark::TimeUnit::kMicrosecond); // NOLINT
+    benchmark::RegisterBenchmark("buildPhotonMap", &benchmarkBuildPhotonMap)->UseRealTime()->Unit(benchmark::TimeUnit::kMillisecond); // NOLINT
+    benchmark::RegisterBenchmark("scheduleTasksMutexQueue", &benchmarkScheduleTasks, false) // NOLINT
+      ->Arg(1 << 16)
+      ->UseRealTime()
+      ->Unit(benchmark::TimeUnit::kMillisecond);
+    benchmark::RegisterBenchmark("scheduleTasksWorkStealing", &benchmarkScheduleTasks, true) // NOLINT
+      ->Arg(1 << 16)
+      ->UseRealTime()
+      ->Unit(benchmark::TimeUnit::kMillisecond);
 }
 
 int main(int argc, char *argv[]) {
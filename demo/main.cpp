@@ -4,6 +4,7 @@
 #include <PathTrace/scene/scene.h>
 #include <PathTrace/scene/object.h>
 #include <PathTrace/scene/mesh.h>
+#include <PathTrace/scene/lod.h>
 #include <PathTrace/scene/light.h>
 #include <PathTrace/camera.h>
 #include <PathTrace/image/image_io.h>
@@ -148,13 +149,6 @@ int main(int argc, char *argv[]) {
 
         auto mesh_triangles = io::loadMesh("assets/xyzrgb_dragon.obj", transformation, false, true);
 
-        auto dragon_material = std::make_shared<ConstantMaterial>(Color<float>(1.0F, 1.0F, 1.0F, 1.0F), 1.5F);
-        auto dragon_material_handler = std::make_shared<ConstantMaterialHandler>(dragon_material, glass_bdf);
-
-        for(auto &triangle : mesh_triangles) {
-            triangle.setMaterialHandler(dragon_material_handler);
-        }
-
         if(mesh_triangles.empty()) {
             std::cerr << "Failed to load triangle mesh at assets/xyzrgb_dragon.obj (check the working directory of this program and existence of the obj file)"
                       << std::endl;
@@ -162,7 +156,20 @@ int main(int argc, char *argv[]) {
             return EXIT_FAILURE;
         }
 
-        moveObjects(objects, mesh_triangles);
+        // Render the dragon with a level of detail matching its size in the image, simplifying it only to that single level
+        auto dragon_triangle_count = getLODTriangleCount(mesh_triangles, camera, height);
+        auto dragon_triangles = dragon_triangle_count < static_cast<int>(mesh_triangles.size())
+                                  ? simplifyMesh(mesh_triangles, dragon_triangle_count, false, true)
+                                  : std::move(mesh_triangles);
+
+        auto dragon_material = std::make_shared<ConstantMaterial>(Color<float>(1.0F, 1.0F, 1.0F, 1.0F), 1.5F);
+        auto dragon_material_handler = std::make_shared<ConstantMaterialHandler>(dragon_material, glass_bdf);
+
+        for(auto &triangle : dragon_triangles) {
+            triangle.setMaterialHandler(dragon_material_handler);
+        }
+
+        moveObjects(objects, dragon_triangles);
     }
 
     {
@@ -189,7 +196,7 @@ int main(int argc, char *argv[]) {
                                    vec4<float>{0.0F, 0.0F, 0.0F, 1.0F}};
 
         for(auto &triangle : box_triangles) {
-            transformed_triangles.emplace_back(transformation * triangle.a, transformation * triangle.b, transformation * triangle.c);
+            transformed_triangles.emplace_back(transformation * triangle.getA(), transformation * triangle.getB(), transformation * triangle.getC());
         }
 
         auto box_material = std::make_shared<ConstantMaterial>(Color<float>(1.0F, 1.0F, 1.0F, 1.0F));
@@ -202,7 +209,11 @@ int main(int argc, char *argv[]) {
         moveObjects(objects, transformed_triangles);
     }
 
-    Scene scene(std::move(objects), std::move(light_sources));
+    // Most of the large ground and ceiling planes are never seen, so only build the BVH where rays actually go
+    SceneOptions scene_options;
+    scene_options.lazy_bvh = true;
+
+    Scene scene(std::move(objects), std::move(light_sources), scene_options);
 
     RenderOptions options{width, height, min_sample_count, max_sample_count, epsilon, true};
 
@@ -17,5 +17,13 @@ extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data, std::size_t size
     catch(const std::logic_error &e) {
     }
 
+    std::istringstream hdr_data_stream(data_string);
+
+    try {
+        auto image = io::readHDRImage(hdr_data_stream);
+    }
+    catch(const std::logic_error &e) {
+    }
+
     return EXIT_SUCCESS;
 }
@@ -4,6 +4,10 @@
 #include <PathTrace/util/vector.h>
 #include <PathTrace/util/matrix.h>
 
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
 #include <random>
 #include <cassert>
 #include <cmath>
@@ -25,13 +29,21 @@ class xorshift {
   public:
     xorshift(uint64_t seed) noexcept : m_seed(seed ^ (~seed << 32)) {}
 
-    uint32_t operator()() noexcept {
+    uint32_t operator()() noexcept { return static_cast<uint32_t>(this->next64() >> 32); }
+
+    /**
+     * Generates 64 random bits at once, whose upper half is the result of operator()
+     * The lowest bits are of lower quality, so only the upper bits of each half should be used
+     *
+     * @return Random bits
+     */
+    uint64_t next64() noexcept {
         uint64_t result = m_seed * 0xD989BCACC137DCD5LLU;
         m_seed ^= m_seed >> 11;
         m_seed ^= m_seed << 31;
         m_seed ^= m_seed >> 18;
 
-        return static_cast<uint32_t>(result >> 32);
+        return result;
     }
 
     static constexpr uint32_t min() noexcept { return std::numeric_limits<uint32_t>::min(); }
@@ -41,17 +53,154 @@ class xorshift {
     uint64_t m_seed;
 };
 
+/**
+ * Interface for sequences of random bits that replace those generated by a RandomEngine,
+ *  such as primary samples mutated by Metropolis light transport
+ */
+class RandomSequence {
+  public:
+    virtual ~RandomSequence() = default;
+
+    /**
+     * Returns the next random bits of the sequence
+     *
+     * @return Random bits
+     */
+    virtual uint32_t next() noexcept = 0;
+
+    /**
+     * Returns the dimension that the next bits are drawn from, for sequences whose bits are indexed by dimensions
+     *
+     * @return Dimension of the next bits, or 0 for sequences without dimensions
+     */
+    virtual uint32_t getDimension() const noexcept { return 0; }
+
+    /**
+     * Continues the sequence at a dimension, such that a decision draws from the same dimension no matter how many bits were drawn before it
+     * Sequences without dimensions ignore this
+     *
+     * @param dimension Dimension of the next bits
+     */
+    virtual void setDimension([[maybe_unused]] uint32_t dimension) noexcept {}
+
+    /**
+     * Returns random bits that do not consume a dimension, for consumers drawing a varying number of values such as rejection sampling
+     *
+     * @return Random bits
+     */
+    virtual uint32_t nextIndependent() noexcept { return this->next(); }
+};
+
 /**
  * Wrapper class for generating random bits
  */
 class RandomEngine {
   private:
     xorshift engine;
+    //! Non-owning raw pointer to a sequence that replaces the generated bits, or nullptr
+    RandomSequence *sequence = nullptr;
 
   public:
     RandomEngine(auto seed) noexcept : engine(seed) {}
 
-    auto operator()() noexcept { return this->engine(); }
+    auto operator()() noexcept { return this->sequence != nullptr ? this->sequence->next() : this->engine(); }
+
+    /**
+     * Replaces the generated bits by those of a sequence, which must outlive its use by this engine
+     *
+     * @param sequence Sequence providing all further bits, or nullptr to generate bits again
+     */
+    void setSequence(RandomSequence *sequence) noexcept { this->sequence = sequence; }
+
+    /**
+     * Returns the dimension of the sequence that the next bits are drawn from
+     *
+     * @return Dimension of the next bits, or 0 without a sequence
+     */
+    uint32_t getDimension() const noexcept { return this->sequence != nullptr ? this->sequence->getDimension() : 0; }
+
+    /**
+     * Continues the sequence at a dimension, which has no effect without a sequence
+     *
+     * @param dimension Dimension of the next bits
+     */
+    void setDimension(uint32_t dimension) noexcept {
+        if(this->sequence != nullptr) {
+            this->sequence->setDimension(dimension);
+        }
+    }
+
+    /**
+     * Converts random bits to a uniformly distributed number in range (0, 1), by using their upper 23 bits as the mantissa
+     *  of a float in range [1, 2) and returning the center of the corresponding interval, which is exact and never 0 or 1
+     *
+     * @param bits Random bits
+     * @return Random number
+     */
+    static float toFloat(uint32_t bits) noexcept { return std::bit_cast<float>(0x3F800000U | (bits >> 9)) - (1.0F - 0x1p-24F); }
+
+    /**
+     * Generates a uniformly distributed number in range (0, 1), consuming one draw of random bits
+     * This is much faster than std::uniform_real_distribution, whose results are rounded to the same precision anyway
+     *
+     * @return Random number
+     */
+    float getFloat() noexcept { return toFloat((*this)()); }
+
+    /**
+     * Generates several uniformly distributed numbers in range (0, 1) at once, where the i-th number consumes the i-th draw of a sequence
+     * Without a sequence, each step of the engine provides the bits of two numbers, and the conversion of all numbers is vectorized
+     *
+     * @tparam N Number of random numbers
+     * @return Random numbers
+     */
+    template<std::size_t N>
+    std::array<float, N> getFloats() noexcept {
+        std::array<uint32_t, N> bits; // NOLINT(cppcoreguidelines-pro-type-member-init)
+        if(this->sequence != nullptr) {
+            for(auto &value : bits) {
+                value = this->sequence->next();
+            }
+        }
+        else {
+            for(std::size_t i = 0; i + 1 < N; i += 2) {
+                auto pair = this->engine.next64();
+                bits[i] = static_cast<uint32_t>(pair >> 32);
+                bits[i + 1] = static_cast<uint32_t>(pair);
+            }
+            if constexpr(N % 2 != 0) {
+                bits[N - 1] = this->engine();
+            }
+        }
+
+        std::array<float, N> values; // NOLINT(cppcoreguidelines-pro-type-member-init)
+        for(std::size_t i = 0; i < N; i++) {
+            values[i] = toFloat(bits[i]);
+        }
+
+        return values;
+    }
+
+    /**
+     * Generates several uniformly distributed numbers in range (0, 1) that do not consume dimensions of the sequence,
+     *  for consumers drawing a varying number of values, which would otherwise shift the dimensions of all later decisions
+     *
+     * @tparam N Number of random numbers
+     * @return Random numbers
+     */
+    template<std::size_t N>
+    std::array<float, N> getIndependentFloats() noexcept {
+        if(this->sequence == nullptr) {
+            return this->getFloats<N>();
+        }
+
+        std::array<float, N> values; // NOLINT(cppcoreguidelines-pro-type-member-init)
+        for(auto &value : values) {
+            value = toFloat(this->sequence->nextIndependent());
+        }
+
+        return values;
+    }
 
     static constexpr auto min() noexcept { return decltype(engine)::min(); }
     static constexpr auto max() noexcept { return decltype(engine)::max(); }
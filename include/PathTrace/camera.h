@@ -121,6 +121,41 @@ class Camera {
      *  contributes to the light measured by the virtual image sensor at the specified coordinates
      */
     Ray shootRay(float x, float y, float pixel_width, float pixel_height, RandomEngine &re) const noexcept;
+
+    /**
+     * Approximates the extent of a sphere in the scene once projected onto the virtual image sensor
+     *
+     * @param center Center of the sphere
+     * @param radius Radius of the sphere
+     * @return Projected diameter of the sphere relative to the height of the image sensor,
+     *  or infinity if the sphere contains the camera origin or extends behind the camera
+     */
+    float getProjectedSize(vec3<float> center, float radius) const noexcept;
+
+    /**
+     * Returns whether all rays shot by the camera originate at its origin, so that points in the scene
+     *  can be projected onto the virtual image sensor, which is the case for cameras without an aperture
+     *
+     * @return True if the camera has no aperture, False otherwise
+     */
+    bool isPinhole() const noexcept;
+
+    /**
+     * Returns the origin of the camera, where all rays of a pinhole camera originate
+     *
+     * @return Origin of the camera
+     */
+    vec3<float> getOrigin() const noexcept;
+
+    /**
+     * Projects a direction pointing out of the camera origin onto the virtual image sensor
+     *
+     * @param dir Direction pointing out of the camera origin into the scene, of length 1
+     * @return Tuple of the x and y coordinates on the image sensor as passed to shootRay, and the probability density with respect to
+     *  solid angle of shooting a ray in the direction if the sensor position is chosen uniformly over the whole image sensor,
+     *  which is 0 if the direction does not fall onto the image sensor
+     */
+    std::tuple<float, float, float> projectDirection(vec3<float> dir) const noexcept;
 };
 
 #endif /* PATHTRACE_CAMERA_H */
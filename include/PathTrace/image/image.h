@@ -73,6 +73,85 @@ class Image {
     std::vector<T> data_;
 };
 
+/**
+ * A non-owning view of a rectangular region of an image, whose rows are a fixed number of values apart in memory
+ * Views let functions operate on whole images and on parts of them, such as the tiles rendered by each worker,
+ *  without allocating or copying values
+ *
+ * @tparam T The type of values stored in each grid cell, which is const for read-only views
+ */
+template<typename T = Color<float>>
+class ImageView {
+  public:
+    using value_type = std::remove_const_t<T>;
+
+    /**
+     * Constructs a view of values stored row by row
+     *
+     * @param data Pointer to the first value of the first row
+     * @param width The width of the view
+     * @param height The height of the view
+     * @param stride Number of values from the start of one row to the start of the next one
+     */
+    ImageView(T *data, int width, int height, std::ptrdiff_t stride) noexcept;
+
+    /**
+     * Constructs a view of a whole image, which must outlive the view
+     *
+     * @param image The image
+     */
+    ImageView(std::conditional_t<std::is_const_v<T>, const Image<value_type>, Image<value_type>> &image) noexcept; // NOLINT(google-explicit-constructor)
+
+    /**
+     * Constructs a read-only view of the same values as a writable view
+     *
+     * @param view The writable view
+     */
+    template<typename U>
+    requires(std::is_const_v<T> && std::is_same_v<U, value_type>)
+    ImageView(ImageView<U> view) noexcept : ImageView(view.data(), view.getWidth(), view.getHeight(), view.getStride()) {} // NOLINT
+
+    /**
+     * Provides a reference to the image value at the specified cell
+     *
+     * @param x x-position of the cell
+     * @param y y-position of the cell
+     * @return Reference to the value stored at the cell
+     */
+    T &operator()(int x, int y) const noexcept;
+
+    /**
+     * Returns a view of a rectangular region of this view, which must lie within this view
+     *
+     * @param x x-position of the first cell of the region
+     * @param y y-position of the first cell of the region
+     * @param width The width of the region
+     * @param height The height of the region
+     * @return View of the region
+     */
+    ImageView getRegion(int x, int y, int width, int height) const noexcept;
+
+    /**
+     * Returns a pointer to the first value of a row, after which the values of the row are stored contiguously
+     *
+     * @param y y-position of the row
+     * @return Pointer to the row
+     */
+    T *getRow(int y) const noexcept;
+
+    T *data() const noexcept;
+
+    int getWidth() const noexcept;
+    int getHeight() const noexcept;
+    std::ptrdiff_t getStride() const noexcept;
+
+  private:
+    T *data_;
+    int width;
+    int height;
+    std::ptrdiff_t stride;
+};
+
 template<typename T>
 Image<T>::Image(int width, int height) : width(width), height(height), data_(width * height) {}
 
@@ -121,4 +200,51 @@ int Image<T>::getHeight() const noexcept {
     return height;
 }
 
+template<typename T>
+ImageView<T>::ImageView(T *data, int width, int height, std::ptrdiff_t stride) noexcept : data_(data), width(width), height(height), stride(stride) {
+    assert(width >= 0 && height >= 0 && stride >= width);
+}
+
+template<typename T>
+ImageView<T>::ImageView(std::conditional_t<std::is_const_v<T>, const Image<value_type>, Image<value_type>> &image) noexcept :
+  ImageView(image.data(), image.getWidth(), image.getHeight(), image.getWidth()) {}
+
+template<typename T>
+T &ImageView<T>::operator()(int x, int y) const noexcept {
+    assert(x >= 0 && x < width && y >= 0 && y < height);
+    return data_[y * stride + x];
+}
+
+template<typename T>
+ImageView<T> ImageView<T>::getRegion(int x, int y, int width, int height) const noexcept {
+    assert(x >= 0 && y >= 0 && width >= 0 && height >= 0 && x + width <= this->width && y + height <= this->height);
+    return ImageView(data_ + y * stride + x, width, height, stride);
+}
+
+template<typename T>
+T *ImageView<T>::getRow(int y) const noexcept {
+    assert(y >= 0 && y < height);
+    return data_ + y * stride;
+}
+
+template<typename T>
+T *ImageView<T>::data() const noexcept {
+    return data_;
+}
+
+template<typename T>
+int ImageView<T>::getWidth() const noexcept {
+    return width;
+}
+
+template<typename T>
+int ImageView<T>::getHeight() const noexcept {
+    return height;
+}
+
+template<typename T>
+std::ptrdiff_t ImageView<T>::getStride() const noexcept {
+    return stride;
+}
+
 #endif /* PATHTRACE_IMAGE_H */
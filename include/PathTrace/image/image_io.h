@@ -46,30 +46,60 @@ namespace io {
      * Individual color channel values will be mapped from the range [0, 1]
      *
      * @param stream The stream to encode the image to
-     * @param image The image to encode
+     * @param image View of the image to encode
      * @throw std::logic_error when encoding fails
      */
-    void writeRGBImage(std::basic_ostream<char> &stream, const Image<Color<float>> &image) noexcept(false);
+    void writeRGBImage(std::basic_ostream<char> &stream, ImageView<const Color<float>> image) noexcept(false);
 
     /**
      * Writes a 2D RGBA image to the file specified by the given path
      * Individual color channel values will be mapped from the range [0, 1]
      *
      * @param path The path to the target file
-     * @param image The image to encode
+     * @param image View of the image to encode
      * @throw std::logic_error when encoding fails
      */
-    void writeRGBImage(const std::string &path, const Image<Color<float>> &image) noexcept(false);
+    void writeRGBImage(const std::string &path, ImageView<const Color<float>> image) noexcept(false);
 
     /**
      * Writes a 2D RGBA image to the file specified by the given path
      * Individual color channel values will be mapped from the range [0, 1]
      *
      * @param path The path to the target file
-     * @param image The image to encode
+     * @param image View of the image to encode
      * @throw std::logic_error when encoding fails
      */
-    void writeRGBImage(const std::filesystem::path &path, const Image<Color<float>> &image) noexcept(false);
+    void writeRGBImage(const std::filesystem::path &path, ImageView<const Color<float>> image) noexcept(false);
+
+    /**
+     * Attempts to read a 2D high dynamic range RGB image in the Portable Float Map (PFM) format from an input stream
+     * Color channel values are read as is without any mapping, and the alpha channel is set to 1
+     *
+     * @param stream Input stream to read from
+     * @return The decoded image
+     * @throw std::logic_error when decoding fails
+     */
+    Image<Color<float>> readHDRImage(std::basic_istream<char> &stream) noexcept(false);
+
+    /**
+     * Attempts to read a 2D high dynamic range RGB image in the Portable Float Map (PFM) format from the file specified by the given path
+     * Color channel values are read as is without any mapping, and the alpha channel is set to 1
+     *
+     * @param path Path to the image file
+     * @return The decoded image
+     * @throw std::logic_error when decoding fails
+     */
+    Image<Color<float>> readHDRImage(const std::string &path) noexcept(false);
+
+    /**
+     * Attempts to read a 2D high dynamic range RGB image in the Portable Float Map (PFM) format from the file specified by the given path
+     * Color channel values are read as is without any mapping, and the alpha channel is set to 1
+     *
+     * @param path Path to the image file
+     * @return The decoded image
+     * @throw std::logic_error when decoding fails
+     */
+    Image<Color<float>> readHDRImage(const std::filesystem::path &path) noexcept(false);
 
 } // namespace io
 
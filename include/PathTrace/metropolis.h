@@ -0,0 +1,85 @@
+#ifndef PATHTRACE_METROPOLIS_H
+#define PATHTRACE_METROPOLIS_H
+
+#include <PathTrace/base.h>
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * The state of a Markov chain of primary sample space Metropolis light transport, as proposed by Kelemen et al.
+ *
+ * A path is defined by the sequence of uniformly distributed primary samples that its sampling routine consumes.
+ * Each iteration proposes a mutation of these samples, which either replaces all of them by new independent samples (a large step),
+ *  or perturbs each of them slightly (a small step), so that paths close to a bright path are explored.
+ * Samples are only mutated when they are consumed, so that the number of samples used by a path does not need to be known in advance.
+ */
+class PrimarySampleSequence : public RandomSequence {
+  private:
+    struct PrimarySample {
+        //! Current value in range [0, 1)
+        float value;
+        //! Iteration in which the value was last mutated
+        std::int64_t last_modification;
+        //! Value and iteration of the last mutation before the current iteration, restored if the mutation is rejected
+        float value_backup;
+        std::int64_t modification_backup;
+    };
+
+    RandomEngine re;
+
+    float mutation_size;
+    float large_step_probability;
+
+    std::vector<PrimarySample> samples;
+    std::size_t sample_index = 0;
+
+    std::int64_t current_iteration = 0;
+    bool large_step = true;
+    std::int64_t last_large_step_iteration = 0;
+
+    void mutate(std::size_t index) noexcept;
+    float getNormal() noexcept;
+
+  public:
+    /**
+     * Constructs the state of a chain, whose first path is sampled independently
+     * The first path of two sequences constructed with the same seed is the same
+     *
+     * @param seed Seed of the random engine used for mutations
+     * @param mutation_size Standard deviation of the perturbation of each sample by small steps
+     * @param large_step_probability Probability of proposing a large step rather than a small step
+     */
+    PrimarySampleSequence(std::uint64_t seed, float mutation_size, float large_step_probability);
+
+    /**
+     * Starts proposing a mutation of the current path, where samples are mutated once they are consumed
+     */
+    void startIteration() noexcept;
+
+    /**
+     * Makes the proposed mutation the current path
+     */
+    void accept() noexcept;
+
+    /**
+     * Restores the samples of the current path, discarding the proposed mutation
+     */
+    void reject() noexcept;
+
+    /**
+     * Returns the next primary sample of the current path, mutating it if it was not consumed yet in this iteration
+     *
+     * @return Uniformly distributed value in range [0, 1)
+     */
+    float nextSample() noexcept;
+
+    /**
+     * Returns the next primary sample of the current path as random bits
+     *
+     * @return Random bits
+     */
+    uint32_t next() noexcept override;
+};
+
+#endif // PATHTRACE_METROPOLIS_H
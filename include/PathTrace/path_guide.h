@@ -0,0 +1,132 @@
+#ifndef PATHTRACE_PATH_GUIDE_H
+#define PATHTRACE_PATH_GUIDE_H
+
+#include <PathTrace/base.h>
+#include <PathTrace/scene/bounding_box.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * A spatio-directional cache of incident radiance which is learned while rendering,
+ *  and is used to sample directions towards where light actually comes from
+ *
+ * Space is subdivided by a binary tree whose leaves each hold a quadtree over the sphere of directions,
+ *  parameterized by an area-preserving cylindrical mapping
+ * Radiance estimates of one training iteration are recorded concurrently into the trees,
+ *  and update() then refines both trees where enough energy or samples were recorded and makes the recorded
+ *  distribution available for sampling in the next iteration
+ */
+class PathGuide {
+  private:
+    class DirectionalTree {
+      private:
+        struct Node {
+            //! Energy of each quadrant of the node
+            std::array<float, 4> sums;
+            //! Index of the child node of each quadrant, or 0 if the quadrant is a leaf
+            std::array<int, 4> children;
+        };
+
+        //! Nodes used for sampling, where the root node is the first node
+        std::vector<Node> nodes;
+        //! Energy recorded into each quadrant of each node during the current iteration
+        std::unique_ptr<std::atomic<float>[]> recorded_sums;
+
+        int buildRefined(const DirectionalTree &source, int source_index, std::array<float, 4> sums, float total, float threshold, int depth);
+
+      public:
+        //! Number of samples recorded during the current iteration
+        std::atomic<std::int64_t> sample_count = 0;
+
+        DirectionalTree();
+
+        void record(float x, float y, float weight) noexcept;
+        std::tuple<float, float, float> sample(float u1, float u2) const noexcept;
+        float getPdf(float x, float y) const noexcept;
+
+        /**
+         * Constructs a tree from the energy recorded into another tree, subdividing quadrants holding more than
+         *  the given fraction of the total energy and collapsing those holding less
+         */
+        void refine(const DirectionalTree &source, float threshold);
+        float getRecordedEnergy() const noexcept;
+        bool hasEnergy() const noexcept;
+    };
+
+    struct SpatialNode {
+        //! Bounds of the region covered by the node
+        AABBArea area;
+        //! Index of the first child, with the second child directly following it, or 0 if the node is a leaf
+        int children;
+        //! Axis along which an inner node is split in half
+        int axis;
+        //! For leaves the index of the directional tree
+        int tree;
+    };
+
+    std::vector<SpatialNode> spatial_nodes;
+    std::vector<std::unique_ptr<DirectionalTree>> directional_trees;
+
+    std::int64_t spatial_split_threshold;
+    bool trained = false;
+
+    int getDirectionalTreeIndex(vec3<float> pos) const noexcept;
+
+  public:
+    /**
+     * Constructs an untrained path guide covering the given region
+     *
+     * @param area Region of space in which radiance is recorded and directions are sampled, typically the bounds of the scene
+     * @param spatial_split_threshold Number of samples recorded in a region during one iteration above which the region is subdivided
+     */
+    explicit PathGuide(AABBArea area, std::int64_t spatial_split_threshold = 4000);
+
+    /**
+     * Returns whether radiance has been learned, so that the guide can be used for sampling
+     *
+     * @return True if the guide is trained, False otherwise
+     */
+    bool isTrained() const noexcept;
+
+    /**
+     * Records an estimate of the radiance arriving at a position from a direction, which may be called concurrently
+     *
+     * @param pos Position receiving the radiance
+     * @param dir Direction the radiance arrives from, of length 1
+     * @param weight Radiance estimate divided by the probability density of sampling the direction
+     */
+    void record(vec3<float> pos, vec3<float> dir, float weight) noexcept;
+
+    /**
+     * Finishes a training iteration, refining the guide using the radiance recorded during the iteration
+     *  and making the learned distribution available for sampling
+     * This must not be called concurrently with any other method
+     */
+    void update();
+
+    /**
+     * Samples a direction proportionally to the learned incident radiance at a position
+     *
+     * @param pos Position to sample a direction from
+     * @param u1 Uniformly distributed value in range [0, 1)
+     * @param u2 Uniformly distributed value in range [0, 1)
+     * @return Tuple of the sampled direction and the probability density with respect to solid angle
+     */
+    std::tuple<vec3<float>, float> sample(vec3<float> pos, float u1, float u2) const noexcept;
+
+    /**
+     * Computes the probability density of sample returning the given direction
+     *
+     * @param pos Position the direction is sampled from
+     * @param dir Sampled direction, of length 1
+     * @return Probability density with respect to solid angle
+     */
+    float getPdf(vec3<float> pos, vec3<float> dir) const noexcept;
+};
+
+#endif // PATHTRACE_PATH_GUIDE_H
@@ -0,0 +1,103 @@
+#ifndef PATHTRACE_PHOTON_MAP_H
+#define PATHTRACE_PHOTON_MAP_H
+
+#include <PathTrace/base.h>
+#include <PathTrace/scene/light.h>
+#include <PathTrace/util/task_scheduler.h>
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+/**
+ * POD struct representing light arriving at a surface, deposited while tracing a path from a light
+ */
+struct Photon {
+    vec3<float> pos;
+    //! Direction the photon travelled in when arriving at the position, of length 1
+    vec3<float> dir;
+    //! Power carried by the photon, divided by the probability density of sampling its path
+    Spectrum power;
+};
+
+/**
+ * Photons sorted into a uniform grid of cells, which are stored in a hash table of buckets so that memory only depends on the number of photons
+ *
+ * The grid is built by a counting sort over the buckets, where photons are counted, assigned their final position and moved
+ *  concurrently by several threads, so that photon maps can be rebuilt quickly for every pass of progressive photon mapping
+ * Photons are first sorted into a fixed number of groups of consecutive buckets and then each group into its buckets,
+ *  so building temporarily takes memory proportional to the number of photons, plus a fixed amount per worker
+ */
+class PhotonMap {
+  private:
+    float cell_size = 1.0F;
+
+    //! Photons sorted by their bucket
+    std::vector<Photon> photons;
+    //! Index of the first photon of each bucket, followed by the total number of photons
+    std::vector<std::size_t> bucket_starts;
+
+    std::array<int, 3> getCell(vec3<float> pos) const noexcept;
+    std::size_t getBucket(std::array<int, 3> cell) const noexcept;
+
+  public:
+    PhotonMap() = default;
+
+    /**
+     * Constructs a photon map from batches of photons, which are typically traced by separate threads
+     * The photons of each cell are stored in the order of the batches, independently of the number of workers
+     *
+     * @param batches Photons to store, split into batches that are sorted into cells concurrently
+     * @param cell_size Edge length of the grid cells, which should not be smaller than the radius used for gathering
+     * @param scheduler Scheduler running the tasks of sorting each batch
+     */
+    PhotonMap(const std::vector<std::vector<Photon>> &batches, float cell_size, TaskScheduler &scheduler);
+
+    /**
+     * Returns the number of photons stored
+     *
+     * @return Number of photons
+     */
+    std::size_t size() const noexcept;
+
+    /**
+     * Calls a function for every photon within a radius around a position
+     *
+     * @param pos Position to gather photons around
+     * @param radius Gather radius, which should not be larger than the cell size for gathering to be efficient
+     * @param callback Function called with a reference to each photon found
+     */
+    template<typename F>
+    void gather(vec3<float> pos, float radius, F &&callback) const;
+};
+
+template<typename F>
+void PhotonMap::gather(vec3<float> pos, float radius, F &&callback) const {
+    if(this->photons.empty()) {
+        return;
+    }
+
+    auto low = this->getCell(pos - vec3<float>{radius, radius, radius});
+    auto high = this->getCell(pos + vec3<float>{radius, radius, radius});
+    float radius2 = radius * radius;
+
+    for(int z = low[2]; z <= high[2]; z++) {
+        for(int y = low[1]; y <= high[1]; y++) {
+            for(int x = low[0]; x <= high[0]; x++) {
+                std::array<int, 3> cell = {x, y, z};
+                auto bucket = this->getBucket(cell);
+
+                // Buckets are shared by all cells with the same hash, so photons of other cells are skipped to not visit them twice
+                for(auto i = this->bucket_starts[bucket]; i < this->bucket_starts[bucket + 1]; i++) {
+                    const Photon &photon = this->photons[i];
+                    if((photon.pos - pos).getLengthSquared() <= radius2 && this->getCell(photon.pos) == cell) {
+                        callback(photon);
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif // PATHTRACE_PHOTON_MAP_H
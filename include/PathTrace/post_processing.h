@@ -8,9 +8,9 @@
  * This function attempts to find a typically non-linear mapping of values monotonically increasing in brightness
  *  that yields good contrast and use of the available dynamic range in the output image.
  *
- * @param image The input image with an arbitrary (finite) value range
+ * @param image View of the input image with an arbitrary (finite) value range
  */
-void toneMap(Image<> &image);
+void toneMap(ImageView<> image);
 
 /**
  * Inversely corrects an image for a gamma value that will later be applied inplace
@@ -18,14 +18,14 @@ void toneMap(Image<> &image);
  * @param image Image to gamma correct
  * @param gamma Value of gamma to correct for
  */
-void gammaCorrect(Image<> &image, float gamma = 1.8F);
+void gammaCorrect(ImageView<> image, float gamma = 1.8F);
 
 /**
  * Maps a raw image with arbitrary finite value range to a final post-processed image by
  *  performing tone mapping followed by gamma correction inplace
  *
- * @param image The image to post-process
+ * @param image View of the image to post-process
  */
-void postProcess(Image<> &image);
+void postProcess(ImageView<> image);
 
 #endif // PATHTRACE_POST_PROCESSING_H
@@ -0,0 +1,78 @@
+#ifndef PATHTRACE_RADIANCE_CACHE_H
+#define PATHTRACE_RADIANCE_CACHE_H
+
+#include <PathTrace/base.h>
+#include <PathTrace/util/color.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <tuple>
+
+/**
+ * A world-space cache of the radiance reflected by surfaces, which is learned from training paths and used to terminate paths
+ *  at vertices whose reflected light varies slowly, such as after a diffuse bounce
+ *
+ * Space is divided into a uniform grid of cells, which are further split by the dominant axis of the surface normal,
+ *  so that faces meeting at an edge or both sides of a thin wall do not share a cell
+ * Cells are created on demand in a fixed-size hash table using linear probing without locks, and dropped once the table is full
+ * Cached radiance does not depend on the direction, which is only exact for Lambertian surfaces
+ */
+class RadianceCache {
+  private:
+    struct Entry {
+        //! Key of the cell stored in the entry, or 0 if the entry is unused
+        std::atomic<std::uint64_t> key;
+        //! Sums of the color channels of the radiance recorded into the cell
+        std::array<std::atomic<float>, 3> sums;
+        std::atomic<std::uint32_t> count;
+
+        //! Average radiance made available to queries by the last update
+        Color<float> radiance;
+        //! Whether enough radiance was recorded before the last update for the cell to be queried
+        bool valid;
+    };
+
+    int size;
+    float cell_size;
+    std::unique_ptr<Entry[]> entries;
+
+    std::uint64_t getKey(vec3<float> pos, vec3<float> n) const noexcept;
+    Entry *find(std::uint64_t key, bool insert) const noexcept;
+
+  public:
+    /**
+     * Constructs an empty cache
+     *
+     * @param size Maximum number of cells stored
+     * @param cell_size Edge length of the grid cells
+     */
+    RadianceCache(int size, float cell_size);
+
+    /**
+     * Records an estimate of the radiance reflected at a surface position, which may be called concurrently
+     *
+     * @param pos Position on the surface
+     * @param n Surface normal at the position
+     * @param radiance Estimate of the reflected radiance, excluding emission of the surface itself
+     */
+    void record(vec3<float> pos, vec3<float> n, Color<float> radiance) noexcept;
+
+    /**
+     * Makes the averages of all radiance recorded so far available to queries
+     * This must not be called concurrently with any other method
+     */
+    void update();
+
+    /**
+     * Looks up the radiance reflected at a surface position, as known since the last update
+     *
+     * @param pos Position on the surface
+     * @param n Surface normal at the position
+     * @return Tuple of the cached radiance and whether the cache holds enough samples for the position
+     */
+    std::tuple<Color<float>, bool> get(vec3<float> pos, vec3<float> n) const noexcept;
+};
+
+#endif // PATHTRACE_RADIANCE_CACHE_H
@@ -0,0 +1,137 @@
+#ifndef PATHTRACE_SAMPLER_H
+#define PATHTRACE_SAMPLER_H
+
+#include <PathTrace/base.h>
+
+#include <cstdint>
+#include <memory>
+
+/**
+ * Sequences used to generate the random numbers of the samples of a pixel
+ */
+enum class SamplerType {
+    //! Independent uniformly distributed random numbers, hashed from the pixel, sample and dimension
+    Independent,
+    //! Owen-scrambled Sobol sequence, where each pair of dimensions uses the first two dimensions of the sequence
+    //!  with its own scrambling and sample order, which form a progressive multi-jittered (0, 2) sequence
+    Sobol,
+    //! Owen-scrambled Halton sequence, which uses a different prime base for every dimension
+    Halton,
+    //! Owen-scrambled Sobol sequence shared by all pixels and shifted by a blue-noise mask in the leading dimensions,
+    //!  such that the error of neighbouring pixels differs and looks less noisy at low sample counts
+    BlueNoise
+};
+
+/**
+ * A generator of the random numbers for the samples of a pixel, where the n-th number consumed by a sample is its n-th dimension
+ * Every number only depends on the seed, pixel, sample index and dimension, so that samples can be rendered in any order
+ *
+ * A sampler is a RandomSequence, so that it drives all sampling routines through the RandomEngine passed to them,
+ *  where every 32-bit value drawn from the engine is one dimension
+ */
+class Sampler : public RandomSequence {
+  protected:
+    std::uint64_t seed;
+    //! Seed of the current pixel, which decorrelates the numbers used by different pixels
+    std::uint64_t pixel_seed = 0;
+    //! Position of the current pixel
+    std::uint32_t x = 0;
+    std::uint32_t y = 0;
+    std::uint32_t sample_index = 0;
+    //! Dimension of the next number of the current sample
+    std::uint32_t dimension = 0;
+    //! Seed and counter of the numbers of the current sample that do not consume a dimension
+    std::uint64_t independent_seed = 0;
+    std::uint32_t independent_index = 0;
+
+  public:
+    /**
+     * Constructs a sampler
+     *
+     * @param seed Seed from which the numbers of each pixel are derived
+     */
+    explicit Sampler(std::uint64_t seed) noexcept;
+
+    /**
+     * Starts generating the numbers of a sample of a pixel, starting at its first dimension
+     *
+     * @param x x-position of the pixel
+     * @param y y-position of the pixel
+     * @param sample_index Index of the sample within the pixel
+     */
+    void startSample(int x, int y, int sample_index) noexcept;
+
+    uint32_t getDimension() const noexcept override;
+    void setDimension(uint32_t dimension) noexcept override;
+
+    /**
+     * Returns a hash of the pixel, sample index and a counter of its own, such that these numbers never shift the dimensions of the sample
+     *
+     * @return Random bits
+     */
+    uint32_t nextIndependent() noexcept override;
+};
+
+/**
+ * Sampler generating independent random numbers, each of which is a hash of a counter made up of the pixel, sample index and dimension
+ */
+class IndependentSampler final : public Sampler {
+  public:
+    using Sampler::Sampler;
+
+    uint32_t next() noexcept override;
+};
+
+/**
+ * Sampler using the Owen-scrambled Sobol sequence, padded by using its first two dimensions for every pair of dimensions
+ * Every power-of-two prefix of the samples of a pixel is stratified in each pair of dimensions
+ */
+class SobolSampler final : public Sampler {
+  public:
+    using Sampler::Sampler;
+
+    uint32_t next() noexcept override;
+};
+
+/**
+ * Sampler using the Halton sequence, whose digits are randomly permuted for every pixel and dimension
+ * Dimensions without a prime base of their own use independent random numbers
+ */
+class HaltonSampler final : public Sampler {
+  public:
+    using Sampler::Sampler;
+
+    uint32_t next() noexcept override;
+};
+
+/**
+ * Sampler that shifts the same Owen-scrambled Sobol points of every pixel by a tileable blue-noise mask in the leading dimensions,
+ *  where the seed chooses the offset of the mask for each dimension
+ * Further dimensions use the Sobol sampler, scrambled for each pixel
+ */
+class BlueNoiseSampler final : public Sampler {
+  public:
+    using Sampler::Sampler;
+
+    uint32_t next() noexcept override;
+};
+
+/**
+ * Constructs a sampler of the given type
+ *
+ * @param type Type of the sampler
+ * @param seed Seed from which the numbers of each pixel are derived
+ * @return The sampler
+ */
+std::unique_ptr<Sampler> createSampler(SamplerType type, std::uint64_t seed);
+
+/**
+ * Derives the seed of an independent stream of random numbers from a seed and a counter, such as the index of a pass
+ *
+ * @param seed Seed to derive from
+ * @param counter Counter distinguishing the streams derived from the same seed
+ * @return Derived seed
+ */
+std::uint64_t deriveSeed(std::uint64_t seed, std::uint64_t counter) noexcept;
+
+#endif // PATHTRACE_SAMPLER_H
@@ -5,6 +5,8 @@
 #include <PathTrace/scene/object.h>
 
 #include <memory>
+#include <mutex>
+#include <vector>
 
 /**
  * POD struct Representing the geometry of a 3D AABB (axis-aligned bounding box)
@@ -16,22 +18,32 @@ struct AABBArea {
     vec3<float> high;
 };
 
+struct DeferredAABBChildren;
+
 /**
  * Represents a node of a bounding volume hierarchy of AABBs
  * Instances are either a leaf that contains an object or an inner node
  *  that has exactly two child nodes
+ *
+ * Inner nodes may be deferred, in which case their child nodes are only constructed
+ *  once the node is first expanded, see DeferredAABBChildren
  */
 class AABB {
   public:
     AABBArea area;
 
-    std::unique_ptr<AABB> left;
-    std::unique_ptr<AABB> right;
+    //! Child nodes of inner nodes, which are populated on expansion for deferred nodes
+    mutable std::unique_ptr<AABB> left;
+    mutable std::unique_ptr<AABB> right;
     std::unique_ptr<Object> child;
 
+    //! Pending construction state for deferred inner nodes, nullptr for all other nodes
+    std::unique_ptr<DeferredAABBChildren> deferred;
+
     bool leaf;
 
     AABB();
+    ~AABB();
     AABB(AABB &&other) noexcept;
     AABB &operator=(AABB &&other) noexcept;
 
@@ -56,6 +68,16 @@ class AABB {
      */
     AABB(AABBArea area, std::unique_ptr<Object> &&child) noexcept;
 
+    /**
+     * Constructs a deferred inner node, given the nodes that make up its subtree
+     * The newly constructed node will contain the smallest AABB area
+     *  which contains the area of all given nodes
+     *
+     * @param bounding_boxes Nodes that will make up the subtree once the node is expanded, must contain at least two nodes
+     * @param eager_depth Number of levels to construct eagerly once the node is expanded
+     */
+    AABB(std::vector<AABB> &&bounding_boxes, int eager_depth);
+
     /**
      * Intersect a ray with this node's bounding box and return the smallest distance
      *  along the ray that leads to a point inside the bounding box
@@ -67,4 +89,18 @@ class AABB {
     float getIntersection(const Ray &ray) const noexcept;
 };
 
+/**
+ * Construction state of a deferred inner node
+ * The contained nodes are consumed when the owning node is expanded,
+ *  which happens at most once, even if multiple threads attempt to expand the node concurrently
+ */
+struct DeferredAABBChildren {
+    std::once_flag expanded;
+
+    //! Nodes that make up the subtree of the deferred node
+    std::vector<AABB> bounding_boxes;
+    //! Number of levels to construct eagerly on expansion
+    int eager_depth;
+};
+
 #endif /* PATHTRACE_BOUNDING_BOX_H */
@@ -0,0 +1,47 @@
+#ifndef PATHTRACE_ENVIRONMENT_LIGHT_H
+#define PATHTRACE_ENVIRONMENT_LIGHT_H
+
+#include <PathTrace/base.h>
+#include <PathTrace/scene/light.h>
+#include <PathTrace/image/image.h>
+#include <PathTrace/util/color.h>
+#include <PathTrace/util/distribution.h>
+
+#include <utility>
+
+/**
+ * Environment lights surround the scene at an infinite distance, emitting light given by an environment map
+ *  in latitude-longitude layout, where the top row of the image corresponds to the positive y-direction
+ *
+ * Directions are importance sampled proportionally to the emitted radiance of the map, accounting for the
+ *  distortion of the mapping near the poles, so that small bright regions such as the sun are found reliably
+ */
+class EnvironmentLight final : public LightSource {
+  private:
+    Image<> image;
+    float scale;
+    Distribution2D distribution;
+
+    vec3<float> scene_center = {0.0F, 0.0F, 0.0F};
+    float scene_radius = 1.0F;
+
+  public:
+    virtual ~EnvironmentLight() = default;
+
+    /**
+     * Constructs an environment light from a latitude-longitude environment map
+     *
+     * @param image The environment map, which is typically read from a high dynamic range image
+     * @param scale Factor the radiance of the environment map is multiplied with
+     */
+    EnvironmentLight(Image<> image, float scale = 1.0F);
+
+    std::tuple<vec3<float>, float> importanceSample(vec3<float> pos, RandomEngine &re) const noexcept override;
+    Spectrum getSpectrum(Ray ray) const noexcept override;
+    float getPower() const noexcept override;
+    bool isInfinite() const noexcept override;
+    float getPdf(vec3<float> pos, vec3<float> dir) const noexcept override;
+    void setSceneBounds(vec3<float> center, float radius) noexcept override;
+};
+
+#endif /* PATHTRACE_ENVIRONMENT_LIGHT_H */
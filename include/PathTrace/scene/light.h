@@ -36,9 +36,11 @@ class LightSource {
      *  from a given position on the surface of an object
      *
      * @param pos Surface position on the object
-     * @return Tuple of the sampled position and the corresponding probability density
+     * @param re RandomEngine to generate random bits for sampling
+     * @return Tuple of the sampled position and the corresponding probability density,
+     *  which is with respect to solid angle unless the light source can not be hit by rays
      */
-    virtual std::tuple<vec3<float>, float> importanceSample(vec3<float> pos) const noexcept = 0;
+    virtual std::tuple<vec3<float>, float> importanceSample(vec3<float> pos, RandomEngine &re) const noexcept = 0;
 
     /**
      * Gets the emitted spectrum for a specified ray pointing towards the light source
@@ -47,6 +49,41 @@ class LightSource {
      * @return The emitted spectrum
      */
     virtual Spectrum getSpectrum(Ray ray) const noexcept = 0;
+
+    /**
+     * Estimates the total power emitted by the light source, which is used to choose which light sources to sample
+     * The estimate should be comparable to the emitted power of emissive objects, that is the sum of the color channels
+     *  of the emitted spectrum weighted by its alpha value, integrated over the emitting area and directions
+     *
+     * @return Estimated emitted power
+     */
+    virtual float getPower() const noexcept = 0;
+
+    /**
+     * Returns whether the light source surrounds the scene at an infinite distance,
+     *  so that its emission is collected by rays escaping the scene
+     *
+     * @return True if the light source is infinitely far away, False otherwise
+     */
+    virtual bool isInfinite() const noexcept;
+
+    /**
+     * Computes the probability density of importanceSample sampling a given direction,
+     *  which is needed to weight emission collected by rays escaping the scene
+     *
+     * @param pos Surface position the light source is sampled from
+     * @param dir Direction towards the light source, of length 1
+     * @return Probability density with respect to solid angle, or 0 if the light source can not be hit by rays
+     */
+    virtual float getPdf(vec3<float> pos, vec3<float> dir) const noexcept;
+
+    /**
+     * Informs the light source about the extent of the scene, which is called once when constructing the scene
+     *
+     * @param center Center of a sphere bounding the scene
+     * @param radius Radius of a sphere bounding the scene
+     */
+    virtual void setSceneBounds(vec3<float> center, float radius) noexcept;
 };
 
 /**
@@ -61,8 +98,9 @@ class PointLightSource final : public LightSource {
     virtual ~PointLightSource() = default;
     PointLightSource(vec3<float> pos, Spectrum spectrum) noexcept;
 
-    std::tuple<vec3<float>, float> importanceSample(vec3<float> pos) const noexcept override;
+    std::tuple<vec3<float>, float> importanceSample(vec3<float> pos, RandomEngine &re) const noexcept override;
     Spectrum getSpectrum(Ray ray) const noexcept override;
+    float getPower() const noexcept override;
 };
 
 #endif /* PATHTRACE_LIGHT_H */
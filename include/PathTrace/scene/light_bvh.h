@@ -0,0 +1,104 @@
+#ifndef PATHTRACE_LIGHT_BVH_H
+#define PATHTRACE_LIGHT_BVH_H
+
+#include <PathTrace/base.h>
+#include <PathTrace/scene/object.h>
+#include <PathTrace/scene/bounding_box.h>
+
+#include <cstdint>
+#include <vector>
+#include <utility>
+
+/**
+ * POD struct bounding the spatial extent, orientation and power of a set of emitters
+ */
+struct LightBounds {
+    //! Bounding box of the emitters
+    AABBArea bounds;
+    //! Axis of the cone bounding the normals of the emitters, of length 1
+    vec3<float> axis;
+    //! Cosine of the half angle of the cone bounding the normals of the emitters
+    float cos_theta_o;
+    //! Cosine of the angle around each normal in which light is emitted
+    float cos_theta_e;
+    //! Total power emitted by the emitters
+    float power;
+    //! Whether emitters emit light on both sides of their surface
+    bool two_sided;
+
+    /**
+     * Conservatively estimates the contribution of the emitters to a given receiving point
+     *
+     * @param pos Position of the receiving point
+     * @param n Surface normal at the receiving point, or a zero vector to ignore the orientation of the receiver
+     * @return Estimated contribution, which is 0 only if the emitters can not illuminate the point
+     */
+    float getImportance(vec3<float> pos, vec3<float> n) const noexcept;
+};
+
+/**
+ * A bounding volume hierarchy over emissive objects, which is used to choose emitters
+ *  proportionally to their estimated contribution to a given point
+ *
+ * Each node stores the combined power, spatial bounds and a cone of normals of the emitters below it,
+ *  and the hierarchy is traversed stochastically based on the importance of both children at every inner node
+ */
+class LightBVH {
+  private:
+    struct Node {
+        LightBounds light_bounds;
+
+        //! For inner nodes the index of the second child, with the first child directly following the node,
+        //!  and for leaves the index of the emitter
+        int index;
+        bool leaf;
+    };
+
+    std::vector<Node> nodes;
+
+    //! Bit trail of child choices leading from the root node to the leaf of each emitter
+    std::vector<std::uint64_t> emitter_trails;
+
+    int build(std::vector<std::tuple<LightBounds, int>> &emitters, int begin, int end, std::uint64_t trail, int depth);
+
+  public:
+    LightBVH() = default;
+
+    /**
+     * Constructs a light BVH over the given emissive objects
+     *
+     * @param emitters Non-owning raw pointers to the emissive objects
+     * @param powers Emitted power of each object
+     */
+    LightBVH(const std::vector<const Object *> &emitters, const std::vector<float> &powers);
+
+    /**
+     * Returns whether the hierarchy contains no emitters
+     *
+     * @return True if there are no emitters, False otherwise
+     */
+    bool empty() const noexcept;
+
+    /**
+     * Chooses an emitter with probability proportional to its estimated contribution to the given point
+     *
+     * @param pos Position of the receiving point
+     * @param n Surface normal at the receiving point
+     * @param u Uniformly distributed value in range [0, 1)
+     * @return Tuple of the index of the chosen emitter, or -1 if no emitter can illuminate the point,
+     *  and the probability of choosing that emitter
+     */
+    std::tuple<int, float> sample(vec3<float> pos, vec3<float> n, float u) const noexcept;
+
+    /**
+     * Computes the probability of choosing the given emitter for a receiving point
+     *
+     * @param pos Position of the receiving point
+     * @param n Surface normal at the receiving point
+     * @param emitter_index Index of the emitter
+     * @return Probability of sample choosing the emitter
+     */
+    float getProbability(vec3<float> pos, vec3<float> n, int emitter_index) const noexcept;
+};
+
+#endif // PATHTRACE_LIGHT_BVH_H
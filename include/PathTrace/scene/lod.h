@@ -0,0 +1,111 @@
+#ifndef PATHTRACE_LOD_H
+#define PATHTRACE_LOD_H
+
+#include <PathTrace/scene/object.h>
+#include <PathTrace/camera.h>
+
+#include <vector>
+#include <memory>
+
+/**
+ * Simplifies a triangle mesh to approximately the given number of triangles
+ *  using iterative edge collapses ordered by quadric error metrics (QEM)
+ * Vertices of the given triangles are joined by their exact positions,
+ *  and only the geometry of the triangles is retained, so material handlers need to be set afterwards
+ *
+ * @param triangles The triangles making up the mesh to simplify
+ * @param target_triangle_count Number of triangles to simplify the mesh to
+ * @param cull_backface Whether to cull the back faces of the simplified triangles
+ * @param smooth Whether to smooth normals of the simplified triangles
+ * @return The triangles of the simplified mesh
+ */
+std::vector<Triangle> simplifyMesh(const std::vector<Triangle> &triangles, int target_triangle_count, bool cull_backface = true, bool smooth = true);
+
+/**
+ * POD struct specifying how a level of detail is chosen for a mesh
+ */
+struct LODSelectionPolicy {
+    //! Target number of triangles per pixel covered by the bounding sphere of the mesh
+    float triangles_per_pixel = 2.0F;
+
+    //! Width of the stochastic transition between adjacent levels, measured in levels
+    //! A value of 0 always selects the closest level, a value of 1 linearly blends between adjacent levels
+    float transition_width = 0.0F;
+};
+
+/**
+ * A chain of increasingly simplified versions of a triangle mesh,
+ *  from which a level of detail can be selected based on the screen-space footprint of the mesh
+ *
+ * Level 0 contains the original triangles, with every following level containing fewer triangles
+ */
+class MeshLODChain {
+  private:
+    std::vector<std::vector<Triangle>> levels;
+
+    vec3<float> bounding_center;
+    float bounding_radius;
+
+  public:
+    /**
+     * Constructs a level of detail chain for a triangle mesh
+     *
+     * @param triangles The triangles making up the mesh at full detail
+     * @param max_level_count Maximum number of levels including the original mesh
+     * @param reduction Ratio of the triangle counts of successive levels, should be in range (0, 1)
+     * @param min_triangle_count No further levels will be generated once a level has at most this many triangles
+     * @param cull_backface Whether to cull the back faces of simplified triangles
+     * @param smooth Whether to smooth normals of simplified triangles
+     */
+    MeshLODChain(std::vector<Triangle> &&triangles, int max_level_count = 6, float reduction = 0.25F, int min_triangle_count = 256, bool cull_backface = true,
+                 bool smooth = true);
+
+    /**
+     * Returns the number of levels in the chain
+     *
+     * @return Number of levels, which is at least 1
+     */
+    int getLevelCount() const noexcept;
+
+    /**
+     * Provides the triangles making up the specified level
+     *
+     * @param level Index of the level, in range [0, getLevelCount())
+     * @return Triangles of the level
+     */
+    const std::vector<Triangle> &getLevel(int level) const noexcept;
+
+    /**
+     * Sets the material handler of the triangles on all levels
+     *
+     * @param material_handler The material handler to set
+     */
+    void setMaterialHandler(const std::shared_ptr<MaterialHandler> &material_handler);
+
+    /**
+     * Selects a level of detail based on the size of the mesh when projected onto the image plane of the given camera
+     *
+     * @param camera Camera the mesh is viewed through
+     * @param image_height Height of the rendered image in pixels
+     * @param policy Policy that determines the desired level of detail
+     * @param u Value in range [0, 1) used for stochastic transitions between levels,
+     *  which should be chosen uniformly at random per instance of the mesh
+     * @return Index of the selected level
+     */
+    int selectLevel(const Camera &camera, int image_height, const LODSelectionPolicy &policy = {}, float u = 0.5F) const noexcept;
+};
+
+/**
+ * Computes the number of triangles that a mesh should be simplified to, based on the size of its bounding sphere
+ *  when projected onto the image plane of the given camera
+ * Meshes rendered at a single level of detail can be simplified to this count directly, rather than building a whole MeshLODChain
+ *
+ * @param triangles The triangles making up the mesh at full detail
+ * @param camera Camera the mesh is viewed through
+ * @param image_height Height of the rendered image in pixels
+ * @param policy Policy that determines the desired level of detail, whose transition width is ignored
+ * @return Target number of triangles, which is the number of the given triangles if the mesh should not be simplified
+ */
+int getLODTriangleCount(const std::vector<Triangle> &triangles, const Camera &camera, int image_height, const LODSelectionPolicy &policy = {}) noexcept;
+
+#endif // PATHTRACE_LOD_H
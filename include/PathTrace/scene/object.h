@@ -104,6 +104,35 @@ class Object {
      *  and whether backface culling should be performed
      */
     virtual std::tuple<vec3<float>, float, bool> sampleSurface(RandomEngine &re) const noexcept;
+
+    /**
+     * Samples a point on the surface of the object as seen from a given position,
+     *  which should prefer points that are visible from that position
+     * The default implementation samples the surface by area
+     *
+     * @param from Position the object is seen from
+     * @param re RandomEngine used to generate random bits used during sampling
+     * @return Tuple of surface position, the corresponding probability density with respect to solid angle as seen from the given position,
+     *  and whether backface culling should be performed
+     */
+    virtual std::tuple<vec3<float>, float, bool> sampleSurface(vec3<float> from, RandomEngine &re) const noexcept;
+
+    /**
+     * Computes the probability density of sampleSurface sampling a given point as seen from a given position
+     *
+     * @param from Position the object is seen from
+     * @param pos Point on the surface of the object
+     * @return Probability density with respect to solid angle as seen from the given position
+     */
+    virtual float getSamplePdf(vec3<float> from, vec3<float> pos) const noexcept;
+
+    /**
+     * Computes a cone bounding the surface normals of the object
+     *
+     * @return Tuple of the cone axis of length 1, the cosine of the half angle of the cone,
+     *  and whether the surface emits light from both sides
+     */
+    virtual std::tuple<vec3<float>, float, bool> getNormalBounds() const noexcept;
 };
 
 /**
@@ -139,21 +168,36 @@ class Sphere final : public Object {
     AABBArea getBoundingVolume() const noexcept override;
     float getSurfaceArea() const noexcept override;
     std::tuple<vec3<float>, float, bool> sampleSurface(RandomEngine &re) const noexcept override;
+    std::tuple<vec3<float>, float, bool> sampleSurface(vec3<float> from, RandomEngine &re) const noexcept override;
+    float getSamplePdf(vec3<float> from, vec3<float> pos) const noexcept override;
+    std::tuple<vec3<float>, float, bool> getNormalBounds() const noexcept override;
 };
 
 /**
  * A three-dimensional triangle with interpolation via barycentric coordinates
+ *
+ * Edge vectors and the surface area are precomputed on construction to speed up intersection and sampling,
+ *  so the vertices can only be set by constructing a new triangle
  */
 class Triangle final : public Object {
   public:
-    vec3<float> a;
-    vec3<float> b;
-    vec3<float> c;
     vec3<float> normal_a;
     vec3<float> normal_b;
     vec3<float> normal_c;
 
   private:
+    vec3<float> a;
+    vec3<float> b;
+    vec3<float> c;
+
+    //! Edge from vertex a to vertex b
+    vec3<float> ab;
+    //! Edge from vertex a to vertex c
+    vec3<float> ac;
+
+    float area;
+    float inv_area;
+
     bool cull_backface;
 
   public:
@@ -166,6 +210,81 @@ class Triangle final : public Object {
     AABBArea getBoundingVolume() const noexcept override;
     float getSurfaceArea() const noexcept override;
     std::tuple<vec3<float>, float, bool> sampleSurface(RandomEngine &re) const noexcept override;
+    std::tuple<vec3<float>, float, bool> sampleSurface(vec3<float> from, RandomEngine &re) const noexcept override;
+    float getSamplePdf(vec3<float> from, vec3<float> pos) const noexcept override;
+    std::tuple<vec3<float>, float, bool> getNormalBounds() const noexcept override;
+
+    /**
+     * Returns the first vertex of the triangle
+     *
+     * @return Position of the first vertex
+     */
+    vec3<float> getA() const noexcept;
+
+    /**
+     * Returns the second vertex of the triangle
+     *
+     * @return Position of the second vertex
+     */
+    vec3<float> getB() const noexcept;
+
+    /**
+     * Returns the third vertex of the triangle
+     *
+     * @return Position of the third vertex
+     */
+    vec3<float> getC() const noexcept;
+
+    /**
+     * Returns the precomputed edge from the first to the second vertex of the triangle
+     *
+     * @return Edge vector from the first to the second vertex
+     */
+    vec3<float> getAB() const noexcept;
+
+    /**
+     * Returns the precomputed edge from the first to the third vertex of the triangle
+     *
+     * @return Edge vector from the first to the third vertex
+     */
+    vec3<float> getAC() const noexcept;
+
+    /**
+     * Returns whether back faces of the triangle are culled
+     *
+     * @return True if rays hitting the back face do not intersect the triangle, False otherwise
+     */
+    bool isBackfaceCulled() const noexcept;
 };
 
+/**
+ * Samples a point on a triangle as seen from a given position
+ * Triangles covering a moderate solid angle are sampled uniformly by solid angle,
+ *  while tiny or huge ones, for which this is numerically unstable, are sampled uniformly by area
+ *
+ * @param from Position the triangle is seen from
+ * @param a First vertex of the triangle
+ * @param ab Edge from the first to the second vertex
+ * @param ac Edge from the first to the third vertex
+ * @param inv_area Reciprocal of the surface area of the triangle
+ * @param u1 First uniformly distributed value in range [0, 1)
+ * @param u2 Second uniformly distributed value in range [0, 1)
+ * @return Tuple of the barycentric coordinates of the sampled point with respect to the second and third vertex,
+ *  and the probability density with respect to solid angle, which is 0 if the triangle can not be sampled from the position
+ */
+std::tuple<float, float, float> sampleTriangle(vec3<float> from, vec3<float> a, vec3<float> ab, vec3<float> ac, float inv_area, float u1, float u2) noexcept;
+
+/**
+ * Computes the probability density of sampleTriangle sampling a given point on the triangle
+ *
+ * @param from Position the triangle is seen from
+ * @param a First vertex of the triangle
+ * @param ab Edge from the first to the second vertex
+ * @param ac Edge from the first to the third vertex
+ * @param inv_area Reciprocal of the surface area of the triangle
+ * @param pos Point on the triangle
+ * @return Probability density with respect to solid angle
+ */
+float getTrianglePdf(vec3<float> from, vec3<float> a, vec3<float> ab, vec3<float> ac, float inv_area, vec3<float> pos) noexcept;
+
 #endif /* PATHTRACE_OBJECT_H */
@@ -48,6 +48,28 @@ class BSDF {
      */
     virtual std::tuple<Spectrum, float, float> getSpectrum(Ray from_camera, Ray to_light, vec3<float> pos, vec3<float> normal, Spectrum light_spectrum,
                                                            const Material *material, bool synthetic = false) const noexcept = 0;
+
+    /**
+     * Computes the probability density of propagateRay sampling the given outgoing ray for the given incoming ray
+     * BSDFs that only scatter into discrete directions, such as perfect reflection or refraction, return 0,
+     *  since other sampling strategies can not generate these directions
+     *
+     * @param from_camera Incoming ray
+     * @param to_light Outgoing ray
+     * @param pos Point on the surface at the object that the ray intersects
+     * @param normal Surface normal of the object at the intersected position
+     * @param material Material of the object at the intersected surface point
+     * @return Probability density with respect to solid angle of sampling the outgoing ray
+     */
+    virtual float getPdf(Ray from_camera, Ray to_light, vec3<float> pos, vec3<float> normal, const Material *material) const noexcept = 0;
+
+    /**
+     * Returns whether the BSDF only scatters into discrete directions, such as perfect reflection or refraction,
+     *  so that its sampling can not be combined with other sampling strategies
+     *
+     * @return True if the BSDF only scatters into discrete directions, False otherwise
+     */
+    virtual bool isDiscrete() const noexcept = 0;
 };
 
 /**
@@ -63,6 +85,8 @@ class LambertianBRDF : public BSDF {
                                                const Material *material) const noexcept override;
     std::tuple<Spectrum, float, float> getSpectrum(Ray from_camera, Ray to_light, vec3<float> pos, vec3<float> normal, Spectrum light_spectrum,
                                                    const Material *material, bool synthetic = false) const noexcept override;
+    float getPdf(Ray from_camera, Ray to_light, vec3<float> pos, vec3<float> normal, const Material *material) const noexcept override;
+    bool isDiscrete() const noexcept override;
 };
 
 /**
@@ -77,6 +101,8 @@ class GlassBDF : public BSDF {
                                                const Material *material) const noexcept override;
     std::tuple<Spectrum, float, float> getSpectrum(Ray from_camera, Ray to_light, vec3<float> pos, vec3<float> normal, Spectrum light_spectrum,
                                                    const Material *material, bool synthetic = false) const noexcept override;
+    float getPdf(Ray from_camera, Ray to_light, vec3<float> pos, vec3<float> normal, const Material *material) const noexcept override;
+    bool isDiscrete() const noexcept override;
 };
 
 /**
@@ -100,6 +126,8 @@ class MirrorBRDF : public BSDF {
                                                const Material *material) const noexcept override;
     std::tuple<Spectrum, float, float> getSpectrum(Ray from_camera, Ray to_light, vec3<float> pos, vec3<float> normal, Spectrum light_spectrum,
                                                    const Material *material, bool synthetic = false) const noexcept override;
+    float getPdf(Ray from_camera, Ray to_light, vec3<float> pos, vec3<float> normal, const Material *material) const noexcept override;
+    bool isDiscrete() const noexcept override;
 };
 
 /**
@@ -129,6 +157,8 @@ class CombinedBSDF : public BSDF {
                                                const Material *material) const noexcept override;
     std::tuple<Spectrum, float, float> getSpectrum(Ray from_camera, Ray to_light, vec3<float> pos, vec3<float> normal, Spectrum light_spectrum,
                                                    const Material *material, bool synthetic = false) const noexcept override;
+    float getPdf(Ray from_camera, Ray to_light, vec3<float> pos, vec3<float> normal, const Material *material) const noexcept override;
+    bool isDiscrete() const noexcept override;
 };
 
 #endif /* PATHTRACE_MATERIAL_H */
@@ -5,8 +5,110 @@
 #include <PathTrace/scene/object.h>
 #include <PathTrace/scene/bounding_box.h>
 #include <PathTrace/scene/light.h>
+#include <PathTrace/scene/light_bvh.h>
+#include <PathTrace/util/distribution.h>
 
+#include <array>
 #include <utility>
+#include <span>
+#include <unordered_map>
+
+/**
+ * Strategies for choosing which emissive objects to sample when sampling lights
+ */
+enum class EmitterSelection {
+    //! Choose emitters proportionally to their emitted power, independent of the receiving point
+    Power,
+    //! Choose emitters proportionally to their estimated contribution to the receiving point using a light BVH
+    LightBVH
+};
+
+/**
+ * POD struct specifying options for the construction of a scene
+ */
+struct SceneOptions {
+    //! Whether to defer the construction of deeper levels of the BVH until they are first traversed
+    //! This reduces the time until the first ray can be traced, and avoids building the hierarchy
+    //!  for geometry that is never intersected
+    bool lazy_bvh = false;
+
+    //! Number of levels of the BVH that are constructed eagerly when using lazy BVH construction
+    //! Deferred subtrees likewise construct this many levels at once when first traversed
+    int eager_bvh_depth = 8;
+
+    //! Strategy for choosing emissive objects when sampling lights
+    EmitterSelection emitter_selection = EmitterSelection::Power;
+
+    //! Number of lights sampled at each path vertex, chosen proportionally to their power among all light sources and emissive objects
+    //! If this is 0, every light source is sampled, along with a small number of emissive objects depending on their count
+    int light_sample_count = 0;
+};
+
+/**
+ * Geometry and emission of an emissive triangle with a constant material, packed into a single record
+ *  so that sampling it requires neither virtual calls nor pointer chasing
+ * The data needed to sample a point and evaluate the density fits into the first cache line of the record,
+ *  followed by the vertex normals, so that sampling a triangle reads at most two cache lines
+ */
+struct alignas(64) EmissiveTriangle {
+    //! First vertex of the triangle
+    vec3<float> a;
+    //! Edge from the first to the second vertex
+    vec3<float> ab;
+    //! Edge from the first to the third vertex
+    vec3<float> ac;
+    //! Reciprocal of the surface area
+    float inv_area;
+    //! Constant emission in all directions
+    Spectrum emission;
+    //! Whether back faces are culled
+    bool cull_backface;
+    //! Normals of the vertices
+    std::array<vec3<float>, 3> normals;
+
+    /**
+     * Packs a triangle with constant emission
+     *
+     * @param triangle The triangle to pack
+     * @param emission Emission of the triangle in all directions
+     */
+    EmissiveTriangle(const Triangle &triangle, Spectrum emission) noexcept;
+};
+
+/**
+ * POD struct describing a single sample of a light source or emissive object
+ */
+struct LightSample {
+    //! Sampled position on the light source
+    vec3<float> pos;
+    //! Spectrum emitted towards the receiving point
+    Spectrum spectrum;
+    //! Probability density of the sample with respect to solid angle, adjusted for the number of light sources sampled
+    float pd;
+    //! Whether rays sampled from BSDFs can hit the light source, so that the sample should be weighted against BSDF sampling
+    bool bsdf_reachable;
+    //! Index identifying the sampled light source or emissive object, where emissive objects follow all light sources
+    int light_id;
+};
+
+/**
+ * POD struct describing a sampled origin and direction of light emitted by an emissive object,
+ *  from which light paths are traced into the scene
+ */
+struct EmissionSample {
+    //! Sampled position on the surface of the emissive object
+    vec3<float> pos;
+    //! Surface normal of the emissive object at the sampled position
+    vec3<float> n;
+    //! Direction the light is emitted in, of length 1
+    vec3<float> dir;
+    //! The sampled emissive object
+    const Object *object;
+    //! Probability density of the position with respect to surface area, including the probability of choosing the object
+    float pos_pd;
+    //! Probability density of the direction with respect to solid angle
+    float dir_pd;
+};
 
 /**
  * The Scene class represents and owns the geometrical description of a scene as well as light sources
@@ -15,21 +117,44 @@
 class Scene {
   private:
     std::vector<std::unique_ptr<LightSource>> light_sources;
+    //! Indices of the light sources at an infinite distance
+    std::vector<int> infinite_light_indices;
+    //! Emissive objects, where the first emissive_triangles.size() entries are the packed emissive triangles
     std::vector<const Object *> object_light_sources;
-    std::vector<float> object_light_source_probabilities;
+    std::vector<float> object_light_source_powers;
+    std::unordered_map<const Object *, int> object_light_source_indices;
+    std::vector<EmissiveTriangle> emissive_triangles;
+    EmitterSelection emitter_selection;
+    AliasTable emitter_table;
+    LightBVH light_bvh;
+    int object_sample_count = 0;
+
+    //! Distribution over all light sources, followed by a single entry for the group of all emissive objects
+    AliasTable light_table;
+    float emitter_group_probability = 0.0F;
+    int light_sample_count = 0;
     AABB bounding_box;
 
   protected:
     void registerEmissiveObjects(const AABB &aabb);
+    void packEmissiveTriangles();
+    std::tuple<LightSample, bool> sampleEmissiveObject(vec3<float> pos, vec3<float> n, RandomEngine &re) const noexcept;
 
   public:
+    //! Dimensions of a sampler used by each light sample: the choice of a light, the choice of an emissive object and a pair for the point on it
+    static constexpr std::uint32_t light_sample_dimension_count = 4;
+
+    //! Dimensions of a sampler used by an emission sample: the choice of an emissive object and its side, and a pair for each the point and direction
+    static constexpr std::uint32_t emission_sample_dimension_count = 6;
+
     /**
      * Constructs a scene containing the given (potentially emissive) objects and light sources
      *
      * @param objects Objects making up the scene
      * @param light_sources Light sources in the scene (excluding emissive objects)
+     * @param options Options for the construction of the scene
      */
-    Scene(std::vector<std::unique_ptr<Object>> &&objects, std::vector<std::unique_ptr<LightSource>> &&light_sources);
+    Scene(std::vector<std::unique_ptr<Object>> &&objects, std::vector<std::unique_ptr<LightSource>> &&light_sources, const SceneOptions &options = {});
 
     /**
      * Intersects a ray with the scene
@@ -41,17 +166,120 @@ class Scene {
     std::tuple<float, const Object *> getIntersection(const Ray &ray) const noexcept;
 
     /**
-     * Samples all light sources and emissive objects in the scene from a given position
-     * The same light source may be sampled multiple times, and only a subset of all light sources in the scene may be sampled
+     * Returns the bounds of all objects in the scene
+     *
+     * @return Bounding box of the scene
+     */
+    AABBArea getBounds() const noexcept;
+
+    /**
+     * Returns the maximum number of light samples produced by a single call to sampleLights
+     *
+     * @return Upper bound of the number of light samples per call
+     */
+    int getMaxLightSampleCount() const noexcept;
+
+    /**
+     * Samples light sources and emissive objects in the scene from a given position, without allocating memory
+     * The same light source may be sampled multiple times, and only a subset of all light sources in the scene may be sampled,
+     *  as configured by SceneOptions::light_sample_count
      * The returned probability densities are already adjusted for the number of light sources sampled
+     * The i-th sample uses light_sample_dimension_count dimensions of the engine, starting i times that count after its current dimension
      *
      * @param pos Position to sample the lights from
      * @param n Surface normal at the position to sample the lights from
      * @param re RandomEngine to generate random bits for sampling
-     * @return A vector of tuples of the sampled position of a light source, along with the Spectrum it emits towards the given point,
-     *  and the corresponding probability density
+     * @param lights Buffer the light samples are written to, which should hold getMaxLightSampleCount() elements,
+     *  as no further samples are taken once it is full
+     * @return Number of light samples written to the start of the buffer
+     */
+    int sampleLights(vec3<float> pos, vec3<float> n, RandomEngine &re, std::span<LightSample> lights) const noexcept;
+
+    /**
+     * Samples all light sources and emissive objects in the scene from a given position
+     * See the overload taking a buffer, which should be preferred in performance critical code
+     *
+     * @param pos Position to sample the lights from
+     * @param n Surface normal at the position to sample the lights from
+     * @param re RandomEngine to generate random bits for sampling
+     * @return A vector of light samples
+     */
+    std::vector<LightSample> sampleLights(vec3<float> pos, vec3<float> n, RandomEngine &re) const noexcept;
+
+    /**
+     * Samples a single light source or emissive object in the scene from a given position,
+     *  chosen proportionally to its power
+     * The sample uses light_sample_dimension_count dimensions of the engine, starting at its current dimension
+     *
+     * @param pos Position to sample the light from
+     * @param n Surface normal at the position to sample the light from
+     * @param re RandomEngine to generate random bits for sampling
+     * @return Tuple of the light sample, with the probability density including the probability of choosing the light,
+     *  and whether a valid sample was taken
+     */
+    std::tuple<LightSample, bool> sampleLight(vec3<float> pos, vec3<float> n, RandomEngine &re) const noexcept;
+
+    /**
+     * Computes the probability density of sampleLights sampling a given point on an emissive object,
+     *  which is needed to weight emission found by other sampling strategies
+     *
+     * @param pos Position the lights are sampled from
+     * @param n Surface normal at the position the lights are sampled from
+     * @param object The object the point lies on
+     * @param light_pos Point on the surface of the object
+     * @return Probability density with respect to solid angle, adjusted for the number of light sources sampled,
+     *  or 0 if the object is not sampled as a light source
+     */
+    float getLightPdf(vec3<float> pos, vec3<float> n, const Object *object, vec3<float> light_pos) const noexcept;
+
+    /**
+     * Returns the number of light sources at an infinite distance, whose emission is collected by rays escaping the scene
+     *
+     * @return Number of infinite light sources
+     */
+    int getInfiniteLightCount() const noexcept;
+
+    /**
+     * Computes the emission of an infinite light source collected by a ray escaping the scene,
+     *  along with the probability density of sampleLights sampling the direction of the ray
+     *
+     * @param light_index Index of the infinite light source in range [0, getInfiniteLightCount())
+     * @param pos Position the ray was shot from
+     * @param ray The ray escaping the scene
+     * @return Tuple of the emitted spectrum and the probability density with respect to solid angle,
+     *  adjusted for the number of light sources sampled
+     */
+    std::tuple<Spectrum, float> getInfiniteLightEmission(int light_index, vec3<float> pos, const Ray &ray) const noexcept;
+
+    /**
+     * Returns the number of light sources, excluding emissive objects
+     * Light samples with a light_id of at least this value are samples of emissive objects
+     *
+     * @return Number of light sources
+     */
+    int getLightSourceCount() const noexcept;
+
+    /**
+     * Samples the origin and direction of light emitted by an emissive object, choosing the object proportionally to its power,
+     *  the position uniformly on its surface and the direction proportionally to the cosine to the surface normal
+     * Light sources other than emissive objects are not sampled
+     * The sample uses emission_sample_dimension_count dimensions of the engine, starting at its current dimension
+     *
+     * @param re RandomEngine to generate random bits for sampling
+     * @return Tuple of the emission sample and whether a valid sample was taken
+     */
+    std::tuple<EmissionSample, bool> sampleEmission(RandomEngine &re) const noexcept;
+
+    /**
+     * Computes the probability densities of sampleEmission sampling a given position and direction
+     *
+     * @param object The emissive object the position lies on
+     * @param pos Point on the surface of the object
+     * @param dir Direction of the emitted light, of length 1
+     * @return Tuple of the probability density of the position with respect to surface area and of the direction with respect to solid angle,
+     *  which are 0 if the object is not emissive
      */
-    std::vector<std::tuple<vec3<float>, Spectrum, float>> sampleLights(vec3<float> pos, vec3<float> n, RandomEngine &re) const noexcept;
+    std::tuple<float, float> getEmissionPdf(const Object *object, vec3<float> pos, vec3<float> dir) const noexcept;
 };
 
 #endif /* PATHTRACE_SCENE_H */
@@ -0,0 +1,122 @@
+#ifndef PATHTRACE_DISTRIBUTION_H
+#define PATHTRACE_DISTRIBUTION_H
+
+#include <tuple>
+#include <vector>
+
+/**
+ * A discrete probability distribution over a fixed set of indices, which can be sampled in constant time
+ *  using Walker's alias method
+ */
+class AliasTable {
+  private:
+    struct Bin {
+        //! Probability of choosing the index of the bin itself rather than its alias
+        float threshold;
+        //! Index chosen in place of the bin's own index
+        int alias;
+        //! Probability of the bin's own index in the represented distribution
+        float p;
+    };
+
+    std::vector<Bin> bins;
+
+  public:
+    AliasTable() = default;
+
+    /**
+     * Constructs an alias table for the distribution proportional to the given weights
+     *
+     * @param weights Non-negative weights of each index, of which at least one should be positive
+     */
+    explicit AliasTable(const std::vector<float> &weights);
+
+    /**
+     * Returns the number of indices in the distribution
+     *
+     * @return Number of indices
+     */
+    int size() const noexcept;
+
+    /**
+     * Returns whether the distribution contains no indices
+     *
+     * @return True if there are no indices, False otherwise
+     */
+    bool empty() const noexcept;
+
+    /**
+     * Chooses an index according to the distribution
+     *
+     * @param u Uniformly distributed value in range [0, 1)
+     * @return Tuple of the chosen index and the probability of choosing it
+     */
+    std::tuple<int, float> sample(float u) const noexcept;
+
+    /**
+     * Returns the probability of choosing the given index
+     *
+     * @param index Index in range [0, size())
+     * @return Probability of choosing the index
+     */
+    float getProbability(int index) const noexcept;
+};
+
+/**
+ * A piecewise constant probability distribution over the unit square, defined by a grid of weights,
+ *  which is sampled by first choosing a row using the marginal distribution of the rows
+ *  and then choosing a column using the conditional distribution within that row
+ */
+class Distribution2D {
+  private:
+    int width = 0;
+    int height = 0;
+
+    //! Densities of each cell with respect to the area of the unit square, stored row by row
+    std::vector<float> densities;
+    //! Cumulative distributions of the columns within each row, with width + 1 entries per row
+    std::vector<float> conditional_cdfs;
+    //! Cumulative distribution of the rows, with height + 1 entries
+    std::vector<float> marginal_cdf;
+
+  public:
+    Distribution2D() = default;
+
+    /**
+     * Constructs a distribution proportional to the given grid of weights
+     * If no weight is positive, the distribution is uniform instead
+     *
+     * @param weights Non-negative weights of each cell, stored row by row
+     * @param width Number of columns of the grid
+     * @param height Number of rows of the grid
+     */
+    Distribution2D(const std::vector<float> &weights, int width, int height);
+
+    /**
+     * Returns whether the distribution contains no cells
+     *
+     * @return True if there are no cells, False otherwise
+     */
+    bool empty() const noexcept;
+
+    /**
+     * Samples a point in the unit square according to the distribution
+     *
+     * @param u1 Uniformly distributed value in range [0, 1) used to choose the column
+     * @param u2 Uniformly distributed value in range [0, 1) used to choose the row
+     * @return Tuple of the x and y coordinates of the sampled point in range [0, 1),
+     *  and the probability density with respect to the area of the unit square
+     */
+    std::tuple<float, float, float> sample(float u1, float u2) const noexcept;
+
+    /**
+     * Computes the probability density of sampling the given point
+     *
+     * @param x x-coordinate of the point in range [0, 1]
+     * @param y y-coordinate of the point in range [0, 1]
+     * @return Probability density with respect to the area of the unit square
+     */
+    float getPdf(float x, float y) const noexcept;
+};
+
+#endif // PATHTRACE_DISTRIBUTION_H
@@ -0,0 +1,140 @@
+#ifndef PATHTRACE_TASK_SCHEDULER_H
+#define PATHTRACE_TASK_SCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+/**
+ * Lock-free double-ended queue of task indices following Chase and Lev, "Dynamic Circular Work-Stealing Deque",
+ *  with the memory orderings of Lê et al., "Correct and Efficient Work-Stealing for Weak Memory Models"
+ * Only the owning worker pushes and pops tasks at the bottom, while any other worker may steal tasks from the top
+ */
+class WorkStealingDeque {
+  private:
+    struct Buffer {
+        std::int64_t capacity;
+        std::unique_ptr<std::atomic<int>[]> tasks;
+
+        explicit Buffer(std::int64_t capacity);
+    };
+
+    //! Index of the next task to be stolen, on its own cache line since it is written by thieves
+    alignas(64) std::atomic<std::int64_t> top = 0;
+    //! Index after the last task, which is only written by the owner
+    alignas(64) std::atomic<std::int64_t> bottom = 0;
+    std::atomic<Buffer *> buffer;
+
+    //! All buffers allocated so far, which are kept until destruction since thieves may still read from a buffer after it was replaced
+    std::vector<std::unique_ptr<Buffer>> buffers;
+
+  public:
+    /**
+     * Marker returned when no task could be taken from a deque
+     */
+    static constexpr int empty = -1;
+
+    /**
+     * Constructs an empty deque
+     *
+     * @param capacity Initial number of tasks the deque can hold before growing
+     */
+    explicit WorkStealingDeque(int capacity = 64);
+
+    /**
+     * Adds a task at the bottom of the deque, must only be called by the owner
+     *  or by another thread while no other thread accesses the deque, such as TaskScheduler::run before starting the workers
+     *
+     * @param task Non-negative index of the task
+     */
+    void push(int task);
+
+    /**
+     * Takes the task at the bottom of the deque, which is the one pushed last, must only be called by the owner
+     *
+     * @return The task, or WorkStealingDeque::empty if the deque is empty
+     */
+    int pop() noexcept;
+
+    /**
+     * Takes the task at the top of the deque, which is the one pushed first, may be called by any thread
+     *
+     * @return Tuple of the task, or WorkStealingDeque::empty if none was taken, and whether the deque was found to be empty
+     *  Taking a task may fail without the deque being empty when another thread took the same task first
+     */
+    std::tuple<int, bool> steal() noexcept;
+};
+
+/**
+ * Runs sets of independent tasks on a number of workers, where each worker owns a WorkStealingDeque of tasks
+ *  and steals tasks from randomly chosen other workers once its own deque is empty
+ * Workers do not share any lock or counter while running tasks, so that even small tasks scale to many threads
+ *
+ * The thread calling run is the first worker, while the threads of all other workers are started once by the constructor
+ *  and wait for the next run in between, so that they and their thread-local data are reused by all runs
+ */
+class TaskScheduler {
+  private:
+    int worker_count;
+    std::unique_ptr<WorkStealingDeque[]> deques;
+    std::vector<std::thread> threads;
+
+    //! Guards the state below, which passes each run to the threads
+    std::mutex mutex;
+    std::condition_variable start_condition;
+    std::condition_variable finish_condition;
+    //! Function of the current run, or nullptr in between runs
+    const std::function<void(int, int)> *function = nullptr;
+    //! Number of runs started so far, from which threads tell whether they already took part in the current run
+    std::uint64_t run_count = 0;
+    //! Number of threads that have not yet finished the current run
+    int running_thread_count = 0;
+    bool stopping = false;
+
+    void runThread(int worker);
+    void runWorker(int worker, const std::function<void(int, int)> &function);
+
+  public:
+    /**
+     * Constructs a scheduler and starts the threads of its workers
+     *
+     * @param worker_count The number of parallel workers to use, including the thread calling run.
+     *  Will be set based on the number of logical system cores if the value is <= 0
+     */
+    explicit TaskScheduler(int worker_count = 0);
+
+    TaskScheduler(const TaskScheduler &) = delete;
+    TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+    /**
+     * Stops and joins the threads of the workers
+     */
+    ~TaskScheduler();
+
+    /**
+     * Returns the number of workers running tasks
+     *
+     * @return Number of workers
+     */
+    int getWorkerCount() const noexcept;
+
+    /**
+     * Runs a function for every task in range [0, task_count) and returns once all tasks are finished
+     * Each worker starts with a contiguous range of tasks, which it runs in ascending order
+     * The calling thread pushes these ranges into the deques of all workers, which is safe since the workers only access them once the run is published
+     * Runs must not be started concurrently or from within a task
+     *
+     * @param task_count Number of tasks
+     * @param function Function called with the index of a task and the index of the worker running it, in range [0, getWorkerCount()),
+     *  which may be called concurrently by all workers, but never concurrently with the same worker index
+     */
+    void run(int task_count, const std::function<void(int, int)> &function);
+};
+
+#endif // PATHTRACE_TASK_SCHEDULER_H
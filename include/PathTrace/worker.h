@@ -5,8 +5,53 @@
 #include <PathTrace/camera.h>
 #include <PathTrace/scene/scene.h>
 #include <PathTrace/image/image.h>
+#include <PathTrace/path_guide.h>
+#include <PathTrace/photon_map.h>
+#include <PathTrace/radiance_cache.h>
+#include <PathTrace/sampler.h>
+#include <PathTrace/util/task_scheduler.h>
 
 #include <functional>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * Strategies for estimating the direct lighting at each vertex of a path
+ */
+enum class DirectLighting {
+    //! Trace a shadow ray towards every light source and several emissive objects, weighted against BSDF sampling
+    Independent,
+    //! Resample many light candidates by their unshadowed contribution and trace a single shadow ray,
+    //!  which keeps the cost per vertex independent of the number of light sources
+    Resampled
+};
+
+/**
+ * Algorithms for estimating the light arriving at the camera
+ */
+enum class Integrator {
+    //! Trace paths from the camera, estimating direct lighting at each vertex
+    PathTracing,
+    //! Trace paths from both the camera and emissive objects, and connect their vertices
+    //! This finds light focused by specular surfaces onto diffuse ones, such as caustics, far more efficiently
+    //! Emission of light sources other than emissive objects is estimated at the camera vertices as in path tracing,
+    //!  and path guiding is not used
+    Bidirectional,
+    //! Stochastic progressive photon mapping, which traces photons from emissive objects in every pass
+    //!  and gathers them around the first non-specular vertex of one camera path per pixel, within a radius that shrinks with every pass
+    //! This resolves light reflected by diffuse surfaces and then seen through specular ones, which no other integrator samples efficiently,
+    //!  but is only consistent rather than unbiased
+    //! Each pass renders one sample per pixel, where the number of passes is the maximum sample count,
+    //!  and light sources other than emissive objects only contribute direct lighting
+    PhotonMapping,
+    //! Primary sample space Metropolis light transport, which runs Markov chains over the random numbers consumed by path tracing,
+    //!  mutating the path of each chain and choosing pixels proportionally to the light arriving at them
+    //! This concentrates samples on bright paths that independent samples rarely find, such as light passing through a small gap
+    //! The maximum sample count is the average number of mutations per pixel, and path guiding is not used
+    Metropolis
+};
 
 /**
  * POD struct specifying various render options
@@ -27,7 +72,192 @@ struct RenderOptions {
 
     //! Whether to allow bias when rendering in order to improve the perceived quality of an image
     //!  rendered with a smaller number of samples, such as by reducing noise and artifacts
+    //! Path tracing then terminates paths at a radiance cache after their first diffuse bounce, if the radiance cache size is positive
     bool allow_bias = false;
+
+    //! Maximum number of vertices of a path traced by path tracing, at the last of which direct lighting is still estimated,
+    //!  or a value <= 0 to only terminate paths by russian roulette, which may never terminate paths in scenes reflecting all light
+    //! Bidirectional path tracing limits each camera and light subpath to this number of vertices after the camera or light
+    int max_path_length = 64;
+
+    //! Number of vertices of a path traced by path tracing, or of a subpath traced by bidirectional path tracing,
+    //!  that are always continued before russian roulette may terminate it
+    int russian_roulette_min_length = 4;
+
+    //! Lower bound of the probability of continuing a path using russian roulette, which is otherwise the throughput of the path,
+    //!  such that dark paths are terminated early and bright paths are continued
+    //! Higher values bound the weight of surviving paths, at the cost of tracing more dark paths
+    float russian_roulette_min_probability = 0.05F;
+
+    //! Sequence generating the random numbers consumed by the samples of each pixel
+    //! Low-discrepancy sequences cover the random decisions of the samples of a pixel more evenly than independent random numbers,
+    //!  which reduces noise at the same sample count
+    //! Metropolis light transport always uses independent random numbers
+    SamplerType sampler = SamplerType::Sobol;
+
+    //! Seed from which all random numbers of a render are derived, such that rendering the same job with the same seed
+    //!  gives an identical image for any number of workers and order of tiles
+    //! This does not hold when using path guiding or the radiance cache, which are learned from sums recorded concurrently
+    std::uint64_t seed = 0;
+
+    //! Strategy for estimating direct lighting
+    DirectLighting direct_lighting = DirectLighting::Independent;
+
+    //! Number of light candidates drawn at each path vertex when using resampled direct lighting
+    int resampling_candidate_count = 16;
+
+    //! Whether path tracing weights light sampling and BSDF sampling against each other using the power heuristic,
+    //!  or otherwise only collects emission by light sampling wherever light sampling can find it
+    bool multiple_importance_sampling = true;
+
+    //! Whether to learn the distribution of incident radiance while rendering, and sample directions proportionally to it
+    //!  in addition to sampling BSDFs
+    bool path_guiding = false;
+
+    //! Number of training passes rendered before the final image when using path guiding,
+    //!  where each pass uses twice as many samples per pixel as the previous one, starting at one
+    int guiding_training_pass_count = 4;
+
+    //! Probability of sampling directions from the learned distribution rather than the BSDF when using path guiding
+    float guiding_probability = 0.5F;
+
+    //! Number of photons traced in every pass when using photon mapping
+    int photon_count = 100000;
+
+    //! Initial radius in which photons are gathered around camera path vertices when using photon mapping,
+    //!  or a value <= 0 to use 1% of the diagonal of the scene bounds
+    float photon_radius = 0.0F;
+
+    //! Fraction of the photons gathered in a pass that are kept when the gather radius shrinks after the pass, in range (0, 1)
+    //! Smaller values shrink the radius faster, reducing bias at the cost of noise
+    float photon_radius_alpha = 0.7F;
+
+    //! Maximum number of cells of the radiance cache used by path tracing when bias is allowed, or 0 to not use a radiance cache
+    //! The radiance cache is not used unless requested, where a typical size is 1 << 18 cells
+    int radiance_cache_size = 0;
+
+    //! Edge length of the cells of the radiance cache, or a value <= 0 to use 3% of the diagonal of the scene bounds
+    //! Larger cells reduce noise at the cost of blurring the cached light
+    float radiance_cache_cell_size = 0.0F;
+
+    //! Number of passes of one sample per pixel used to train the radiance cache before rendering the image,
+    //!  where all passes except the first already terminate their paths at the cache
+    int radiance_cache_training_pass_count = 4;
+
+    //! Number of independent samples used to estimate the brightness of the image and to choose the initial paths of the Markov chains
+    //!  when using Metropolis light transport
+    int bootstrap_sample_count = 100000;
+
+    //! Number of Markov chains of Metropolis light transport, which are distributed over the worker threads
+    int metropolis_chain_count = 1000;
+
+    //! Probability of mutating a path of Metropolis light transport by sampling it independently rather than perturbing it
+    float large_step_probability = 0.3F;
+
+    //! Standard deviation of the perturbation of each random number by small mutations of Metropolis light transport
+    float mutation_size = 0.01F;
+};
+
+/**
+ * Counters collected while rendering, which may be updated concurrently by all worker threads
+ */
+struct RenderStatistics {
+    //! Number of shadow rays traced towards light samples
+    std::atomic<std::int64_t> shadow_ray_count = 0;
+    //! Number of shadow rays found to be occluded by the cached last occluder of their light,
+    //!  without traversing the BVH
+    std::atomic<std::int64_t> occluder_cache_hit_count = 0;
+
+    /**
+     * Computes the fraction of shadow rays resolved by the occluder cache
+     *
+     * @return Hit rate of the occluder cache in range [0, 1], or 0 if no shadow rays were traced
+     */
+    float getOccluderCacheHitRate() const noexcept;
+};
+
+/**
+ * Image accumulating the contributions of light paths connected directly to the camera, which may be updated concurrently
+ * Every camera sample traces one light path, whose contributions may fall onto any pixel
+ * Contributions are summed in fixed point, so that the sums do not depend on the order in which they are added
+ */
+struct SplatImage {
+    int width;
+    int height;
+    //! Sums of the contributions to the color channels of each pixel in fixed point, stored row by row
+    std::unique_ptr<std::atomic<std::int64_t>[]> sums;
+    //! Number of light paths traced
+    std::atomic<std::int64_t> path_count = 0;
+
+    SplatImage(int width, int height);
+
+    /**
+     * Adds the contribution of a light path to a pixel
+     *
+     * @param x x-position of the pixel
+     * @param y y-position of the pixel
+     * @param color Contribution of the light path, where non-finite channels are dropped
+     */
+    void add(int x, int y, Color<float> color) noexcept;
+
+    /**
+     * Computes the estimate of the light arriving at a pixel, averaged over all light paths
+     *
+     * @param x x-position of the pixel
+     * @param y y-position of the pixel
+     * @return Estimated color of the pixel, with an alpha value of 0
+     */
+    Color<float> get(int x, int y) const noexcept;
+};
+
+/**
+ * Statistics of a pixel refined by every pass of progressive photon mapping
+ */
+struct PhotonPixel {
+    //! Sum of the emission and direct lighting found by the camera paths of all passes
+    Spectrum direct;
+    //! Power of the photons gathered so far, scaled down along with the gather area whenever the radius shrinks
+    Spectrum flux;
+    //! Radius around the camera path vertex in which photons are gathered
+    float radius;
+    //! Number of photons accounted for by the flux
+    float photon_count;
+    //! Whether any camera path of the pixel hit the scene
+    bool collected;
+};
+
+/**
+ * State of progressive photon mapping that is kept across passes
+ */
+struct PhotonMappingState {
+    int width;
+    int height;
+    //! Photons traced during the current pass
+    PhotonMap photon_map;
+    //! Number of photons emitted during all passes up to and including the current one
+    std::int64_t emitted_photon_count = 0;
+    //! Number of passes up to and including the current one
+    int pass_count = 0;
+    //! Statistics of each pixel, stored row by row
+    std::vector<PhotonPixel> pixels;
+
+    PhotonMappingState(int width, int height, float radius);
+
+    /**
+     * Computes the estimate of the light arriving at a pixel from all passes so far
+     *
+     * @param x x-position of the pixel
+     * @param y y-position of the pixel
+     * @return Estimated color of the pixel
+     */
+    Color<float> get(int x, int y) const noexcept;
+
+    /**
+     * Returns the largest gather radius of any pixel
+     *
+     * @return Largest radius
+     */
+    float getMaxRadius() const noexcept;
 };
 
 /**
@@ -37,6 +267,12 @@ struct FrameRenderJob {
     const Camera &camera;
     const Scene &scene;
     const RenderOptions &options;
+
+    //! Non-owning raw pointer to the statistics updated while rendering, or nullptr to not collect statistics
+    RenderStatistics *statistics = nullptr;
+
+    //! Algorithm used to render the image
+    Integrator integrator = Integrator::PathTracing;
 };
 
 /**
@@ -55,21 +291,79 @@ struct WorkItem {
     //! Height of the tile
     int height;
 
+    //! Non-owning raw pointer to the path guide used to sample directions, or nullptr to only sample BSDFs
+    PathGuide *path_guide;
+    //! Whether to record the radiance found along paths into the path guide
+    bool record_path_guide;
+
+    //! Non-owning raw pointer to the image that bidirectional path tracing connects light paths to the camera on,
+    //!  or nullptr to not connect light paths to the camera
+    SplatImage *splat_image;
+
+    //! Non-owning raw pointer to the state of progressive photon mapping, whose current pass is rendered for the tile,
+    //!  or nullptr if not using photon mapping
+    PhotonMappingState *photon_state;
+
+    //! Non-owning raw pointer to the radiance cache that paths are terminated at, or nullptr to trace full paths
+    RadianceCache *radiance_cache;
+    //! Whether to record the radiance reflected at the vertices of paths into the radiance cache
+    bool record_radiance_cache;
+
     WorkItem() noexcept;
-    WorkItem(const FrameRenderJob *job, int offset_x, int offset_y, int width, int height) noexcept;
+    WorkItem(const FrameRenderJob *job, int offset_x, int offset_y, int width, int height, PathGuide *path_guide = nullptr,
+             bool record_path_guide = false, SplatImage *splat_image = nullptr, PhotonMappingState *photon_state = nullptr,
+             RadianceCache *radiance_cache = nullptr, bool record_radiance_cache = false) noexcept;
 };
 
 /**
- * Processes a single WorkItem sequentially
+ * Processes a single WorkItem sequentially, writing the rendered tile into a view
+ * Random numbers are derived from the seed in the render options of the job, independently of the thread processing the item
  *
  * @param item the item
- * @param re Random engine to use for sampling, must be exclusive to this function and its thread while this function is being executed
- * @return rendered tile
+ * @param image View of the size of the tile receiving the rendered pixels, such as the region of the tile within the output image
+ */
+void processItem(const WorkItem &item, ImageView<> image);
+
+/**
+ * Renders a stream of FrameRenderJob objects in parallel, keeping its worker threads alive between jobs
+ * This avoids starting threads for every job, and lets the workers reuse their thread-local buffers,
+ *  which matters when rendering many small frames such as the frames of an animation
  */
-Image<> processItem(const WorkItem &item, RandomEngine &re);
+class RenderContext {
+  private:
+    TaskScheduler scheduler;
+
+  public:
+    /**
+     * Constructs a render context and starts its workers
+     *
+     * @param worker_count The number of parallel workers to use, including the thread calling render.
+     *  Will be set based on the number of logical system cores if the value is <= 0
+     */
+    explicit RenderContext(int worker_count = 0);
+
+    /**
+     * Returns the number of workers rendering each job
+     *
+     * @return Number of workers
+     */
+    int getWorkerCount() const noexcept;
+
+    /**
+     * Renders a job using the workers of this context, must not be called concurrently
+     *
+     * @param job the job
+     * @param progress_callback A callback to be called for each tile after rendering,
+     *  with the number of finished tiles and total tiles as arguments.
+     *  This callback may be called by any of the worked threads,
+     *  but will not be called by more than one worked thread at a time.
+     * @return rendered image
+     */
+    Image<> render(const FrameRenderJob &job, const std::function<void(int, int)> &progress_callback = [](int, int) {});
+};
 
 /**
- * Renders FrameRenderJob in parallel
+ * Renders FrameRenderJob in parallel, using a RenderContext that only exists for this job
  *
  * @param job the job
  * @param progress_callback A callback to be called for each tile after rendering,
@@ -3,14 +3,15 @@
 #include <cmath>
 #include <random>
 #include <algorithm>
+#include <limits>
 
 std::tuple<float, float> CircularApertureSampler::sampleAperture(RandomEngine &re) const noexcept {
     constexpr float pi = static_cast<float>(M_PI);
 
-    std::uniform_real_distribution<float> dist(0, 1);
+    auto [r1, r2] = re.getFloats<2>();
 
-    auto r = std::sqrt(dist(re));
-    auto theta = 2 * pi * dist(re);
+    auto r = std::sqrt(r1);
+    auto theta = 2 * pi * r2;
 
     auto x = r * std::cos(theta);
     auto y = r * std::sin(theta);
@@ -23,29 +24,23 @@ HexagonalApertureSampler::HexagonalApertureSampler(float horizontal_ratio) noexc
 }
 
 std::tuple<float, float> HexagonalApertureSampler::sampleAperture(RandomEngine &re) const noexcept {
-    std::uniform_real_distribution<float> dist(0, 1);
-    std::bernoulli_distribution dist_flip;
-
-    float x; // NOLINT(cppcoreguidelines-init-variables)
-    float y; // NOLINT(cppcoreguidelines-init-variables)
-    bool in_polygon; // NOLINT(cppcoreguidelines-init-variables)
-    do {
-        x = dist(re);
-        y = dist(re);
+    // The quadrant is chosen by the upper half of each number, so that the first candidate takes a single pair of dimensions,
+    //  while rejected candidates are redrawn from numbers that do not consume dimensions
+    auto samples = re.getFloats<2>();
+    for(;;) {
+        bool flip_x = samples[0] < 0.5F;
+        bool flip_y = samples[1] < 0.5F;
+        float x = 2.0F * samples[0] - (flip_x ? 0.0F : 1.0F);
+        float y = 2.0F * samples[1] - (flip_y ? 0.0F : 1.0F);
 
         auto relative_x = x - horizontal_ratio;
 
-        in_polygon = (relative_x <= 0.0F) || (relative_x / (1.0F - horizontal_ratio)) >= y;
-    } while(!in_polygon);
+        if((relative_x <= 0.0F) || (relative_x / (1.0F - horizontal_ratio)) >= y) {
+            return std::make_tuple(flip_x ? -x : x, flip_y ? -y : y);
+        }
 
-    if(dist_flip(re)) {
-        x = -x;
-    }
-    if(dist_flip(re)) {
-        y = -y;
+        samples = re.getIndependentFloats<2>();
     }
-
-    return std::make_tuple(x, y);
 }
 
 Camera::Camera(vec3<float> origin, vec3<float> look_at, vec3<float> up, float focal_length, float height, float aspect_ratio) noexcept :
@@ -76,11 +71,10 @@ Camera::Camera(vec3<float> origin, vec3<float> look_at, vec3<float> up, float fo
 }
 
 Ray Camera::shootRay(float x, float y, float pixel_width, float pixel_height, RandomEngine &re) const noexcept {
-    std::uniform_real_distribution<float> dist_x(-pixel_width / 2.0F, pixel_width / 2.0F);
-    std::uniform_real_distribution<float> dist_y(-pixel_height / 2.0F, pixel_height / 2.0F);
+    auto [sample_x, sample_y] = re.getFloats<2>();
 
-    auto offset_x = dist_x(re);
-    auto offset_y = dist_y(re);
+    auto offset_x = (sample_x - 0.5F) * pixel_width;
+    auto offset_y = (sample_y - 0.5F) * pixel_height;
 
     auto sensor_x = x + offset_x;
     auto sensor_y = y + offset_y;
@@ -111,3 +105,53 @@ Ray Camera::shootRay(float x, float y, float pixel_width, float pixel_height, Ra
 
     return {ray_origin, ray_dir};
 }
+
+float Camera::getProjectedSize(vec3<float> center, float radius) const noexcept {
+    auto focal_length = this->forward.getLength();
+    auto depth = dot(center - this->origin, this->forward) / focal_length;
+
+    if(!(depth > radius)) {
+        return std::numeric_limits<float>::infinity();
+    }
+
+    // The sensor height is twice the length of the up vector
+    return radius * focal_length / (depth * this->up.getLength());
+}
+
+bool Camera::isPinhole() const noexcept {
+    return !this->aperture_sampler || (this->aperture_width_half == 0.0F && this->aperture_height_half == 0.0F);
+}
+
+vec3<float> Camera::getOrigin() const noexcept {
+    return this->origin;
+}
+
+std::tuple<float, float, float> Camera::projectDirection(vec3<float> dir) const noexcept {
+    // Rays of a sensor position (x, y) point along forward + up * y + right * x, so intersect the direction with that plane
+    auto plane_normal = cross(this->up, this->right);
+    auto plane_normal_length = plane_normal.getLength();
+    plane_normal = plane_normal / plane_normal_length;
+
+    auto forward_dot = dot(this->forward, plane_normal);
+    auto dir_dot = dot(dir, plane_normal);
+    if(!(dir_dot * forward_dot > 0.0F)) {
+        return std::make_tuple(0.0F, 0.0F, 0.0F);
+    }
+
+    auto plane_pos = dir * (forward_dot / dir_dot);
+    auto offset = plane_pos - this->forward;
+
+    // The right vector is perpendicular to both other vectors, while the up vector may not be perpendicular to the forward vector
+    auto x = dot(offset, this->right) / this->right.getLengthSquared();
+    auto y = dot(offset - this->right * x, this->up) / this->up.getLengthSquared();
+    if(!(std::abs(x) <= 1.0F && std::abs(y) <= 1.0F)) {
+        return std::make_tuple(0.0F, 0.0F, 0.0F);
+    }
+
+    // Sensor positions cover an area of 4 in sensor coordinates, which is scaled by the length of the cross product onto the plane,
+    //  and then projected onto the sphere of directions
+    auto distance = plane_pos.getLength();
+    auto pd = distance * distance * distance / (4.0F * plane_normal_length * std::abs(forward_dot));
+
+    return std::make_tuple(x, y, pd);
+}
@@ -12,6 +12,8 @@
 #include <algorithm>
 #include <stdexcept>
 #include <csetjmp>
+#include <cstring>
+#include <bit>
 
 namespace io {
 
@@ -106,7 +108,7 @@ namespace io {
             stream.flush();
         }
 
-        void writePNGImage(std::basic_ostream<char> &stream, const Image<Color<float>> &image) {
+        void writePNGImage(std::basic_ostream<char> &stream, ImageView<const Color<float>> image) {
             png_structp png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
             if(png_ptr == nullptr) {
                 throw std::logic_error("Couldn't create PNG write struct");
@@ -151,6 +153,73 @@ namespace io {
             png_destroy_write_struct(&png_ptr, &info_ptr);
         }
 
+        // Bounds of the dimensions of PFM images, which keep the pixel count within the range of int and bound the memory of malformed headers
+        constexpr int max_pfm_dimension = 1 << 16;
+        constexpr std::int64_t max_pfm_pixel_count = 1 << 27;
+
+        Image<Color<float>> readPFMImage(std::basic_istream<char> &stream) {
+            // The header consists of the format identifier, the dimensions and the scale, separated by whitespace
+            std::string format;
+            int width = 0;
+            int height = 0;
+            float scale = 0.0F;
+            stream >> format >> width >> height >> scale;
+
+            if(!stream || (format != "PF" && format != "Pf")) {
+                throw std::logic_error("Error reading PFM header");
+            }
+            if(width <= 0 || height <= 0 || scale == 0.0F) {
+                throw std::logic_error("Invalid PFM dimensions or scale");
+            }
+            if(width > max_pfm_dimension || height > max_pfm_dimension || static_cast<std::int64_t>(width) * height > max_pfm_pixel_count) {
+                throw std::logic_error("PFM dimensions exceed the supported maximum");
+            }
+
+            // A single whitespace character separates the header from the pixel data
+            stream.get();
+
+            // Rows are read one at a time, so that memory only grows with the pixel data actually present rather than with the dimensions in the header
+            int channel_count = format == "PF" ? 3 : 1;
+            std::size_t row_size = static_cast<std::size_t>(width) * channel_count;
+            std::vector<float> values;
+            for(int y = 0; y < height; y++) {
+                values.resize(values.size() + row_size);
+                stream.read(reinterpret_cast<char *>(&values[values.size() - row_size]), static_cast<std::streamsize>(row_size * sizeof(float))); // NOLINT
+                if(!stream) {
+                    throw std::logic_error("Error reading PFM pixel data");
+                }
+            }
+
+            // The sign of the scale specifies the byte order, where negative values denote little endian data
+            bool little_endian = scale < 0.0F;
+            if(little_endian != (std::endian::native == std::endian::little)) {
+                for(float &value : values) {
+                    std::uint32_t bits;
+                    std::memcpy(&bits, &value, sizeof(bits));
+                    bits = ((bits & 0xFFU) << 24U) | ((bits & 0xFF00U) << 8U) | ((bits >> 8U) & 0xFF00U) | (bits >> 24U);
+                    std::memcpy(&value, &bits, sizeof(bits));
+                }
+            }
+
+            Image image = {width, height};
+
+            // Rows are stored from bottom to top
+            for(int y = 0; y < height; y++) {
+                const float *row = &values[static_cast<std::size_t>(height - 1 - y) * width * channel_count];
+                for(int x = 0; x < width; x++) {
+                    const float *pixel = &row[x * channel_count]; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                    if(channel_count == 3) {
+                        image(x, y) = {pixel[0], pixel[1], pixel[2], 1.0F}; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                    }
+                    else {
+                        image(x, y) = {pixel[0], pixel[0], pixel[0], 1.0F};
+                    }
+                }
+            }
+
+            return image;
+        }
+
     } // namespace impl
 
     Image<Color<float>> readRGBImage(std::basic_istream<char> &stream) noexcept(false) {
@@ -167,18 +236,32 @@ namespace io {
         return readRGBImage(stream);
     }
 
-    void writeRGBImage(std::basic_ostream<char> &stream, const Image<Color<float>> &image) noexcept(false) {
+    void writeRGBImage(std::basic_ostream<char> &stream, ImageView<const Color<float>> image) noexcept(false) {
         return impl::writePNGImage(stream, image);
     }
 
-    void writeRGBImage(const std::string &path, const Image<Color<float>> &image) noexcept(false) {
+    void writeRGBImage(const std::string &path, ImageView<const Color<float>> image) noexcept(false) {
         std::ofstream stream(path, std::ios_base::out | std::ios_base::binary);
         return writeRGBImage(stream, image);
     }
 
-    void writeRGBImage(const std::filesystem::path &path, const Image<Color<float>> &image) noexcept(false) {
+    void writeRGBImage(const std::filesystem::path &path, ImageView<const Color<float>> image) noexcept(false) {
         std::ofstream stream(path, std::ios_base::out | std::ios_base::binary);
         return writeRGBImage(stream, image);
     }
 
+    Image<Color<float>> readHDRImage(std::basic_istream<char> &stream) noexcept(false) {
+        return impl::readPFMImage(stream);
+    }
+
+    Image<Color<float>> readHDRImage(const std::filesystem::path &path) noexcept(false) {
+        std::ifstream stream(path, std::ios_base::in | std::ios_base::binary);
+        return readHDRImage(stream);
+    }
+
+    Image<Color<float>> readHDRImage(const std::string &path) noexcept(false) {
+        std::ifstream stream(path, std::ios_base::in | std::ios_base::binary);
+        return readHDRImage(stream);
+    }
+
 } // namespace io
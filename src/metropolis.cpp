@@ -0,0 +1,84 @@
+#include <PathTrace/metropolis.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+PrimarySampleSequence::PrimarySampleSequence(std::uint64_t seed, float mutation_size, float large_step_probability) :
+  re(seed), mutation_size(mutation_size), large_step_probability(large_step_probability) {}
+
+void PrimarySampleSequence::startIteration() noexcept {
+    this->current_iteration++;
+    this->large_step = this->re.getFloat() < this->large_step_probability;
+    this->sample_index = 0;
+}
+
+void PrimarySampleSequence::accept() noexcept {
+    if(this->large_step) {
+        this->last_large_step_iteration = this->current_iteration;
+    }
+}
+
+void PrimarySampleSequence::reject() noexcept {
+    for(auto &sample : this->samples) {
+        if(sample.last_modification == this->current_iteration) {
+            sample.value = sample.value_backup;
+            sample.last_modification = sample.modification_backup;
+        }
+    }
+
+    this->current_iteration--;
+}
+
+void PrimarySampleSequence::mutate(std::size_t index) noexcept {
+    if(index >= this->samples.size()) {
+        this->samples.resize(index + 1, {0.0F, 0, 0.0F, 0});
+    }
+
+    auto &sample = this->samples[index];
+
+    // Samples not consumed since the last accepted large step still hold an outdated value, which is replaced as the large step would have
+    if(sample.last_modification < this->last_large_step_iteration) {
+        sample.value = this->re.getFloat();
+        sample.last_modification = this->last_large_step_iteration;
+    }
+
+    sample.value_backup = sample.value;
+    sample.modification_backup = sample.last_modification;
+
+    if(this->large_step) {
+        sample.value = this->re.getFloat();
+    }
+    else {
+        // Samples skipped by previous small steps are perturbed by all of them at once, where the perturbations add up to a wider normal distribution
+        auto small_step_count = static_cast<float>(this->current_iteration - sample.last_modification);
+        sample.value += this->getNormal() * this->mutation_size * std::sqrt(small_step_count);
+        sample.value -= std::floor(sample.value);
+        sample.value = std::min(sample.value, std::nextafter(1.0F, 0.0F));
+    }
+
+    sample.last_modification = this->current_iteration;
+}
+
+float PrimarySampleSequence::getNormal() noexcept {
+    constexpr float pi = static_cast<float>(M_PI);
+
+    // Box-Muller transform, rather than std::normal_distribution, whose values depend on the standard library,
+    //  so that renders are the same on every platform
+    auto [u1, u2] = this->re.getFloats<2>();
+
+    return std::sqrt(-2.0F * std::log(1.0F - u1)) * std::cos(2.0F * pi * u2);
+}
+
+float PrimarySampleSequence::nextSample() noexcept {
+    auto index = this->sample_index++;
+    this->mutate(index);
+
+    return this->samples[index].value;
+}
+
+uint32_t PrimarySampleSequence::next() noexcept {
+    constexpr double scale = static_cast<double>(std::numeric_limits<uint32_t>::max()) + 1.0;
+
+    return static_cast<uint32_t>(std::min(static_cast<double>(this->nextSample()) * scale, scale - 1.0));
+}
@@ -0,0 +1,278 @@
+#include <PathTrace/path_guide.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace impl {
+    constexpr float pi = static_cast<float>(M_PI);
+
+    // Quadrants holding more than this fraction of the energy of a directional tree are subdivided
+    constexpr float directional_split_fraction = 0.01F;
+    constexpr int max_directional_depth = 20;
+
+    // Maps a direction to the unit square using the area-preserving cylindrical mapping
+    std::tuple<float, float> getCylindricalCoordinates(vec3<float> dir) {
+        float phi = std::atan2(dir[1], dir[0]);
+        if(phi < 0.0F) {
+            phi += 2.0F * pi;
+        }
+
+        float x = std::clamp((dir[2] + 1.0F) * 0.5F, 0.0F, 1.0F);
+        float y = std::clamp(phi / (2.0F * pi), 0.0F, 1.0F);
+
+        return std::make_tuple(x, y);
+    }
+
+    vec3<float> getCylindricalDirection(float x, float y) {
+        float cos_theta = 2.0F * x - 1.0F;
+        float sin_theta = std::sqrt(std::max(1.0F - cos_theta * cos_theta, 0.0F));
+        float phi = 2.0F * pi * y;
+
+        return {sin_theta * std::cos(phi), sin_theta * std::sin(phi), cos_theta};
+    }
+
+    // Chooses one of two options with probability proportional to their weights, rescaling the random value for reuse
+    int chooseHalf(float first, float second, float &u) {
+        float total = first + second;
+        float p = total > 0.0F ? first / total : 0.5F;
+
+        if(u < p) {
+            u = std::min(u / p, std::nextafter(1.0F, 0.0F));
+            return 0;
+        }
+
+        u = std::min((u - p) / (1.0F - p), std::nextafter(1.0F, 0.0F));
+        return 1;
+    }
+}
+
+PathGuide::DirectionalTree::DirectionalTree() : nodes{{{0.0F, 0.0F, 0.0F, 0.0F}, {0, 0, 0, 0}}}, recorded_sums(std::make_unique<std::atomic<float>[]>(4)) {}
+
+void PathGuide::DirectionalTree::record(float x, float y, float weight) noexcept {
+    int index = 0;
+    for(;;) {
+        int qx = x >= 0.5F ? 1 : 0;
+        int qy = y >= 0.5F ? 1 : 0;
+        int quadrant = qx + 2 * qy;
+
+        this->recorded_sums[4 * index + quadrant].fetch_add(weight, std::memory_order_relaxed);
+
+        int child = this->nodes[index].children[quadrant];
+        if(child == 0) {
+            return;
+        }
+
+        x = 2.0F * x - static_cast<float>(qx);
+        y = 2.0F * y - static_cast<float>(qy);
+        index = child;
+    }
+}
+
+std::tuple<float, float, float> PathGuide::DirectionalTree::sample(float u1, float u2) const noexcept {
+    float pd = 1.0F;
+    float offset_x = 0.0F;
+    float offset_y = 0.0F;
+    float size = 1.0F;
+
+    int index = 0;
+    for(;;) {
+        const auto &sums = this->nodes[index].sums;
+        float total = sums[0] + sums[1] + sums[2] + sums[3];
+
+        // Choose the column first and then the quadrant within the column
+        int qx = impl::chooseHalf(sums[0] + sums[2], sums[1] + sums[3], u1);
+        int qy = impl::chooseHalf(sums[qx], sums[qx + 2], u2);
+        int quadrant = qx + 2 * qy;
+
+        pd *= total > 0.0F ? 4.0F * sums[quadrant] / total : 1.0F;
+
+        size *= 0.5F;
+        offset_x += static_cast<float>(qx) * size;
+        offset_y += static_cast<float>(qy) * size;
+
+        int child = this->nodes[index].children[quadrant];
+        if(child == 0) {
+            return std::make_tuple(offset_x + u1 * size, offset_y + u2 * size, pd);
+        }
+
+        index = child;
+    }
+}
+
+float PathGuide::DirectionalTree::getPdf(float x, float y) const noexcept {
+    float pd = 1.0F;
+
+    int index = 0;
+    for(;;) {
+        const auto &sums = this->nodes[index].sums;
+        float total = sums[0] + sums[1] + sums[2] + sums[3];
+
+        int qx = x >= 0.5F ? 1 : 0;
+        int qy = y >= 0.5F ? 1 : 0;
+        int quadrant = qx + 2 * qy;
+
+        pd *= total > 0.0F ? 4.0F * sums[quadrant] / total : 1.0F;
+
+        int child = this->nodes[index].children[quadrant];
+        if(child == 0) {
+            return pd;
+        }
+
+        x = 2.0F * x - static_cast<float>(qx);
+        y = 2.0F * y - static_cast<float>(qy);
+        index = child;
+    }
+}
+
+int PathGuide::DirectionalTree::buildRefined(const DirectionalTree &source, int source_index, std::array<float, 4> sums, float total, float threshold,
+                                             int depth) {
+    int index = static_cast<int>(this->nodes.size());
+    this->nodes.push_back({sums, {0, 0, 0, 0}});
+
+    for(int quadrant = 0; quadrant < 4; quadrant++) {
+        if(!(sums[quadrant] > threshold * total) || depth >= impl::max_directional_depth) {
+            continue;
+        }
+
+        // Subdivide quadrants holding much energy, distributing it evenly where nothing finer was recorded
+        int source_child = source_index >= 0 ? source.nodes[source_index].children[quadrant] : 0;
+
+        std::array<float, 4> child_sums;
+        if(source_child != 0) {
+            for(int i = 0; i < 4; i++) {
+                child_sums[i] = source.recorded_sums[4 * source_child + i].load(std::memory_order_relaxed);
+            }
+        }
+        else {
+            child_sums.fill(sums[quadrant] * 0.25F);
+        }
+
+        int child = this->buildRefined(source, source_child != 0 ? source_child : -1, child_sums, total, threshold, depth + 1);
+        this->nodes[index].children[quadrant] = child;
+    }
+
+    return index;
+}
+
+void PathGuide::DirectionalTree::refine(const DirectionalTree &source, float threshold) {
+    std::array<float, 4> sums;
+    for(int i = 0; i < 4; i++) {
+        sums[i] = source.recorded_sums[i].load(std::memory_order_relaxed);
+    }
+    float total = sums[0] + sums[1] + sums[2] + sums[3];
+
+    this->nodes.clear();
+    this->buildRefined(source, 0, sums, total, threshold, 1);
+
+    this->recorded_sums = std::make_unique<std::atomic<float>[]>(4 * this->nodes.size());
+    this->sample_count = 0;
+}
+
+float PathGuide::DirectionalTree::getRecordedEnergy() const noexcept {
+    float total = 0.0F;
+    for(int i = 0; i < 4; i++) {
+        total += this->recorded_sums[i].load(std::memory_order_relaxed);
+    }
+
+    return total;
+}
+
+bool PathGuide::DirectionalTree::hasEnergy() const noexcept {
+    const auto &sums = this->nodes[0].sums;
+
+    return sums[0] + sums[1] + sums[2] + sums[3] > 0.0F;
+}
+
+PathGuide::PathGuide(AABBArea area, std::int64_t spatial_split_threshold) : spatial_split_threshold(spatial_split_threshold) {
+    this->spatial_nodes.push_back({area, 0, 0, 0});
+    this->directional_trees.push_back(std::make_unique<DirectionalTree>());
+}
+
+int PathGuide::getDirectionalTreeIndex(vec3<float> pos) const noexcept {
+    int index = 0;
+    while(this->spatial_nodes[index].children != 0) {
+        const auto &node = this->spatial_nodes[index];
+
+        float mid = 0.5F * (node.area.low[node.axis] + node.area.high[node.axis]);
+        index = node.children + (pos[node.axis] >= mid ? 1 : 0);
+    }
+
+    return this->spatial_nodes[index].tree;
+}
+
+bool PathGuide::isTrained() const noexcept {
+    return this->trained;
+}
+
+void PathGuide::record(vec3<float> pos, vec3<float> dir, float weight) noexcept {
+    if(!std::isfinite(weight) || weight < 0.0F) {
+        return;
+    }
+
+    auto &tree = *this->directional_trees[this->getDirectionalTreeIndex(pos)];
+
+    auto [x, y] = impl::getCylindricalCoordinates(dir);
+
+    tree.sample_count.fetch_add(1, std::memory_order_relaxed);
+    tree.record(x, y, weight);
+}
+
+void PathGuide::update() {
+    int node_count = static_cast<int>(this->spatial_nodes.size());
+    for(int index = 0; index < node_count; index++) {
+        if(this->spatial_nodes[index].children != 0) {
+            continue;
+        }
+
+        int tree_index = this->spatial_nodes[index].tree;
+        std::unique_ptr<DirectionalTree> recorded = std::move(this->directional_trees[tree_index]);
+
+        auto refined = std::make_unique<DirectionalTree>();
+        refined->refine(*recorded, impl::directional_split_fraction);
+        this->directional_trees[tree_index] = std::move(refined);
+
+        if(recorded->sample_count.load(std::memory_order_relaxed) <= this->spatial_split_threshold) {
+            continue;
+        }
+
+        // Split regions in which many samples were recorded in half along their longest axis, where both halves start out
+        //  with the distribution of the whole region
+        AABBArea area = this->spatial_nodes[index].area;
+        auto extent = area.high - area.low;
+        int axis = static_cast<int>(std::max_element(&extent[0], &extent[0] + 3) - &extent[0]);
+
+        float mid = 0.5F * (area.low[axis] + area.high[axis]);
+        AABBArea low_area = area;
+        AABBArea high_area = area;
+        low_area.high[axis] = mid;
+        high_area.low[axis] = mid;
+
+        auto high_tree = std::make_unique<DirectionalTree>();
+        high_tree->refine(*recorded, impl::directional_split_fraction);
+        this->directional_trees.push_back(std::move(high_tree));
+
+        int children = static_cast<int>(this->spatial_nodes.size());
+        this->spatial_nodes.push_back({low_area, 0, 0, tree_index});
+        this->spatial_nodes.push_back({high_area, 0, 0, static_cast<int>(this->directional_trees.size()) - 1});
+
+        this->spatial_nodes[index].children = children;
+        this->spatial_nodes[index].axis = axis;
+    }
+
+    this->trained = std::any_of(this->directional_trees.begin(), this->directional_trees.end(),
+                                [](const std::unique_ptr<DirectionalTree> &tree) -> bool { return tree->hasEnergy(); });
+}
+
+std::tuple<vec3<float>, float> PathGuide::sample(vec3<float> pos, float u1, float u2) const noexcept {
+    auto [x, y, pd] = this->directional_trees[this->getDirectionalTreeIndex(pos)]->sample(u1, u2);
+
+    // The cylindrical mapping is area-preserving, so the density is divided by the area of the unit sphere
+    return std::make_tuple(impl::getCylindricalDirection(x, y), pd / (4.0F * impl::pi));
+}
+
+float PathGuide::getPdf(vec3<float> pos, vec3<float> dir) const noexcept {
+    auto [x, y] = impl::getCylindricalCoordinates(dir);
+
+    return this->directional_trees[this->getDirectionalTreeIndex(pos)]->getPdf(x, y) / (4.0F * impl::pi);
+}
@@ -0,0 +1,146 @@
+#include <PathTrace/photon_map.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+namespace impl {
+    // Number of groups of buckets photons are first sorted into, which bounds the size of the table of counts of every worker
+    constexpr std::size_t photon_group_count = 4096;
+}
+
+PhotonMap::PhotonMap(const std::vector<std::vector<Photon>> &batches, float cell_size, TaskScheduler &scheduler) : cell_size(cell_size) {
+    assert(cell_size > 0.0F);
+
+    std::size_t photon_count = 0;
+    for(const auto &batch : batches) {
+        photon_count += batch.size();
+    }
+
+    this->photons.resize(photon_count);
+    this->bucket_starts.assign(std::max(photon_count, std::size_t{1}) + 1, 0);
+    if(photon_count == 0) {
+        return;
+    }
+
+    const int batch_count = static_cast<int>(batches.size());
+    const std::size_t bucket_count = this->bucket_starts.size() - 1;
+
+    // Index of the first photon of each batch in the order of the batches
+    std::vector<std::size_t> batch_starts(batch_count + 1, 0);
+    for(int batch = 0; batch < batch_count; batch++) {
+        batch_starts[batch + 1] = batch_starts[batch] + batches[batch].size();
+    }
+
+    // Buckets are partitioned into a fixed number of groups of consecutive buckets, so that the photons can first be sorted into their groups
+    //  with a table of counts per worker and group, and then into their buckets by sorting each group on its own
+    const std::size_t group_count = std::min(bucket_count, impl::photon_group_count);
+    auto getGroup = [&](std::size_t bucket) { return bucket * group_count / bucket_count; };
+    auto getFirstBucket = [&](std::size_t group) { return (group * bucket_count + group_count - 1) / group_count; };
+
+    // Batches are split into one contiguous range of batches per worker, called a chunk, whose photons are counted and moved by a single task
+    const int chunk_count = std::min(batch_count, scheduler.getWorkerCount());
+    auto getFirstBatch = [&](int chunk) { return static_cast<int>(static_cast<std::int64_t>(batch_count) * chunk / chunk_count); };
+
+    // Count the photons of each chunk in each group, stored by chunk so that tasks counting different chunks do not write to the same cache lines,
+    //  and remember the bucket of every photon to not hash it again
+    std::vector<std::size_t> photon_buckets(photon_count);
+    std::vector<std::size_t> chunk_offsets(static_cast<std::size_t>(chunk_count) * group_count, 0);
+    scheduler.run(chunk_count, [&](int chunk, int) {
+        auto *counts = &chunk_offsets[static_cast<std::size_t>(chunk) * group_count];
+        for(int batch = getFirstBatch(chunk); batch < getFirstBatch(chunk + 1); batch++) {
+            auto index = batch_starts[batch];
+            for(const Photon &photon : batches[batch]) {
+                auto bucket = this->getBucket(this->getCell(photon.pos));
+                photon_buckets[index++] = bucket;
+                counts[getGroup(bucket)]++;
+            }
+        }
+    });
+
+    // The counts are replaced by their exclusive prefix sum in the order of the groups and then the chunks, which is the index of the first photon
+    //  of each chunk within each group, and the table only has a fixed number of entries per worker
+    std::vector<std::size_t> group_starts(group_count + 1, 0);
+    std::size_t start = 0;
+    for(std::size_t group = 0; group < group_count; group++) {
+        group_starts[group] = start;
+        for(int chunk = 0; chunk < chunk_count; chunk++) {
+            auto &offset = chunk_offsets[static_cast<std::size_t>(chunk) * group_count + group];
+            auto count = offset;
+            offset = start;
+            start += count;
+        }
+    }
+    group_starts[group_count] = photon_count;
+
+    // Each chunk moves references to its photons in the order of its batches, so that the photons within each group are in the order of the batches
+    //  and do not depend on the number of workers or on timing
+    std::vector<const Photon *> grouped_photons(photon_count);
+    std::vector<std::size_t> grouped_buckets(photon_count);
+    scheduler.run(chunk_count, [&](int chunk, int) {
+        auto *offsets = &chunk_offsets[static_cast<std::size_t>(chunk) * group_count];
+        for(int batch = getFirstBatch(chunk); batch < getFirstBatch(chunk + 1); batch++) {
+            auto index = batch_starts[batch];
+            for(const Photon &photon : batches[batch]) {
+                auto bucket = photon_buckets[index++];
+                auto offset = offsets[getGroup(bucket)]++;
+                grouped_photons[offset] = &photon;
+                grouped_buckets[offset] = bucket;
+            }
+        }
+    });
+
+    // Every group is then sorted into its buckets by a stable counting sort, which keeps the order of the batches within each bucket,
+    //  with ranges of groups sorted in parallel
+    const int range_count = static_cast<int>(std::min(group_count, static_cast<std::size_t>(scheduler.getWorkerCount())));
+    auto getFirstGroup = [&](int range) { return group_count * static_cast<std::size_t>(range) / static_cast<std::size_t>(range_count); };
+
+    scheduler.run(range_count, [&](int range, int) {
+        for(auto group = getFirstGroup(range); group < getFirstGroup(range + 1); group++) {
+            auto first_bucket = getFirstBucket(group);
+            auto last_bucket = getFirstBucket(group + 1);
+
+            // The starts of the buckets of the group serve as their counts and then as their offsets
+            for(auto bucket = first_bucket; bucket < last_bucket; bucket++) {
+                this->bucket_starts[bucket] = 0;
+            }
+            for(auto i = group_starts[group]; i < group_starts[group + 1]; i++) {
+                this->bucket_starts[grouped_buckets[i]]++;
+            }
+
+            auto bucket_start = group_starts[group];
+            for(auto bucket = first_bucket; bucket < last_bucket; bucket++) {
+                auto count = this->bucket_starts[bucket];
+                this->bucket_starts[bucket] = bucket_start;
+                bucket_start += count;
+            }
+
+            // Offsets are advanced while moving and then restored to the bucket starts
+            for(auto i = group_starts[group]; i < group_starts[group + 1]; i++) {
+                this->photons[this->bucket_starts[grouped_buckets[i]]++] = *grouped_photons[i];
+            }
+            for(auto bucket = last_bucket; bucket > first_bucket; bucket--) {
+                this->bucket_starts[bucket - 1] = bucket - 1 > first_bucket ? this->bucket_starts[bucket - 2] : group_starts[group];
+            }
+        }
+    });
+    this->bucket_starts[bucket_count] = photon_count;
+}
+
+std::size_t PhotonMap::size() const noexcept {
+    return this->photons.size();
+}
+
+std::array<int, 3> PhotonMap::getCell(vec3<float> pos) const noexcept {
+    return {static_cast<int>(std::floor(pos[0] / this->cell_size)), static_cast<int>(std::floor(pos[1] / this->cell_size)),
+            static_cast<int>(std::floor(pos[2] / this->cell_size))};
+}
+
+std::size_t PhotonMap::getBucket(std::array<int, 3> cell) const noexcept {
+    // Spatial hash of Teschner et al., where cells with negative coordinates wrap around
+    auto hash = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cell[0])) * 73856093U) ^
+                (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cell[1])) * 19349663U) ^
+                (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cell[2])) * 83492791U);
+
+    return static_cast<std::size_t>(hash % (this->bucket_starts.size() - 1));
+}
@@ -29,7 +29,7 @@ T getBrightnessHeuristic(Color<T> color) {
     return color[3] * ((color[0] + color[1] + color[2]) / static_cast<T>(3) + std::max({color[0], color[1], color[2]})) / static_cast<T>(2);
 }
 
-void toneMap(Image<> &image) {
+void toneMap(ImageView<> image) {
     // This entire function could be parallelized, though it typically only accounts for a small portion of a render's runtime
 
     float min_brightness = 0.0F;
@@ -162,7 +162,7 @@ void toneMap(Image<> &image) {
     }
 }
 
-void gammaCorrect(Image<> &image, float gamma) {
+void gammaCorrect(ImageView<> image, float gamma) {
     for(int y = 0; y < image.getHeight(); y++) {
         for(int x = 0; x < image.getWidth(); x++) {
             auto brightness = getBrightness(image(x, y));
@@ -176,7 +176,7 @@ void gammaCorrect(Image<> &image, float gamma) {
     }
 }
 
-void postProcess(Image<> &image) {
+void postProcess(ImageView<> image) {
     toneMap(image);
     gammaCorrect(image);
 }
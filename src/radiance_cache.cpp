@@ -0,0 +1,119 @@
+#include <PathTrace/radiance_cache.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace impl {
+    // Number of probed entries after which a cell is considered missing or dropped
+    constexpr int max_probe_count = 16;
+
+    // Cells holding fewer samples are not used to terminate paths, since their average is too noisy
+    constexpr std::uint32_t min_cell_sample_count = 8;
+
+    // Number of bits used for each grid coordinate of a key, where coordinates outside of their range wrap around
+    constexpr int coordinate_bits = 20;
+}
+
+RadianceCache::RadianceCache(int size, float cell_size) : size(std::max(size, 1)), cell_size(cell_size), entries(std::make_unique<Entry[]>(this->size)) {
+    assert(cell_size > 0.0F);
+
+    for(int i = 0; i < this->size; i++) {
+        auto &entry = this->entries[i];
+
+        entry.key.store(0, std::memory_order_relaxed);
+        for(auto &sum : entry.sums) {
+            sum.store(0.0F, std::memory_order_relaxed);
+        }
+        entry.count.store(0, std::memory_order_relaxed);
+        entry.radiance = {0.0F, 0.0F, 0.0F, 0.0F};
+        entry.valid = false;
+    }
+}
+
+std::uint64_t RadianceCache::getKey(vec3<float> pos, vec3<float> n) const noexcept {
+    constexpr std::uint64_t coordinate_mask = (std::uint64_t{1} << impl::coordinate_bits) - 1;
+
+    // The highest bit is always set, so that no key is 0
+    std::uint64_t key = std::uint64_t{1} << 63;
+    for(int axis = 0; axis < 3; axis++) {
+        auto coordinate = static_cast<std::int64_t>(std::floor(pos[axis] / this->cell_size));
+        key |= (static_cast<std::uint64_t>(coordinate) & coordinate_mask) << (axis * impl::coordinate_bits);
+    }
+
+    int normal_axis = 0;
+    for(int axis = 1; axis < 3; axis++) {
+        if(std::abs(n[axis]) > std::abs(n[normal_axis])) {
+            normal_axis = axis;
+        }
+    }
+    auto normal_index = static_cast<std::uint64_t>(2 * normal_axis + (n[normal_axis] < 0.0F ? 1 : 0));
+
+    return key | (normal_index << (3 * impl::coordinate_bits));
+}
+
+RadianceCache::Entry *RadianceCache::find(std::uint64_t key, bool insert) const noexcept {
+    auto index = static_cast<int>((key * 0x9E3779B97F4A7C15ULL >> 32) % static_cast<std::uint64_t>(this->size));
+
+    for(int probe = 0; probe < impl::max_probe_count; probe++) {
+        auto &entry = this->entries[index];
+
+        auto entry_key = entry.key.load(std::memory_order_acquire);
+        if(entry_key == key) {
+            return &entry;
+        }
+
+        // Claim unused entries, where another thread may claim the same entry first for the same or another key
+        if(entry_key == 0) {
+            if(!insert) {
+                return nullptr;
+            }
+
+            std::uint64_t expected = 0;
+            if(entry.key.compare_exchange_strong(expected, key, std::memory_order_acq_rel) || expected == key) {
+                return &entry;
+            }
+        }
+
+        index = (index + 1) % this->size;
+    }
+
+    return nullptr;
+}
+
+void RadianceCache::record(vec3<float> pos, vec3<float> n, Color<float> radiance) noexcept {
+    Entry *entry = this->find(this->getKey(pos, n), true);
+    if(entry == nullptr) {
+        return;
+    }
+
+    for(int channel = 0; channel < 3; channel++) {
+        entry->sums[channel].fetch_add(radiance[channel], std::memory_order_relaxed);
+    }
+    entry->count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RadianceCache::update() {
+    for(int i = 0; i < this->size; i++) {
+        auto &entry = this->entries[i];
+
+        auto count = entry.count.load(std::memory_order_relaxed);
+        entry.valid = count >= impl::min_cell_sample_count;
+        if(count == 0) {
+            continue;
+        }
+
+        auto divisor = static_cast<float>(count);
+        entry.radiance = {entry.sums[0].load(std::memory_order_relaxed) / divisor, entry.sums[1].load(std::memory_order_relaxed) / divisor,
+                          entry.sums[2].load(std::memory_order_relaxed) / divisor, 1.0F};
+    }
+}
+
+std::tuple<Color<float>, bool> RadianceCache::get(vec3<float> pos, vec3<float> n) const noexcept {
+    const Entry *entry = this->find(this->getKey(pos, n), false);
+    if(entry == nullptr || !entry->valid) {
+        return std::make_tuple(Color<float>{}, false);
+    }
+
+    return std::make_tuple(entry->radiance, true);
+}
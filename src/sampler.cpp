@@ -0,0 +1,353 @@
+#include <PathTrace/sampler.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace impl {
+    // Mixes the bits of a value so that similar inputs give unrelated outputs, using the finalizer of MurmurHash3
+    std::uint32_t mixBits(std::uint32_t value) noexcept {
+        value ^= value >> 16;
+        value *= 0x85EBCA6BU;
+        value ^= value >> 13;
+        value *= 0xC2B2AE35U;
+        value ^= value >> 16;
+
+        return value;
+    }
+
+    // Mixes the bits of a 64-bit value, using the finalizer of SplitMix64
+    std::uint64_t mixBits64(std::uint64_t value) noexcept {
+        value ^= value >> 30;
+        value *= 0xBF58476D1CE4E5B9ULL;
+        value ^= value >> 27;
+        value *= 0x94D049BB133111EBULL;
+        value ^= value >> 31;
+
+        return value;
+    }
+
+    std::uint32_t hashCombine(std::uint32_t seed, std::uint32_t value) noexcept {
+        return mixBits(seed ^ (value + 0x9E3779B9U + (seed << 6) + (seed >> 2)));
+    }
+
+    std::uint32_t reverseBits(std::uint32_t value) noexcept {
+        value = (value << 16) | (value >> 16);
+        value = ((value & 0x00FF00FFU) << 8) | ((value & 0xFF00FF00U) >> 8);
+        value = ((value & 0x0F0F0F0FU) << 4) | ((value & 0xF0F0F0F0U) >> 4);
+        value = ((value & 0x33333333U) << 2) | ((value & 0xCCCCCCCCU) >> 2);
+        value = ((value & 0x55555555U) << 1) | ((value & 0xAAAAAAAAU) >> 1);
+
+        return value;
+    }
+
+    // Second dimension of the Sobol sequence, whose generator matrix is the Pascal matrix modulo 2
+    std::uint32_t getSobolSecondDimension(std::uint32_t index) noexcept {
+        std::uint32_t result = 0;
+        for(std::uint32_t v = 1U << 31; index != 0; index >>= 1, v ^= v >> 1) {
+            if((index & 1U) != 0) {
+                result ^= v;
+            }
+        }
+
+        return result;
+    }
+
+    // Owen scrambling of a fixed-point value in range [0, 1), using the hash-based nested uniform scramble of Burley
+    std::uint32_t getOwenScrambled(std::uint32_t value, std::uint32_t seed) noexcept {
+        value = reverseBits(value);
+
+        // Laine-Karras permutation, where each bit only depends on the bits below it
+        value += seed;
+        value ^= value * 0x6C50B47CU;
+        value ^= value * 0xB82F1E52U;
+        value ^= value * 0xC7AFE638U;
+        value ^= value * 0x8D22F6E6U;
+
+        return reverseBits(value);
+    }
+
+    // Sample of one of a pair of dimensions of the padded Owen-scrambled Sobol sequence, where the seed of the pair
+    //  shuffles the order of the samples and scrambles their values
+    // Every aligned block of 2^k points of the sequence is stratified, so each power-of-two prefix of the shuffled samples still is
+    std::uint32_t getSobolSample(std::uint32_t index, std::uint32_t component, std::uint32_t pair_seed) noexcept {
+        index ^= pair_seed >> 12;
+
+        std::uint32_t value = component == 0 ? reverseBits(index) : getSobolSecondDimension(index);
+
+        return getOwenScrambled(value, hashCombine(pair_seed, component));
+    }
+
+    constexpr int blue_noise_size_log2 = 6;
+    constexpr int blue_noise_size = 1 << blue_noise_size_log2;
+
+    // Number of leading dimensions of each sample whose error is distributed as blue noise, which covers the position in the pixel,
+    //  the aperture and the decisions at the first vertices, beyond which little of the error remains correlated between neighbouring pixels
+    constexpr std::uint32_t blue_noise_dimension_count = 16;
+
+    // Generates the ranks of the pixels of a tileable blue-noise mask using the void-and-cluster method of Ulichney,
+    //  where the pixels of every range of ranks starting at 0 are spread evenly
+    // Since the energy of the unset pixels is the total energy minus that of the set pixels, filling the tightest cluster of unset pixels
+    //  is the same as filling the largest void, so that all ranks above the initial pixels are assigned the same way
+    std::vector<std::uint32_t> generateBlueNoiseRanks() {
+        constexpr int size = blue_noise_size;
+        constexpr int pixel_count = size * size;
+        constexpr float sigma = 1.5F;
+
+        // Energy that a set pixel adds to the pixels at each toroidal offset from it
+        std::vector<float> kernel(pixel_count);
+        for(int y = 0; y < size; y++) {
+            for(int x = 0; x < size; x++) {
+                auto dx = static_cast<float>(std::min(x, size - x));
+                auto dy = static_cast<float>(std::min(y, size - y));
+                kernel[y * size + x] = std::exp(-(dx * dx + dy * dy) / (2.0F * sigma * sigma));
+            }
+        }
+
+        std::vector<char> set(pixel_count, 0);
+        std::vector<float> energy(pixel_count, 0.0F);
+
+        auto update = [&](int pixel, bool set_pixel) {
+            int pixel_x = pixel % size;
+            int pixel_y = pixel / size;
+            float sign = set_pixel ? 1.0F : -1.0F;
+
+            for(int y = 0; y < size; y++) {
+                for(int x = 0; x < size; x++) {
+                    energy[y * size + x] += sign * kernel[((y - pixel_y) & (size - 1)) * size + ((x - pixel_x) & (size - 1))];
+                }
+            }
+            set[pixel] = set_pixel ? 1 : 0;
+        };
+
+        // The tightest cluster is the set pixel of the highest energy, and the largest void is the unset pixel of the lowest energy
+        auto find = [&](bool cluster) {
+            int best = -1;
+            for(int pixel = 0; pixel < pixel_count; pixel++) {
+                if((set[pixel] != 0) == cluster && (best < 0 || (cluster ? energy[pixel] > energy[best] : energy[pixel] < energy[best]))) {
+                    best = pixel;
+                }
+            }
+
+            return best;
+        };
+
+        // Start with random pixels, and move the tightest cluster into the largest void until that no longer changes anything
+        constexpr int initial_count = pixel_count / 10;
+
+        xorshift engine(1);
+        for(int count = 0; count < initial_count;) {
+            auto pixel = static_cast<int>(engine() % pixel_count);
+            if(set[pixel] == 0) {
+                update(pixel, true);
+                count++;
+            }
+        }
+
+        for(int iteration = 0; iteration < pixel_count; iteration++) {
+            int cluster = find(true);
+            update(cluster, false);
+
+            int void_pixel = find(false);
+            update(void_pixel, true);
+
+            if(void_pixel == cluster) {
+                break;
+            }
+        }
+
+        auto initial_set = set;
+        auto initial_energy = energy;
+
+        // Rank the initial pixels in the order in which removing the tightest cluster takes them away, and all others in the order of filling voids
+        std::vector<std::uint32_t> ranks(pixel_count);
+        for(int rank = initial_count - 1; rank >= 0; rank--) {
+            int cluster = find(true);
+            update(cluster, false);
+            ranks[cluster] = rank;
+        }
+
+        set = std::move(initial_set);
+        energy = std::move(initial_energy);
+        for(int rank = initial_count; rank < pixel_count; rank++) {
+            int void_pixel = find(false);
+            update(void_pixel, true);
+            ranks[void_pixel] = rank;
+        }
+
+        return ranks;
+    }
+
+    const std::vector<std::uint32_t> &getBlueNoiseRanks() {
+        static const std::vector<std::uint32_t> ranks = generateBlueNoiseRanks();
+
+        return ranks;
+    }
+
+    constexpr std::array<std::uint32_t, 32> halton_primes = {2,  3,  5,  7,  11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53,
+                                                             59, 61, 67, 71, 73, 79, 83, 89, 97, 101, 103, 107, 109, 113, 127, 131};
+
+    // Element of a random permutation of the integers in range [0, length) chosen by a seed, using the hash-based permutation of Kensler
+    std::uint32_t getPermutationElement(std::uint32_t index, std::uint32_t length, std::uint32_t seed) noexcept {
+        std::uint32_t mask = length - 1;
+        mask |= mask >> 1;
+        mask |= mask >> 2;
+        mask |= mask >> 4;
+        mask |= mask >> 8;
+        mask |= mask >> 16;
+
+        // Permute within the next power of two, and repeat until the element falls into the range
+        do {
+            index ^= seed;
+            index *= 0xE170893DU;
+            index ^= seed >> 16;
+            index ^= (index & mask) >> 4;
+            index ^= seed >> 8;
+            index *= 0x0929EB3FU;
+            index ^= seed >> 23;
+            index ^= (index & mask) >> 1;
+            index *= 1 | seed >> 27;
+            index *= 0x6935FA69U;
+            index ^= (index & mask) >> 11;
+            index *= 0x74DCB303U;
+            index ^= (index & mask) >> 2;
+            index *= 0x9E501CC3U;
+            index ^= (index & mask) >> 2;
+            index *= 0xC860A3DFU;
+            index &= mask;
+            index ^= index >> 5;
+        } while(index >= length);
+
+        return (index + seed) % length;
+    }
+
+    // Radical inverse of an index in a prime base with Owen scrambling, where each digit is permuted depending on all digits before it
+    // Zero digits beyond the highest digit of the index are permuted as well, since other indices share their preceding digits,
+    //  which keeps the first 65536 indices stratified
+    double getScrambledRadicalInverse(std::uint32_t index, std::uint32_t base, std::uint32_t seed) noexcept {
+        constexpr double min_factor = 1.0 / 65536.0;
+
+        double inverse_base = 1.0 / base;
+        double factor = inverse_base;
+        double result = 0.0;
+        std::uint32_t prefix_hash = seed;
+
+        while(index != 0 || factor > min_factor) {
+            auto digit = index % base;
+            index /= base;
+
+            auto scrambled_digit = getPermutationElement(digit, base, prefix_hash);
+            result += static_cast<double>(scrambled_digit) * factor;
+
+            prefix_hash = hashCombine(prefix_hash, digit);
+            factor *= inverse_base;
+        }
+
+        // All digits beyond are permuted into independent random digits, which form a uniform random number
+        return result + factor * static_cast<double>(mixBits(prefix_hash)) / 4294967296.0;
+    }
+}
+
+Sampler::Sampler(std::uint64_t seed) noexcept : seed(seed) {}
+
+void Sampler::startSample(int x, int y, int sample_index) noexcept {
+    this->pixel_seed = deriveSeed(deriveSeed(this->seed, static_cast<std::uint32_t>(x)), static_cast<std::uint32_t>(y));
+    this->x = static_cast<std::uint32_t>(x);
+    this->y = static_cast<std::uint32_t>(y);
+    this->sample_index = static_cast<std::uint32_t>(sample_index);
+    this->dimension = 0;
+    this->independent_seed = deriveSeed(this->pixel_seed, ~std::uint64_t{0});
+    this->independent_index = 0;
+}
+
+uint32_t Sampler::getDimension() const noexcept {
+    return this->dimension;
+}
+
+void Sampler::setDimension(uint32_t dimension) noexcept {
+    this->dimension = dimension;
+}
+
+uint32_t Sampler::nextIndependent() noexcept {
+    std::uint64_t counter = (static_cast<std::uint64_t>(this->sample_index) << 32) | this->independent_index++;
+
+    return static_cast<std::uint32_t>(deriveSeed(this->independent_seed, counter) >> 32);
+}
+
+uint32_t IndependentSampler::next() noexcept {
+    std::uint64_t counter = (static_cast<std::uint64_t>(this->sample_index) << 32) | this->dimension++;
+
+    return static_cast<std::uint32_t>(deriveSeed(this->pixel_seed, counter) >> 32);
+}
+
+uint32_t SobolSampler::next() noexcept {
+    std::uint32_t pair = this->dimension / 2;
+    std::uint32_t component = this->dimension % 2;
+    this->dimension++;
+
+    return impl::getSobolSample(this->sample_index, component, impl::hashCombine(static_cast<std::uint32_t>(this->pixel_seed), pair));
+}
+
+uint32_t BlueNoiseSampler::next() noexcept {
+    constexpr int mask_bits = 2 * impl::blue_noise_size_log2;
+    constexpr std::uint32_t coordinate_mask = impl::blue_noise_size - 1;
+
+    std::uint32_t dimension = this->dimension++;
+    std::uint32_t pair = dimension / 2;
+    std::uint32_t component = dimension % 2;
+
+    if(dimension >= impl::blue_noise_dimension_count) {
+        return impl::getSobolSample(this->sample_index, component, impl::hashCombine(static_cast<std::uint32_t>(this->pixel_seed), pair));
+    }
+
+    // All pixels share the same points, which are shifted by the mask at an offset that the seed chooses for each dimension
+    // The points are moved such that the first one is at 0, so that the first sample of every pixel is the mask itself rather than
+    //  a shifted copy of it, which would wrap around in some pixels and break up the blue noise
+    auto pair_seed = static_cast<std::uint32_t>(deriveSeed(this->seed, pair));
+    std::uint32_t value = impl::getSobolSample(this->sample_index, component, pair_seed) - impl::getSobolSample(0, component, pair_seed);
+
+    auto offset = static_cast<std::uint32_t>(deriveSeed(this->seed, impl::blue_noise_dimension_count + dimension));
+    auto mask_x = (this->x + offset) & coordinate_mask;
+    auto mask_y = (this->y + (offset >> 16)) & coordinate_mask;
+    std::uint32_t rank = impl::getBlueNoiseRanks()[mask_y * impl::blue_noise_size + mask_x];
+
+    // The shift is uniformly distributed within the interval of its rank, and the addition wraps around like a toroidal shift
+    std::uint32_t shift = (rank << (32 - mask_bits)) | (impl::hashCombine(static_cast<std::uint32_t>(this->pixel_seed), dimension) >> mask_bits);
+
+    return value + shift;
+}
+
+uint32_t HaltonSampler::next() noexcept {
+    std::uint32_t dimension = this->dimension++;
+    std::uint32_t dimension_seed = impl::hashCombine(static_cast<std::uint32_t>(this->pixel_seed), dimension);
+
+    if(dimension >= impl::halton_primes.size()) {
+        return impl::hashCombine(dimension_seed, this->sample_index);
+    }
+
+    constexpr double scale = 4294967296.0;
+
+    double value = impl::getScrambledRadicalInverse(this->sample_index, impl::halton_primes[dimension], dimension_seed);
+
+    return static_cast<std::uint32_t>(std::min(value * scale, scale - 1.0));
+}
+
+std::unique_ptr<Sampler> createSampler(SamplerType type, std::uint64_t seed) {
+    switch(type) {
+        case SamplerType::Sobol:
+            return std::make_unique<SobolSampler>(seed);
+        case SamplerType::Halton:
+            return std::make_unique<HaltonSampler>(seed);
+        case SamplerType::BlueNoise:
+            return std::make_unique<BlueNoiseSampler>(seed);
+        case SamplerType::Independent:
+            break;
+    }
+
+    return std::make_unique<IndependentSampler>(seed);
+}
+
+std::uint64_t deriveSeed(std::uint64_t seed, std::uint64_t counter) noexcept {
+    return impl::mixBits64(seed ^ impl::mixBits64(counter + 0x9E3779B97F4A7C15ULL));
+}
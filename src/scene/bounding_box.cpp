@@ -12,8 +12,11 @@ namespace impl {
 
 AABB::AABB() : child(std::make_unique<NullObject>()), leaf(true) {}
 
+AABB::~AABB() = default;
+
 AABB::AABB(AABB &&other) noexcept :
-  area(other.area), left(std::move(other.left)), right(std::move(other.right)), child(std::move(other.child)), leaf(other.leaf) {}
+  area(other.area), left(std::move(other.left)), right(std::move(other.right)), child(std::move(other.child)), deferred(std::move(other.deferred)),
+  leaf(other.leaf) {}
 
 AABB::AABB(AABB &&left, AABB &&right) {
     this->area = impl::combineAreas(left.area, right.area);
@@ -25,11 +28,27 @@ AABB::AABB(AABB &&left, AABB &&right) {
 
 AABB::AABB(AABBArea area, std::unique_ptr<Object> &&child) noexcept : area(area), child(std::move(child)), leaf(true) {}
 
+AABB::AABB(std::vector<AABB> &&bounding_boxes, int eager_depth) {
+    assert(bounding_boxes.size() >= 2);
+
+    this->area = bounding_boxes[0].area;
+    for(const AABB &aabb : bounding_boxes) {
+        this->area = impl::combineAreas(this->area, aabb.area);
+    }
+
+    this->deferred = std::make_unique<DeferredAABBChildren>();
+    this->deferred->bounding_boxes = std::move(bounding_boxes);
+    this->deferred->eager_depth = eager_depth;
+
+    this->leaf = false;
+}
+
 AABB &AABB::operator=(AABB &&other) noexcept {
     this->area = other.area;
     this->left = std::move(other.left);
     this->right = std::move(other.right);
     this->child = std::move(other.child);
+    this->deferred = std::move(other.deferred);
     this->leaf = other.leaf;
 
     return *this;
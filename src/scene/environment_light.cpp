@@ -0,0 +1,133 @@
+#include <PathTrace/scene/environment_light.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace impl {
+    constexpr float pi = static_cast<float>(M_PI);
+
+    // Maps a direction to coordinates in the unit square of the latitude-longitude layout
+    std::tuple<float, float> getEnvironmentCoordinates(vec3<float> dir) {
+        float phi = std::atan2(dir[2], dir[0]);
+        if(phi < 0.0F) {
+            phi += 2.0F * pi;
+        }
+        float theta = std::acos(std::clamp(dir[1], -1.0F, 1.0F));
+
+        return std::make_tuple(phi / (2.0F * pi), theta / pi);
+    }
+
+    // Maps coordinates in the unit square of the latitude-longitude layout to a direction, also returning the sine of the polar angle
+    std::tuple<vec3<float>, float> getEnvironmentDirection(float u, float v) {
+        float phi = u * 2.0F * pi;
+        float theta = v * pi;
+        float sin_theta = std::sin(theta);
+
+        return std::make_tuple(vec3<float>{sin_theta * std::cos(phi), std::cos(theta), sin_theta * std::sin(phi)}, sin_theta);
+    }
+
+    float getRadiance(Color<float> color) {
+        return (color[0] + color[1] + color[2]) * color[3];
+    }
+}
+
+EnvironmentLight::EnvironmentLight(Image<> image, float scale) : image(std::move(image)), scale(scale) {
+    int width = this->image.getWidth();
+    int height = this->image.getHeight();
+    if(width <= 0 || height <= 0) {
+        return;
+    }
+
+    // Weight each pixel by the solid angle it covers, which shrinks towards the poles
+    std::vector<float> weights(static_cast<std::size_t>(width) * height);
+    for(int y = 0; y < height; y++) {
+        float sin_theta = std::sin((static_cast<float>(y) + 0.5F) / static_cast<float>(height) * impl::pi);
+
+        for(int x = 0; x < width; x++) {
+            weights[y * width + x] = std::max(impl::getRadiance(this->image(x, y)), 0.0F) * sin_theta;
+        }
+    }
+
+    this->distribution = Distribution2D(weights, width, height);
+}
+
+std::tuple<vec3<float>, float> EnvironmentLight::importanceSample(vec3<float> pos, RandomEngine &re) const noexcept {
+    if(this->distribution.empty()) {
+        return std::make_tuple(pos, 0.0F);
+    }
+
+    auto [r1, r2] = re.getFloats<2>();
+    auto [u, v, uv_pd] = this->distribution.sample(r1, r2);
+    auto [dir, sin_theta] = impl::getEnvironmentDirection(u, v);
+
+    // Convert the density from the unit square to solid angle, which covers 2 * pi * pi times the area scaled by the sine of the polar angle
+    float pd = sin_theta > 0.0F ? uv_pd / (2.0F * impl::pi * impl::pi * sin_theta) : 0.0F;
+
+    // Place the sampled point outside of the scene, so that any geometry in between occludes it
+    float distance = (pos - this->scene_center).getLength() + 2.0F * this->scene_radius;
+
+    return std::make_tuple(pos + dir * distance, pd);
+}
+
+Spectrum EnvironmentLight::getSpectrum(Ray ray) const noexcept {
+    int width = this->image.getWidth();
+    int height = this->image.getHeight();
+    if(width <= 0 || height <= 0) {
+        return {};
+    }
+
+    auto [u, v] = impl::getEnvironmentCoordinates(ray.dir);
+
+    int x = std::clamp(static_cast<int>(u * static_cast<float>(width)), 0, width - 1);
+    int y = std::clamp(static_cast<int>(v * static_cast<float>(height)), 0, height - 1);
+
+    auto color = this->image(x, y);
+
+    return {Color<float>{color[0] * this->scale, color[1] * this->scale, color[2] * this->scale, color[3]}};
+}
+
+float EnvironmentLight::getPower() const noexcept {
+    int width = this->image.getWidth();
+    int height = this->image.getHeight();
+
+    // Integrate the radiance over all directions, as received by a disk covering the scene
+    double radiance = 0.0;
+    for(int y = 0; y < height; y++) {
+        float sin_theta = std::sin((static_cast<float>(y) + 0.5F) / static_cast<float>(height) * impl::pi);
+
+        for(int x = 0; x < width; x++) {
+            radiance += std::max(impl::getRadiance(this->image(x, y)), 0.0F) * sin_theta;
+        }
+    }
+
+    if(width > 0 && height > 0) {
+        radiance *= 2.0 * M_PI * M_PI / (static_cast<double>(width) * height);
+    }
+
+    return static_cast<float>(M_PI * this->scene_radius * this->scene_radius * radiance * this->scale);
+}
+
+bool EnvironmentLight::isInfinite() const noexcept {
+    return true;
+}
+
+float EnvironmentLight::getPdf(vec3<float> /*pos*/, vec3<float> dir) const noexcept {
+    if(this->distribution.empty()) {
+        return 0.0F;
+    }
+
+    auto [u, v] = impl::getEnvironmentCoordinates(dir);
+
+    float sin_theta = std::sqrt(std::max(1.0F - dir[1] * dir[1], 0.0F));
+    if(!(sin_theta > 0.0F)) {
+        return 0.0F;
+    }
+
+    return this->distribution.getPdf(u, v) / (2.0F * impl::pi * impl::pi * sin_theta);
+}
+
+void EnvironmentLight::setSceneBounds(vec3<float> center, float radius) noexcept {
+    this->scene_center = center;
+    this->scene_radius = radius;
+}
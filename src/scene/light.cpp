@@ -30,12 +30,31 @@ Spectrum Spectrum::operator/(float divisor) const noexcept {
     return {divided_color};
 }
 
+bool LightSource::isInfinite() const noexcept {
+    return false;
+}
+
+float LightSource::getPdf(vec3<float> /*pos*/, vec3<float> /*dir*/) const noexcept {
+    return 0.0F;
+}
+
+void LightSource::setSceneBounds(vec3<float> /*center*/, float /*radius*/) noexcept {}
+
 PointLightSource::PointLightSource(vec3<float> pos, Spectrum spectrum) noexcept : pos(pos), spectrum(spectrum) {}
 
-std::tuple<vec3<float>, float> PointLightSource::importanceSample(vec3<float> /*pos*/) const noexcept {
+std::tuple<vec3<float>, float> PointLightSource::importanceSample(vec3<float> /*pos*/, RandomEngine & /*re*/) const noexcept {
     return std::make_tuple(this->pos, 1.0F);
 }
 
 Spectrum PointLightSource::getSpectrum(Ray /*ray*/) const noexcept {
     return this->spectrum;
 }
+
+float PointLightSource::getPower() const noexcept {
+    constexpr float pi = static_cast<float>(M_PI);
+
+    auto color = this->spectrum.getColor();
+
+    // Point lights emit their spectrum uniformly in all directions
+    return 4.0F * pi * (color[0] + color[1] + color[2]) * color[3];
+}
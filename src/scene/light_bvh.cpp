@@ -0,0 +1,399 @@
+#include <PathTrace/scene/light_bvh.h>
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+namespace impl {
+
+    constexpr float pi = static_cast<float>(M_PI);
+
+    // Cosine of the difference of two angles given by their sines and cosines, clamped to angle differences >= 0
+    float cosSubClamped(float sin_a, float cos_a, float sin_b, float cos_b) {
+        if(cos_a > cos_b) {
+            return 1.0F;
+        }
+
+        return cos_a * cos_b + sin_a * sin_b;
+    }
+
+    // Sine of the difference of two angles given by their sines and cosines, clamped to angle differences >= 0
+    float sinSubClamped(float sin_a, float cos_a, float sin_b, float cos_b) {
+        if(cos_a > cos_b) {
+            return 0.0F;
+        }
+
+        return sin_a * cos_b - cos_a * sin_b;
+    }
+
+    float sinFromCos(float cos_theta) {
+        return std::sqrt(std::max(1.0F - cos_theta * cos_theta, 0.0F));
+    }
+
+    // Rotates a vector around a normalized axis by the given angle
+    vec3<float> rotate(vec3<float> v, vec3<float> axis, float theta) {
+        auto cos_theta = std::cos(theta);
+        auto sin_theta = std::sin(theta);
+
+        return v * cos_theta + cross(axis, v) * sin_theta + axis * (dot(axis, v) * (1.0F - cos_theta));
+    }
+
+    // Computes the smallest cone containing both given cones of directions
+    std::tuple<vec3<float>, float> combineCones(vec3<float> axis_a, float cos_a, vec3<float> axis_b, float cos_b) {
+        auto theta_a = std::acos(std::clamp(cos_a, -1.0F, 1.0F));
+        auto theta_b = std::acos(std::clamp(cos_b, -1.0F, 1.0F));
+        auto theta_d = std::acos(std::clamp(dot(axis_a, axis_b), -1.0F, 1.0F));
+
+        if(std::min(theta_d + theta_b, pi) <= theta_a) {
+            return std::make_tuple(axis_a, cos_a);
+        }
+        if(std::min(theta_d + theta_a, pi) <= theta_b) {
+            return std::make_tuple(axis_b, cos_b);
+        }
+
+        auto theta_o = (theta_a + theta_d + theta_b) / 2.0F;
+        if(theta_o >= pi) {
+            return std::make_tuple(axis_a, -1.0F);
+        }
+
+        auto rotation_axis = cross(axis_a, axis_b);
+        if(!(rotation_axis.getLengthSquared() > 0.0F)) {
+            return std::make_tuple(axis_a, -1.0F);
+        }
+
+        vec3<float> axis = rotate(axis_a, rotation_axis.normalize(), theta_o - theta_a).normalize();
+
+        return std::make_tuple(axis, std::cos(theta_o));
+    }
+
+    LightBounds combineLightBounds(const LightBounds &a, const LightBounds &b) {
+        if(!(a.power > 0.0F)) {
+            return b;
+        }
+        if(!(b.power > 0.0F)) {
+            return a;
+        }
+
+        auto [axis, cos_theta_o] = combineCones(a.axis, a.cos_theta_o, b.axis, b.cos_theta_o);
+
+        return {{min(a.bounds.low, b.bounds.low), max(a.bounds.high, b.bounds.high)},
+                axis,
+                cos_theta_o,
+                std::min(a.cos_theta_e, b.cos_theta_e),
+                a.power + b.power,
+                a.two_sided || b.two_sided};
+    }
+
+    float getSurfaceArea(const AABBArea &area) {
+        auto d = area.high - area.low;
+
+        return 2.0F * (d[0] * d[1] + d[1] * d[2] + d[0] * d[2]);
+    }
+
+    // Measure of the solid angle of directions that the emitters bounded by the cone can emit light in
+    float getOrientationMeasure(float cos_theta_o, float cos_theta_e) {
+        auto theta_o = std::acos(std::clamp(cos_theta_o, -1.0F, 1.0F));
+        auto theta_e = std::acos(std::clamp(cos_theta_e, -1.0F, 1.0F));
+        auto theta_w = std::min(theta_o + theta_e, pi);
+        auto sin_theta_o = std::sin(theta_o);
+
+        return 2.0F * pi * (1.0F - cos_theta_o) +
+               pi / 2.0F * (2.0F * theta_w * sin_theta_o - std::cos(theta_o - 2.0F * theta_w) - 2.0F * theta_o * sin_theta_o + cos_theta_o);
+    }
+
+    // Surface area orientation heuristic cost of a set of emitters
+    float getSplitCost(const LightBounds &light_bounds, float regularization) {
+        return light_bounds.power * getOrientationMeasure(light_bounds.cos_theta_o, light_bounds.cos_theta_e) *
+               std::max(getSurfaceArea(light_bounds.bounds), std::numeric_limits<float>::min()) * regularization;
+    }
+
+}
+
+float LightBounds::getImportance(vec3<float> pos, vec3<float> n) const noexcept {
+    using namespace impl;
+
+    auto center = (this->bounds.low + this->bounds.high) * 0.5F;
+    auto radius2 = (this->bounds.high - center).getLengthSquared();
+
+    auto to_pos = pos - center;
+    auto dist2 = std::max(to_pos.getLengthSquared(), (this->bounds.high - this->bounds.low).getLength() / 2.0F);
+    if(!(to_pos.getLengthSquared() > 0.0F)) {
+        to_pos = this->axis;
+    }
+    auto wi = to_pos.normalize();
+
+    // Angle between the cone axis and the direction towards the receiving point
+    auto cos_theta_w = dot(this->axis, wi);
+    if(this->two_sided) {
+        cos_theta_w = std::abs(cos_theta_w);
+    }
+    auto sin_theta_w = sinFromCos(cos_theta_w);
+
+    // Half angle of the cone of directions from the receiving point subtended by the bounds
+    auto cos_theta_b = -1.0F;
+    if(to_pos.getLengthSquared() > radius2) {
+        cos_theta_b = std::sqrt(std::max(1.0F - radius2 / to_pos.getLengthSquared(), 0.0F));
+    }
+    auto sin_theta_b = sinFromCos(cos_theta_b);
+
+    // Compute the minimum angle between any emitter normal and any direction towards the receiving point
+    auto sin_theta_o = sinFromCos(this->cos_theta_o);
+    auto cos_theta_x = cosSubClamped(sin_theta_w, cos_theta_w, sin_theta_o, this->cos_theta_o);
+    auto sin_theta_x = sinSubClamped(sin_theta_w, cos_theta_w, sin_theta_o, this->cos_theta_o);
+    auto cos_theta_p = cosSubClamped(sin_theta_x, cos_theta_x, sin_theta_b, cos_theta_b);
+
+    if(cos_theta_p <= this->cos_theta_e) {
+        return 0.0F;
+    }
+
+    auto importance = this->power * cos_theta_p / dist2;
+
+    // Account for the orientation of the receiving surface
+    if(n.getLengthSquared() > 0.0F) {
+        auto cos_theta_i = std::abs(dot(wi, n));
+        auto sin_theta_i = sinFromCos(cos_theta_i);
+        importance *= cosSubClamped(sin_theta_i, cos_theta_i, sin_theta_b, cos_theta_b);
+    }
+
+    return std::max(importance, 0.0F);
+}
+
+LightBVH::LightBVH(const std::vector<const Object *> &emitters, const std::vector<float> &powers) {
+    assert(emitters.size() == powers.size());
+
+    std::vector<std::tuple<LightBounds, int>> emitter_bounds;
+    emitter_bounds.reserve(emitters.size());
+
+    for(int i = 0; i < static_cast<int>(emitters.size()); i++) {
+        const Object *object = emitters[i];
+
+        auto [axis, cos_theta_o, two_sided] = object->getNormalBounds();
+
+        // Emissive surfaces are assumed to emit light across their entire hemisphere
+        LightBounds light_bounds = {object->getBoundingVolume(), axis, cos_theta_o, 0.0F, powers[i], two_sided};
+        if(!(light_bounds.power > 0.0F)) {
+            continue;
+        }
+
+        emitter_bounds.emplace_back(light_bounds, i);
+    }
+
+    this->emitter_trails.resize(emitters.size());
+
+    if(!emitter_bounds.empty()) {
+        this->nodes.reserve(2 * emitter_bounds.size() - 1);
+        this->build(emitter_bounds, 0, static_cast<int>(emitter_bounds.size()), 0, 0);
+    }
+}
+
+int LightBVH::build(std::vector<std::tuple<LightBounds, int>> &emitters, int begin, int end, std::uint64_t trail, int depth) {
+    using namespace impl;
+
+    assert(end > begin);
+
+    int node_index = static_cast<int>(this->nodes.size());
+
+    if(end - begin == 1) {
+        auto [light_bounds, emitter_index] = emitters[begin];
+
+        this->nodes.push_back({light_bounds, emitter_index, true});
+        this->emitter_trails[emitter_index] = trail;
+
+        return node_index;
+    }
+
+    LightBounds combined = std::get<0>(emitters[begin]);
+    AABBArea centroid_bounds = {combined.bounds.low, combined.bounds.low};
+    for(int i = begin; i < end; i++) {
+        const auto &light_bounds = std::get<0>(emitters[i]);
+        if(i > begin) {
+            combined = combineLightBounds(combined, light_bounds);
+        }
+
+        auto centroid = (light_bounds.bounds.low + light_bounds.bounds.high) * 0.5F;
+        if(i == begin) {
+            centroid_bounds = {centroid, centroid};
+        }
+        centroid_bounds = {min(centroid_bounds.low, centroid), max(centroid_bounds.high, centroid)};
+    }
+
+    auto get_centroid = [](const std::tuple<LightBounds, int> &emitter, int dim) {
+        const auto &bounds = std::get<0>(emitter).bounds;
+        return (bounds.low[dim] + bounds.high[dim]) * 0.5F;
+    };
+
+    // Choose a split by evaluating the surface area orientation heuristic for a set of buckets in every dimension
+    constexpr int bucket_count = 12;
+    constexpr int max_heuristic_depth = 32;
+
+    int split_dim = -1;
+    int split_bucket = -1;
+    float split_cost = std::numeric_limits<float>::infinity();
+
+    auto centroid_extent = centroid_bounds.high - centroid_bounds.low;
+    auto max_extent = std::max({centroid_extent[0], centroid_extent[1], centroid_extent[2]});
+
+    if(depth < max_heuristic_depth) {
+        for(int dim = 0; dim < 3; dim++) {
+            if(!(centroid_extent[dim] > 0.0F)) {
+                continue;
+            }
+
+            std::array<LightBounds, bucket_count> buckets{};
+            for(int i = begin; i < end; i++) {
+                auto relative = (get_centroid(emitters[i], dim) - centroid_bounds.low[dim]) / centroid_extent[dim];
+                auto bucket = std::min(static_cast<int>(relative * bucket_count), bucket_count - 1);
+
+                buckets[bucket] = combineLightBounds(buckets[bucket], std::get<0>(emitters[i]));
+            }
+
+            // Penalize thin splits along the shorter dimensions
+            auto regularization = max_extent / centroid_extent[dim];
+
+            for(int bucket = 0; bucket < bucket_count - 1; bucket++) {
+                LightBounds below{};
+                LightBounds above{};
+                for(int i = 0; i <= bucket; i++) {
+                    below = combineLightBounds(below, buckets[i]);
+                }
+                for(int i = bucket + 1; i < bucket_count; i++) {
+                    above = combineLightBounds(above, buckets[i]);
+                }
+
+                if(!(below.power > 0.0F) || !(above.power > 0.0F)) {
+                    continue;
+                }
+
+                auto cost = getSplitCost(below, regularization) + getSplitCost(above, regularization);
+                if(cost < split_cost) {
+                    split_cost = cost;
+                    split_dim = dim;
+                    split_bucket = bucket;
+                }
+            }
+        }
+    }
+
+    int middle = -1;
+    if(split_dim >= 0) {
+        auto split_it = std::partition(emitters.begin() + begin, emitters.begin() + end, [&](const std::tuple<LightBounds, int> &emitter) {
+            auto relative = (get_centroid(emitter, split_dim) - centroid_bounds.low[split_dim]) / centroid_extent[split_dim];
+            return std::min(static_cast<int>(relative * bucket_count), bucket_count - 1) <= split_bucket;
+        });
+
+        middle = static_cast<int>(split_it - emitters.begin());
+    }
+
+    // Fall back to a median split along the largest dimension, which also bounds the depth of the hierarchy
+    if(middle <= begin || middle >= end) {
+        int dim = 0;
+        for(int i = 1; i < 3; i++) {
+            if(centroid_extent[i] > centroid_extent[dim]) {
+                dim = i;
+            }
+        }
+
+        middle = (begin + end) / 2;
+        std::nth_element(emitters.begin() + begin, emitters.begin() + middle, emitters.begin() + end,
+                         [&](const std::tuple<LightBounds, int> &a, const std::tuple<LightBounds, int> &b) { return get_centroid(a, dim) < get_centroid(b, dim); });
+    }
+
+    this->nodes.push_back({combined, -1, false});
+
+    assert(depth < 63);
+    this->build(emitters, begin, middle, trail, depth + 1);
+    int second_child = this->build(emitters, middle, end, trail | (static_cast<std::uint64_t>(1) << static_cast<unsigned>(depth)), depth + 1);
+
+    this->nodes[node_index].index = second_child;
+
+    return node_index;
+}
+
+bool LightBVH::empty() const noexcept {
+    return this->nodes.empty();
+}
+
+std::tuple<int, float> LightBVH::sample(vec3<float> pos, vec3<float> n, float u) const noexcept {
+    if(this->nodes.empty()) {
+        return std::make_tuple(-1, 0.0F);
+    }
+
+    int node_index = 0;
+    float probability = 1.0F;
+
+    if(!(this->nodes[0].light_bounds.getImportance(pos, n) > 0.0F)) {
+        return std::make_tuple(-1, 0.0F);
+    }
+
+    for(;;) {
+        const Node &node = this->nodes[node_index];
+
+        if(node.leaf) {
+            return std::make_tuple(node.index, probability);
+        }
+
+        auto first_importance = this->nodes[node_index + 1].light_bounds.getImportance(pos, n);
+        auto second_importance = this->nodes[node.index].light_bounds.getImportance(pos, n);
+
+        auto total_importance = first_importance + second_importance;
+        if(!(total_importance > 0.0F)) {
+            return std::make_tuple(-1, 0.0F);
+        }
+
+        auto first_probability = first_importance / total_importance;
+
+        // Reuse the uniform value for the following decisions by remapping it to [0, 1)
+        if(u < first_probability) {
+            node_index = node_index + 1;
+            probability *= first_probability;
+            u = std::min(u / first_probability, std::nextafter(1.0F, 0.0F));
+        }
+        else {
+            node_index = node.index;
+            probability *= 1.0F - first_probability;
+            u = std::min((u - first_probability) / (1.0F - first_probability), std::nextafter(1.0F, 0.0F));
+        }
+    }
+}
+
+float LightBVH::getProbability(vec3<float> pos, vec3<float> n, int emitter_index) const noexcept {
+    if(this->nodes.empty()) {
+        return 0.0F;
+    }
+
+    assert(emitter_index >= 0 && emitter_index < static_cast<int>(this->emitter_trails.size()));
+    auto trail = this->emitter_trails[emitter_index];
+
+    if(!(this->nodes[0].light_bounds.getImportance(pos, n) > 0.0F)) {
+        return 0.0F;
+    }
+
+    int node_index = 0;
+    float probability = 1.0F;
+    for(int depth = 0;; depth++) {
+        const Node &node = this->nodes[node_index];
+
+        if(node.leaf) {
+            return node.index == emitter_index ? probability : 0.0F;
+        }
+
+        auto first_importance = this->nodes[node_index + 1].light_bounds.getImportance(pos, n);
+        auto second_importance = this->nodes[node.index].light_bounds.getImportance(pos, n);
+
+        auto total_importance = first_importance + second_importance;
+        if(!(total_importance > 0.0F)) {
+            return 0.0F;
+        }
+
+        if(((trail >> static_cast<unsigned>(depth)) & 1U) == 0) {
+            node_index = node_index + 1;
+            probability *= first_importance / total_importance;
+        }
+        else {
+            node_index = node.index;
+            probability *= second_importance / total_importance;
+        }
+    }
+}
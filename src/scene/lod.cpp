@@ -0,0 +1,549 @@
+#include <PathTrace/scene/lod.h>
+#include <PathTrace/scene/bounding_box.h>
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <queue>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+namespace impl {
+
+    /**
+     * Symmetric 4x4 matrix measuring the sum of squared distances of a point to a set of planes
+     */
+    struct Quadric {
+        // Upper triangle of the matrix in row-major order
+        std::array<double, 10> q{};
+
+        static Quadric fromPlane(vec3<double> n, double d, double weight) {
+            Quadric quadric;
+            quadric.q = {n[0] * n[0], n[0] * n[1], n[0] * n[2], n[0] * d, n[1] * n[1], n[1] * n[2], n[1] * d, n[2] * n[2], n[2] * d, d * d};
+
+            for(auto &value : quadric.q) {
+                value *= weight;
+            }
+
+            return quadric;
+        }
+
+        Quadric &operator+=(const Quadric &other) {
+            for(int i = 0; i < 10; i++) {
+                q[i] += other.q[i];
+            }
+
+            return *this;
+        }
+
+        Quadric operator+(const Quadric &other) const {
+            Quadric sum = *this;
+            sum += other;
+
+            return sum;
+        }
+
+        double evaluate(vec3<double> p) const {
+            auto x = p[0];
+            auto y = p[1];
+            auto z = p[2];
+
+            return q[0] * x * x + 2 * q[1] * x * y + 2 * q[2] * x * z + 2 * q[3] * x + q[4] * y * y + 2 * q[5] * y * z + 2 * q[6] * y + q[7] * z * z +
+                   2 * q[8] * z + q[9];
+        }
+
+        // Finds the point minimizing the error, returns false if the minimum is not unique
+        bool minimize(vec3<double> &p) const {
+            auto a = q[0];
+            auto b = q[1];
+            auto c = q[2];
+            auto e = q[4];
+            auto f = q[5];
+            auto h = q[7];
+
+            auto det = a * (e * h - f * f) - b * (b * h - f * c) + c * (b * f - e * c);
+            if(std::abs(det) < 1E-12) {
+                return false;
+            }
+
+            // Solve the linear system using Cramer's rule
+            auto rx = -q[3];
+            auto ry = -q[6];
+            auto rz = -q[8];
+
+            auto x = (rx * (e * h - f * f) - b * (ry * h - f * rz) + c * (ry * f - e * rz)) / det;
+            auto y = (a * (ry * h - rz * f) - rx * (b * h - f * c) + c * (b * rz - ry * c)) / det;
+            auto z = (a * (e * rz - f * ry) - b * (b * rz - ry * c) + rx * (b * f - e * c)) / det;
+
+            p = {x, y, z};
+
+            return std::isfinite(x) && std::isfinite(y) && std::isfinite(z);
+        }
+    };
+
+    struct PositionHash {
+        std::size_t operator()(const std::array<std::uint32_t, 3> &key) const noexcept {
+            std::uint64_t hash = 0xCBF29CE484222325LLU;
+            for(auto value : key) {
+                hash ^= value;
+                hash *= 0x100000001B3LLU;
+            }
+
+            return static_cast<std::size_t>(hash);
+        }
+    };
+
+    struct EdgeCollapse {
+        double cost;
+        int v0;
+        int v1;
+        int stamp0;
+        int stamp1;
+
+        bool operator>(const EdgeCollapse &other) const noexcept { return cost > other.cost; }
+    };
+
+    vec3<double> toDouble(vec3<float> v) {
+        return {static_cast<double>(v[0]), static_cast<double>(v[1]), static_cast<double>(v[2])};
+    }
+
+    vec3<float> toFloat(vec3<double> v) {
+        return {static_cast<float>(v[0]), static_cast<float>(v[1]), static_cast<float>(v[2])};
+    }
+
+    class MeshSimplifier final {
+      private:
+        std::vector<vec3<double>> positions;
+        std::vector<Quadric> quadrics;
+        std::vector<int> stamps;
+        std::vector<bool> removed;
+
+        std::vector<std::array<int, 3>> faces;
+        std::vector<bool> face_alive;
+        std::vector<std::vector<int>> vertex_faces;
+        int alive_face_count = 0;
+
+        std::priority_queue<EdgeCollapse, std::vector<EdgeCollapse>, std::greater<>> collapses;
+
+        int addVertex(vec3<float> position, std::unordered_map<std::array<std::uint32_t, 3>, int, PositionHash> &indices) {
+            std::array<std::uint32_t, 3> key{};
+            std::memcpy(key.data(), position.data(), sizeof(key));
+
+            auto [it, inserted] = indices.try_emplace(key, static_cast<int>(positions.size()));
+            if(inserted) {
+                positions.push_back(toDouble(position));
+            }
+
+            return it->second;
+        }
+
+        vec3<double> getFaceNormal(const std::array<int, 3> &face) const {
+            return cross(positions[face[1]] - positions[face[0]], positions[face[2]] - positions[face[0]]);
+        }
+
+        std::tuple<double, vec3<double>> getCollapse(int v0, int v1) const {
+            auto quadric = quadrics[v0] + quadrics[v1];
+
+            vec3<double> position;
+            if(quadric.minimize(position)) {
+                return std::make_tuple(quadric.evaluate(position), position);
+            }
+
+            // Fall back to the best of the endpoints and the midpoint
+            std::array<vec3<double>, 3> candidates = {positions[v0], positions[v1], (positions[v0] + positions[v1]) * 0.5};
+
+            position = candidates[0];
+            double cost = quadric.evaluate(position);
+            for(int i = 1; i < static_cast<int>(candidates.size()); i++) {
+                auto candidate_cost = quadric.evaluate(candidates[i]);
+                if(candidate_cost < cost) {
+                    cost = candidate_cost;
+                    position = candidates[i];
+                }
+            }
+
+            return std::make_tuple(cost, position);
+        }
+
+        void pushCollapse(int v0, int v1) {
+            auto cost = std::get<0>(getCollapse(v0, v1));
+            collapses.push({cost, v0, v1, stamps[v0], stamps[v1]});
+        }
+
+        // Checks whether moving a vertex would flip the orientation of any of its faces not shared with the other vertex
+        bool flipsFaces(int vertex, int other, vec3<double> position) const {
+            for(int face_index : vertex_faces[vertex]) {
+                if(!face_alive[face_index]) {
+                    continue;
+                }
+
+                const auto &face = faces[face_index];
+                if(face[0] == other || face[1] == other || face[2] == other) {
+                    continue;
+                }
+
+                auto moved_face = face;
+                auto old_normal = getFaceNormal(face);
+
+                std::array<vec3<double>, 3> corners = {positions[moved_face[0]], positions[moved_face[1]], positions[moved_face[2]]};
+                for(int i = 0; i < 3; i++) {
+                    if(moved_face[i] == vertex) {
+                        corners[i] = position;
+                    }
+                }
+                auto new_normal = cross(corners[1] - corners[0], corners[2] - corners[0]);
+
+                auto length_product = std::sqrt(old_normal.getLengthSquared() * new_normal.getLengthSquared());
+                if(!(length_product > 0.0) || dot(old_normal, new_normal) < 0.2 * length_product) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        void collapse(int v0, int v1, vec3<double> position) {
+            positions[v0] = position;
+            quadrics[v0] += quadrics[v1];
+            removed[v1] = true;
+            stamps[v0]++;
+            stamps[v1]++;
+
+            for(int face_index : vertex_faces[v1]) {
+                if(!face_alive[face_index]) {
+                    continue;
+                }
+
+                auto &face = faces[face_index];
+                if(face[0] == v0 || face[1] == v0 || face[2] == v0) {
+                    face_alive[face_index] = false;
+                    alive_face_count--;
+                    continue;
+                }
+
+                for(int &vertex : face) {
+                    if(vertex == v1) {
+                        vertex = v0;
+                    }
+                }
+                vertex_faces[v0].push_back(face_index);
+            }
+            vertex_faces[v1].clear();
+
+            auto &adjacent_faces = vertex_faces[v0];
+            adjacent_faces.erase(std::remove_if(adjacent_faces.begin(), adjacent_faces.end(), [this](int face_index) { return !face_alive[face_index]; }),
+                                 adjacent_faces.end());
+
+            // Requeue all edges adjacent to the merged vertex
+            std::vector<int> neighbors;
+            for(int face_index : adjacent_faces) {
+                for(int vertex : faces[face_index]) {
+                    if(vertex != v0) {
+                        neighbors.push_back(vertex);
+                    }
+                }
+            }
+            std::sort(neighbors.begin(), neighbors.end());
+            neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+
+            for(int neighbor : neighbors) {
+                pushCollapse(v0, neighbor);
+            }
+        }
+
+      public:
+        explicit MeshSimplifier(const std::vector<Triangle> &triangles) {
+            std::unordered_map<std::array<std::uint32_t, 3>, int, PositionHash> indices;
+            indices.reserve(triangles.size());
+            faces.reserve(triangles.size());
+
+            for(const auto &triangle : triangles) {
+                std::array<int, 3> face = {addVertex(triangle.getA(), indices), addVertex(triangle.getB(), indices), addVertex(triangle.getC(), indices)};
+
+                if(face[0] == face[1] || face[1] == face[2] || face[0] == face[2]) {
+                    continue;
+                }
+
+                faces.push_back(face);
+            }
+
+            const int vertex_count = static_cast<int>(positions.size());
+            quadrics.resize(vertex_count);
+            stamps.resize(vertex_count);
+            removed.resize(vertex_count);
+            vertex_faces.resize(vertex_count);
+            face_alive.resize(faces.size(), true);
+            alive_face_count = static_cast<int>(faces.size());
+
+            // Accumulate area-weighted plane quadrics and count the faces adjacent to each edge
+            std::unordered_map<std::uint64_t, std::tuple<int, int>> edge_faces;
+            edge_faces.reserve(faces.size() * 3 / 2);
+
+            for(int face_index = 0; face_index < static_cast<int>(faces.size()); face_index++) {
+                const auto &face = faces[face_index];
+
+                auto normal = getFaceNormal(face);
+                auto double_area = normal.getLength();
+                if(!(double_area > 0.0)) {
+                    continue;
+                }
+                normal = normal / double_area;
+
+                auto plane_quadric = Quadric::fromPlane(normal, -dot(normal, positions[face[0]]), double_area / 2.0);
+
+                for(int i = 0; i < 3; i++) {
+                    quadrics[face[i]] += plane_quadric;
+                    vertex_faces[face[i]].push_back(face_index);
+
+                    auto v0 = std::min(face[i], face[(i + 1) % 3]);
+                    auto v1 = std::max(face[i], face[(i + 1) % 3]);
+                    auto key = (static_cast<std::uint64_t>(v0) << 32U) | static_cast<std::uint64_t>(v1);
+
+                    auto [it, inserted] = edge_faces.try_emplace(key, face_index, 0);
+                    std::get<1>(it->second)++;
+                }
+            }
+
+            // Constrain boundary edges by planes perpendicular to the adjacent face, to preserve the outline of open meshes
+            constexpr double boundary_weight = 1E3;
+            for(const auto &[key, edge] : edge_faces) {
+                auto [face_index, face_count] = edge;
+
+                auto v0 = static_cast<int>(key >> 32U);
+                auto v1 = static_cast<int>(key & 0xFFFFFFFFLLU);
+
+                if(face_count == 1) {
+                    auto edge_dir = positions[v1] - positions[v0];
+                    auto boundary_normal = cross(edge_dir, getFaceNormal(faces[face_index]));
+
+                    if(boundary_normal.getLengthSquared() > 0.0) {
+                        boundary_normal = boundary_normal.normalize();
+                        auto boundary_quadric =
+                          Quadric::fromPlane(boundary_normal, -dot(boundary_normal, positions[v0]), boundary_weight * edge_dir.getLengthSquared());
+
+                        quadrics[v0] += boundary_quadric;
+                        quadrics[v1] += boundary_quadric;
+                    }
+                }
+            }
+
+            for(const auto &[key, edge] : edge_faces) {
+                pushCollapse(static_cast<int>(key >> 32U), static_cast<int>(key & 0xFFFFFFFFLLU));
+            }
+        }
+
+        void simplify(int target_face_count) {
+            while(alive_face_count > target_face_count && !collapses.empty()) {
+                auto edge_collapse = collapses.top();
+                collapses.pop();
+
+                auto v0 = edge_collapse.v0;
+                auto v1 = edge_collapse.v1;
+
+                // Skip entries that were invalidated by earlier collapses
+                if(removed[v0] || removed[v1] || stamps[v0] != edge_collapse.stamp0 || stamps[v1] != edge_collapse.stamp1) {
+                    continue;
+                }
+
+                auto [cost, position] = getCollapse(v0, v1);
+
+                if(flipsFaces(v0, v1, position) || flipsFaces(v1, v0, position)) {
+                    continue;
+                }
+
+                collapse(v0, v1, position);
+            }
+        }
+
+        std::vector<Triangle> getTriangles(bool cull_backface, bool smooth) const {
+            std::vector<Triangle> triangles;
+            triangles.reserve(alive_face_count);
+
+            std::vector<vec3<float>> vertex_normals;
+            if(smooth) {
+                vertex_normals.resize(positions.size());
+            }
+
+            std::vector<std::array<int, 3>> output_faces;
+            output_faces.reserve(alive_face_count);
+
+            for(int face_index = 0; face_index < static_cast<int>(faces.size()); face_index++) {
+                if(!face_alive[face_index]) {
+                    continue;
+                }
+
+                const auto &face = faces[face_index];
+                std::array<vec3<float>, 3> corners = {toFloat(positions[face[0]]), toFloat(positions[face[1]]), toFloat(positions[face[2]])};
+
+                auto face_normal = cross(corners[1] - corners[0], corners[2] - corners[0]);
+                if(!(face_normal.getLengthSquared() > 0.0F)) {
+                    continue;
+                }
+
+                triangles.emplace_back(corners[0], corners[1], corners[2], cull_backface);
+                output_faces.push_back(face);
+
+                if(smooth) {
+                    for(int vertex : face) {
+                        vertex_normals[vertex] = vertex_normals[vertex] + face_normal.normalize();
+                    }
+                }
+            }
+
+            if(smooth) {
+                for(int i = 0; i < static_cast<int>(triangles.size()); i++) {
+                    auto &triangle = triangles[i];
+                    const auto &face = output_faces[i];
+
+                    triangle.normal_a = vertex_normals[face[0]].normalizeSafely();
+                    triangle.normal_b = vertex_normals[face[1]].normalizeSafely();
+                    triangle.normal_c = vertex_normals[face[2]].normalizeSafely();
+                }
+            }
+
+            return triangles;
+        }
+    };
+
+    // Center and radius of the sphere enclosing the bounding box of the triangles
+    std::tuple<vec3<float>, float> getBoundingSphere(const std::vector<Triangle> &triangles) {
+        AABBArea area = {};
+        if(!triangles.empty()) {
+            area = triangles[0].getBoundingVolume();
+            for(const auto &triangle : triangles) {
+                auto triangle_area = triangle.getBoundingVolume();
+                area = {min(area.low, triangle_area.low), max(area.high, triangle_area.high)};
+            }
+        }
+
+        return std::make_tuple((area.low + area.high) * 0.5F, (area.high - area.low).getLength() * 0.5F);
+    }
+
+    // Number of triangles that the policy asks for a mesh with the given bounding sphere, which is infinite if the sphere contains the camera
+    float getTargetTriangleCount(const Camera &camera, int image_height, const LODSelectionPolicy &policy, vec3<float> center, float radius) {
+        constexpr float pi = static_cast<float>(M_PI);
+
+        auto projected_size = camera.getProjectedSize(center, radius) * static_cast<float>(image_height);
+        if(!std::isfinite(projected_size)) {
+            return std::numeric_limits<float>::infinity();
+        }
+
+        auto covered_pixels = pi / 4.0F * projected_size * projected_size;
+
+        return std::max(covered_pixels * policy.triangles_per_pixel, 1.0F);
+    }
+
+}
+
+std::vector<Triangle> simplifyMesh(const std::vector<Triangle> &triangles, int target_triangle_count, bool cull_backface, bool smooth) {
+    using namespace impl;
+
+    MeshSimplifier simplifier(triangles);
+    simplifier.simplify(std::max(target_triangle_count, 0));
+
+    return simplifier.getTriangles(cull_backface, smooth);
+}
+
+MeshLODChain::MeshLODChain(std::vector<Triangle> &&triangles, int max_level_count, float reduction, int min_triangle_count, bool cull_backface,
+                           bool smooth) {
+    std::tie(this->bounding_center, this->bounding_radius) = impl::getBoundingSphere(triangles);
+
+    this->levels.emplace_back(std::move(triangles));
+
+    reduction = std::min(std::max(reduction, 0.0F), 1.0F);
+    while(static_cast<int>(this->levels.size()) < max_level_count) {
+        const auto &previous_level = this->levels.back();
+        auto previous_count = static_cast<int>(previous_level.size());
+
+        if(previous_count <= min_triangle_count) {
+            break;
+        }
+
+        auto target_count = std::max(static_cast<int>(static_cast<float>(previous_count) * reduction), 1);
+        auto level = simplifyMesh(previous_level, target_count, cull_backface, smooth);
+
+        // Stop once the simplification no longer makes meaningful progress
+        if(level.empty() || static_cast<int>(level.size()) >= previous_count) {
+            break;
+        }
+
+        this->levels.emplace_back(std::move(level));
+    }
+}
+
+int MeshLODChain::getLevelCount() const noexcept {
+    return static_cast<int>(this->levels.size());
+}
+
+const std::vector<Triangle> &MeshLODChain::getLevel(int level) const noexcept {
+    assert(level >= 0 && level < this->getLevelCount());
+
+    return this->levels[level];
+}
+
+void MeshLODChain::setMaterialHandler(const std::shared_ptr<MaterialHandler> &material_handler) {
+    for(auto &level : this->levels) {
+        for(auto &triangle : level) {
+            triangle.setMaterialHandler(material_handler);
+        }
+    }
+}
+
+int MeshLODChain::selectLevel(const Camera &camera, int image_height, const LODSelectionPolicy &policy, float u) const noexcept {
+    const int level_count = this->getLevelCount();
+
+    auto target_count = impl::getTargetTriangleCount(camera, image_height, policy, this->bounding_center, this->bounding_radius);
+    if(!std::isfinite(target_count)) {
+        return 0;
+    }
+
+    // Determine the continuous level by interpolating between the logarithmic triangle counts of adjacent levels
+    auto continuous_level = static_cast<float>(level_count - 1);
+    for(int i = 0; i < level_count - 1; i++) {
+        auto count = static_cast<float>(this->levels[i].size());
+        auto next_count = static_cast<float>(this->levels[i + 1].size());
+
+        if(next_count < target_count) {
+            if(count <= target_count) {
+                continuous_level = static_cast<float>(i);
+            }
+            else {
+                continuous_level = static_cast<float>(i) + std::log(count / target_count) / std::log(count / next_count);
+            }
+            break;
+        }
+    }
+
+    auto level = static_cast<int>(std::floor(continuous_level));
+    auto fraction = continuous_level - static_cast<float>(level);
+
+    // Choose the coarser level with a probability that increases linearly across the transition region
+    auto transition_width = std::max(policy.transition_width, 0.0F);
+    auto coarser_probability = fraction >= 0.5F ? 1.0F : 0.0F;
+    if(transition_width > 0.0F) {
+        coarser_probability = std::min(std::max((fraction - (1.0F - transition_width) / 2.0F) / transition_width, 0.0F), 1.0F);
+    }
+
+    if(u < coarser_probability) {
+        level++;
+    }
+
+    return std::min(std::max(level, 0), level_count - 1);
+}
+
+int getLODTriangleCount(const std::vector<Triangle> &triangles, const Camera &camera, int image_height, const LODSelectionPolicy &policy) noexcept {
+    auto [center, radius] = impl::getBoundingSphere(triangles);
+    auto target_count = impl::getTargetTriangleCount(camera, image_height, policy, center, radius);
+
+    auto triangle_count = static_cast<float>(triangles.size());
+    if(!(target_count < triangle_count)) {
+        return static_cast<int>(triangles.size());
+    }
+
+    return static_cast<int>(target_count);
+}
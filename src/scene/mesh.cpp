@@ -230,7 +230,7 @@ namespace impl {
                 face_normals.reserve(this->faces.size());
 
                 for(const auto &face : this->faces) {
-                    auto face_normal = cross(face.b - face.a, face.c - face.a);
+                    auto face_normal = cross(face.getAB(), face.getAC());
 
                     face_normals.emplace_back(face_normal);
                 }
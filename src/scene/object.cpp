@@ -6,6 +6,52 @@
 #include <algorithm>
 #include <utility>
 
+namespace impl {
+    // Triangles covering a smaller or larger solid angle are sampled by area, since spherical sampling becomes unstable
+    constexpr float min_spherical_triangle_area = 3E-4F;
+    constexpr float max_spherical_triangle_area = 6.22F;
+
+    // Cones with a smaller squared sine of their half angle use a series expansion to avoid cancellation
+    constexpr float min_cone_sin2 = 6.8523E-4F;
+
+    // Converts a probability density with respect to area into one with respect to solid angle as seen from a position
+    float convertAreaPdf(vec3<float> from, vec3<float> pos, vec3<float> n, float area_pd) {
+        auto to_surface = pos - from;
+        auto distance2 = to_surface.getLengthSquared();
+        if(!(distance2 > 0.0F)) {
+            return 0.0F;
+        }
+
+        auto abs_dot = std::abs(dot(to_surface, n)) / std::sqrt(distance2);
+        if(!(abs_dot > 0.0F)) {
+            return 0.0F;
+        }
+
+        return area_pd * distance2 / abs_dot;
+    }
+
+    // Angle between two vectors of length 1, which is accurate for nearly parallel vectors
+    float getAngleBetween(vec3<float> v1, vec3<float> v2) {
+        constexpr float pi = static_cast<float>(M_PI);
+
+        if(dot(v1, v2) < 0.0F) {
+            return pi - 2.0F * std::asin(std::min((v1 + v2).getLength() / 2.0F, 1.0F));
+        }
+
+        return 2.0F * std::asin(std::min((v2 - v1).getLength() / 2.0F, 1.0F));
+    }
+
+    // Solid angle of the spherical triangle spanned by three directions of length 1
+    float getSphericalTriangleArea(vec3<float> a, vec3<float> b, vec3<float> c) {
+        return std::abs(2.0F * std::atan2(dot(a, cross(b, c)), 1.0F + dot(a, b) + dot(a, c) + dot(b, c)));
+    }
+
+    // Component of v orthogonal to w, where w has length 1
+    vec3<float> getOrthogonal(vec3<float> v, vec3<float> w) {
+        return v - w * dot(v, w);
+    }
+}
+
 const std::shared_ptr<Material> default_material = std::make_shared<ConstantMaterial>(Color<float>(1.0F, 1.0F, 1.0F, 1.0F));
 const std::shared_ptr<BSDF> default_bsdf = std::make_shared<LambertianBRDF>();
 const std::shared_ptr<MaterialHandler> default_material_handler = std::make_shared<ConstantMaterialHandler>(default_material, default_bsdf);
@@ -49,6 +95,25 @@ std::tuple<vec3<float>, float, bool> Object::sampleSurface(RandomEngine & /*re*/
     return std::make_tuple(vec3<float>{}, 0.0F, false);
 }
 
+std::tuple<vec3<float>, float, bool> Object::sampleSurface(vec3<float> from, RandomEngine &re) const noexcept {
+    auto [pos, area_pd, cull] = this->sampleSurface(re);
+
+    return std::make_tuple(pos, impl::convertAreaPdf(from, pos, this->getSurfaceNormal(pos), area_pd), cull);
+}
+
+float Object::getSamplePdf(vec3<float> from, vec3<float> pos) const noexcept {
+    auto area = this->getSurfaceArea();
+    if(!(area > 0.0F)) {
+        return 0.0F;
+    }
+
+    return impl::convertAreaPdf(from, pos, this->getSurfaceNormal(pos), 1.0F / area);
+}
+
+std::tuple<vec3<float>, float, bool> Object::getNormalBounds() const noexcept {
+    return std::make_tuple(vec3<float>{0.0F, 1.0F, 0.0F}, -1.0F, true);
+}
+
 float NullObject::getIntersection(const Ray & /*ray*/) const noexcept {
     return -1.0F;
 }
@@ -101,10 +166,10 @@ float Sphere::getSurfaceArea() const noexcept {
 std::tuple<vec3<float>, float, bool> Sphere::sampleSurface(RandomEngine &re) const noexcept {
     constexpr float pi = static_cast<float>(M_PI);
 
-    std::uniform_real_distribution<float> dist(0, 1);
+    auto [r1, r2] = re.getFloats<2>();
 
-    auto theta = 2.0F * pi * dist(re);
-    auto phi = std::acos(1.0F - 2.0F * dist(re));
+    auto theta = 2.0F * pi * r1;
+    auto phi = std::acos(1.0F - 2.0F * r2);
     auto x = std::sin(phi) * std::cos(theta);
     auto y = std::sin(phi) * std::sin(theta);
     auto z = std::cos(phi);
@@ -115,8 +180,82 @@ std::tuple<vec3<float>, float, bool> Sphere::sampleSurface(RandomEngine &re) con
     return std::make_tuple(pos, p, false);
 }
 
-Triangle::Triangle(vec3<float> a, vec3<float> b, vec3<float> c, bool cull_backface) : a(a), b(b), c(c), cull_backface(cull_backface) {
-    auto face_normal = cross(b - a, c - a).normalize();
+std::tuple<vec3<float>, float, bool> Sphere::sampleSurface(vec3<float> from, RandomEngine &re) const noexcept {
+    constexpr float pi = static_cast<float>(M_PI);
+
+    auto to_center = this->origin - from;
+    auto distance2 = to_center.getLengthSquared();
+
+    // Points inside the sphere see all of its surface
+    if(distance2 <= this->radius2) {
+        return Object::sampleSurface(from, re);
+    }
+
+    auto [r1, r2] = re.getFloats<2>();
+
+    // Uniformly sample the cone of directions in which the sphere is visible
+    auto distance = std::sqrt(distance2);
+    auto sin2_theta_max = this->radius2 / distance2;
+    auto cos_theta_max = std::sqrt(std::max(1.0F - sin2_theta_max, 0.0F));
+    auto one_minus_cos_theta_max = 1.0F - cos_theta_max;
+
+    auto cos_theta = 1.0F - r1 * one_minus_cos_theta_max;
+    auto sin2_theta = 1.0F - cos_theta * cos_theta;
+    if(sin2_theta_max < impl::min_cone_sin2) {
+        one_minus_cos_theta_max = sin2_theta_max / 2.0F;
+        sin2_theta = sin2_theta_max * r1;
+        cos_theta = std::sqrt(1.0F - sin2_theta);
+    }
+
+    auto sin_theta = std::sqrt(std::max(sin2_theta, 0.0F));
+    auto phi = 2.0F * pi * r2;
+
+    auto axis = to_center / distance;
+    auto tangent = std::abs(axis[0]) > 0.9F ? vec3<float>{0.0F, 1.0F, 0.0F} : vec3<float>{1.0F, 0.0F, 0.0F};
+    auto b1 = cross(axis, tangent).normalize();
+    auto b2 = cross(axis, b1);
+
+    auto dir = axis * cos_theta + b1 * (sin_theta * std::cos(phi)) + b2 * (sin_theta * std::sin(phi));
+
+    // Distance to the first intersection with the sphere, where rounding errors may cause grazing rays to miss the sphere
+    auto t = distance * cos_theta - std::sqrt(std::max(this->radius2 - distance2 * sin2_theta, 0.0F));
+
+    auto pos = from + dir * t;
+    auto p = 1.0F / (2.0F * pi * one_minus_cos_theta_max);
+
+    return std::make_tuple(pos, p, false);
+}
+
+float Sphere::getSamplePdf(vec3<float> from, vec3<float> pos) const noexcept {
+    constexpr float pi = static_cast<float>(M_PI);
+
+    auto distance2 = (this->origin - from).getLengthSquared();
+    if(distance2 <= this->radius2) {
+        return Object::getSamplePdf(from, pos);
+    }
+
+    auto sin2_theta_max = this->radius2 / distance2;
+    auto one_minus_cos_theta_max = 1.0F - std::sqrt(std::max(1.0F - sin2_theta_max, 0.0F));
+    if(sin2_theta_max < impl::min_cone_sin2) {
+        one_minus_cos_theta_max = sin2_theta_max / 2.0F;
+    }
+
+    return 1.0F / (2.0F * pi * one_minus_cos_theta_max);
+}
+
+std::tuple<vec3<float>, float, bool> Sphere::getNormalBounds() const noexcept {
+    // Normals point in every direction, but the sphere is closed, so light is only emitted from its outside
+    return std::make_tuple(vec3<float>{0.0F, 1.0F, 0.0F}, -1.0F, false);
+}
+
+Triangle::Triangle(vec3<float> a, vec3<float> b, vec3<float> c, bool cull_backface) :
+  a(a), b(b), c(c), ab(b - a), ac(c - a), cull_backface(cull_backface) {
+    auto scaled_normal = cross(this->ab, this->ac);
+
+    this->area = scaled_normal.getLength() / 2.0F;
+    this->inv_area = 1.0F / this->area;
+
+    auto face_normal = scaled_normal.normalize();
 
     this->normal_a = face_normal;
     this->normal_b = face_normal;
@@ -124,8 +263,8 @@ Triangle::Triangle(vec3<float> a, vec3<float> b, vec3<float> c, bool cull_backfa
 }
 
 vec3<float> Triangle::getSurfaceNormal(vec3<float> pos) const noexcept {
-    auto ab = this->b - this->a;
-    auto ac = this->c - this->a;
+    const auto &ab = this->ab;
+    const auto &ac = this->ac;
     auto ap = pos - this->a;
 
     float d00 = dot(ab, ab);
@@ -146,8 +285,8 @@ vec3<float> Triangle::getSurfaceNormal(vec3<float> pos) const noexcept {
 float Triangle::getIntersection(const Ray &ray) const noexcept {
     constexpr float epsilon = 1E-6F;
 
-    auto ab = this->b - this->a;
-    auto ac = this->c - this->a;
+    const auto &ab = this->ab;
+    const auto &ac = this->ac;
     auto pvec = cross(ray.dir, ac);
     auto det = dot(ab, pvec);
 
@@ -186,22 +325,156 @@ AABBArea Triangle::getBoundingVolume() const noexcept {
 }
 
 float Triangle::getSurfaceArea() const noexcept {
-    return cross(this->b - this->a, this->c - this->a).getLength() / 2.0F;
+    return this->area;
 }
 
 std::tuple<vec3<float>, float, bool> Triangle::sampleSurface(RandomEngine &re) const noexcept {
-    std::uniform_real_distribution<float> dist(0, 1);
-
-    auto r1 = dist(re);
-    auto r2 = dist(re);
+    auto [r1, r2] = re.getFloats<2>();
 
     auto rr1 = std::sqrt(r1);
 
-    vec3<float> pos = this->a * (1.0F - rr1) + this->b * (rr1 * (1.0F - r2)) + this->c * (rr1 * r2);
+    vec3<float> pos = this->a + this->ab * (rr1 * (1.0F - r2)) + this->ac * (rr1 * r2);
+
+    return std::make_tuple(pos, this->inv_area, this->cull_backface);
+}
 
-    // TODO: Precompute
-    auto area = cross(this->b - this->a, this->c - this->a).getLength() / 2.0F;
-    auto p = 1.0F / area;
+std::tuple<vec3<float>, float, bool> Triangle::sampleSurface(vec3<float> from, RandomEngine &re) const noexcept {
+    auto [r1, r2] = re.getFloats<2>();
+
+    auto [v, w, p] = sampleTriangle(from, this->a, this->ab, this->ac, this->inv_area, r1, r2);
+
+    vec3<float> pos = this->a + this->ab * v + this->ac * w;
 
     return std::make_tuple(pos, p, this->cull_backface);
 }
+
+float Triangle::getSamplePdf(vec3<float> from, vec3<float> pos) const noexcept {
+    return getTrianglePdf(from, this->a, this->ab, this->ac, this->inv_area, pos);
+}
+
+std::tuple<vec3<float>, float, bool> Triangle::getNormalBounds() const noexcept {
+    auto face_normal = cross(this->ab, this->ac).normalize();
+
+    // Widen the cone to include the interpolated vertex normals
+    auto cos_theta = std::min({1.0F, dot(face_normal, this->normal_a), dot(face_normal, this->normal_b), dot(face_normal, this->normal_c)});
+
+    return std::make_tuple(face_normal, std::max(cos_theta, -1.0F), !this->cull_backface);
+}
+
+vec3<float> Triangle::getA() const noexcept {
+    return this->a;
+}
+
+vec3<float> Triangle::getB() const noexcept {
+    return this->b;
+}
+
+vec3<float> Triangle::getC() const noexcept {
+    return this->c;
+}
+
+vec3<float> Triangle::getAB() const noexcept {
+    return this->ab;
+}
+
+vec3<float> Triangle::getAC() const noexcept {
+    return this->ac;
+}
+
+bool Triangle::isBackfaceCulled() const noexcept {
+    return this->cull_backface;
+}
+
+std::tuple<float, float, float> sampleTriangle(vec3<float> from, vec3<float> a, vec3<float> ab, vec3<float> ac, float inv_area, float u1, float u2) noexcept {
+    using namespace impl;
+
+    constexpr float pi = static_cast<float>(M_PI);
+
+    auto da = (a - from).normalize();
+    auto db = (a + ab - from).normalize();
+    auto dc = (a + ac - from).normalize();
+
+    auto solid_angle = getSphericalTriangleArea(da, db, dc);
+
+    if(!(solid_angle >= min_spherical_triangle_area && solid_angle <= max_spherical_triangle_area)) {
+        // Sample uniformly by area
+        auto ru1 = std::sqrt(u1);
+        auto v = ru1 * (1.0F - u2);
+        auto w = ru1 * u2;
+
+        auto pos = a + ab * v + ac * w;
+        auto p = convertAreaPdf(from, pos, cross(ab, ac).normalize(), inv_area);
+
+        return std::make_tuple(v, w, p);
+    }
+
+    // Sample uniformly by solid angle following Arvo, "Stratified Sampling of Spherical Triangles"
+    auto n_ab = cross(da, db);
+    auto n_bc = cross(db, dc);
+    auto n_ca = cross(dc, da);
+    if(!(n_ab.getLengthSquared() > 0.0F && n_bc.getLengthSquared() > 0.0F && n_ca.getLengthSquared() > 0.0F)) {
+        return std::make_tuple(0.0F, 0.0F, 0.0F);
+    }
+    n_ab = n_ab.normalize();
+    n_bc = n_bc.normalize();
+    n_ca = n_ca.normalize();
+
+    auto alpha = getAngleBetween(n_ab, -n_ca);
+    auto beta = getAngleBetween(n_bc, -n_ab);
+    auto gamma = getAngleBetween(n_ca, -n_bc);
+
+    // Choose the area of the sub-triangle, which determines the new vertex c' on the arc from a to c
+    auto area_pi = pi + u1 * (alpha + beta + gamma - pi);
+
+    auto cos_alpha = std::cos(alpha);
+    auto sin_alpha = std::sin(alpha);
+    auto sin_phi = std::sin(area_pi) * cos_alpha - std::cos(area_pi) * sin_alpha;
+    auto cos_phi = std::cos(area_pi) * cos_alpha + std::sin(area_pi) * sin_alpha;
+
+    auto k1 = cos_phi + cos_alpha;
+    auto k2 = sin_phi - sin_alpha * dot(da, db);
+    auto cos_b = (k2 + (k2 * cos_phi - k1 * sin_phi) * cos_alpha) / ((k2 * sin_phi + k1 * cos_phi) * sin_alpha);
+    cos_b = std::clamp(std::isnan(cos_b) ? 1.0F : cos_b, -1.0F, 1.0F);
+    auto sin_b = std::sqrt(std::max(1.0F - cos_b * cos_b, 0.0F));
+
+    auto c_prime = da * cos_b + getOrthogonal(dc, da).normalize() * sin_b;
+
+    // Sample a direction on the arc from b to c'
+    auto cos_theta = 1.0F - u2 * (1.0F - dot(c_prime, db));
+    auto sin_theta = std::sqrt(std::max(1.0F - cos_theta * cos_theta, 0.0F));
+    auto dir = db * cos_theta + getOrthogonal(c_prime, db).normalize() * sin_theta;
+
+    // Intersect the direction with the triangle to obtain barycentric coordinates
+    auto s1 = cross(dir, ac);
+    auto divisor = dot(s1, ab);
+    if(divisor == 0.0F) {
+        return std::make_tuple(1.0F / 3.0F, 1.0F / 3.0F, 1.0F / solid_angle);
+    }
+
+    auto s = from - a;
+    auto v = std::clamp(dot(s, s1) / divisor, 0.0F, 1.0F);
+    auto w = std::clamp(dot(dir, cross(s, ab)) / divisor, 0.0F, 1.0F);
+    if(v + w > 1.0F) {
+        auto sum = v + w;
+        v /= sum;
+        w /= sum;
+    }
+
+    return std::make_tuple(v, w, 1.0F / solid_angle);
+}
+
+float getTrianglePdf(vec3<float> from, vec3<float> a, vec3<float> ab, vec3<float> ac, float inv_area, vec3<float> pos) noexcept {
+    using namespace impl;
+
+    auto da = (a - from).normalize();
+    auto db = (a + ab - from).normalize();
+    auto dc = (a + ac - from).normalize();
+
+    auto solid_angle = getSphericalTriangleArea(da, db, dc);
+
+    if(!(solid_angle >= min_spherical_triangle_area && solid_angle <= max_spherical_triangle_area)) {
+        return convertAreaPdf(from, pos, cross(ab, ac).normalize(), inv_area);
+    }
+
+    return 1.0F / solid_angle;
+}
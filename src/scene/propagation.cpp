@@ -92,9 +92,8 @@ std::tuple<Ray, float, float> LambertianBRDF::propagateRay(Ray /*ray*/, vec3<flo
 
     assertNormalized(normal);
 
-    std::uniform_real_distribution<float> dist(0, 1);
-
-    auto [local_dir, p] = importanceSampleCosine(dist(re), dist(re), 1.0F);
+    auto [r1, r2] = re.getFloats<2>();
+    auto [local_dir, p] = importanceSampleCosine(r1, r2, 1.0F);
     assertNormalized(local_dir);
 
     vec3<float> dir = localToGlobal(local_dir, normal);
@@ -115,6 +114,15 @@ std::tuple<Spectrum, float, float> LambertianBRDF::getSpectrum(Ray /*from_camera
     return std::make_tuple(spectrum_multiplier * light_spectrum, shade_factor, 1.0F);
 }
 
+float LambertianBRDF::getPdf(Ray /*from_camera*/, Ray to_light, vec3<float> /*pos*/, vec3<float> normal, const Material * /*material*/) const noexcept {
+    // Cosine-weighted hemisphere sampling as performed by propagateRay
+    return std::max(dot(normal, to_light.dir), 0.0F) / pi;
+}
+
+bool LambertianBRDF::isDiscrete() const noexcept {
+    return false;
+}
+
 GlassBDF::GlassBDF() noexcept = default;
 
 std::tuple<Ray, float, float> GlassBDF::propagateRay(Ray ray, vec3<float> pos, vec3<float> normal, float epsilon, RandomEngine &re,
@@ -133,9 +141,8 @@ std::tuple<Ray, float, float> GlassBDF::propagateRay(Ray ray, vec3<float> pos, v
     auto [rat, cosThetaT] = getFresnelReflectance(std::abs(ray_dot), ri_leaving, ri_entering);
 
     assert(rat >= 0.0F && rat <= 1.0F);
-    std::bernoulli_distribution d(rat);
 
-    if(d(re)) {
+    if(re.getFloat() < rat) {
         // Reflect
 
         vec3<float> dir = reflect(ray.dir, normal * (ray_dot < 0.0F ? -1.0F : 1.0F));
@@ -175,6 +182,14 @@ std::tuple<Spectrum, float, float> GlassBDF::getSpectrum(Ray from_camera, Ray to
     return std::make_tuple(out_spectrum, 1.0F, p);
 }
 
+float GlassBDF::getPdf(Ray /*from_camera*/, Ray /*to_light*/, vec3<float> /*pos*/, vec3<float> /*normal*/, const Material * /*material*/) const noexcept {
+    return 0.0F;
+}
+
+bool GlassBDF::isDiscrete() const noexcept {
+    return true;
+}
+
 MirrorBRDF::MirrorBRDF(bool one_way) noexcept : one_way(one_way) {}
 
 std::tuple<Ray, float, float> MirrorBRDF::propagateRay(Ray ray, vec3<float> pos, vec3<float> normal, float epsilon, RandomEngine & /*re*/,
@@ -215,3 +230,11 @@ std::tuple<Spectrum, float, float> MirrorBRDF::getSpectrum(Ray from_camera, Ray
 
     return std::make_tuple(out_spectrum, 1.0F, p);
 }
+
+float MirrorBRDF::getPdf(Ray /*from_camera*/, Ray /*to_light*/, vec3<float> /*pos*/, vec3<float> /*normal*/, const Material * /*material*/) const noexcept {
+    return 0.0F;
+}
+
+bool MirrorBRDF::isDiscrete() const noexcept {
+    return true;
+}
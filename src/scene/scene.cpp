@@ -5,11 +5,41 @@
 #include <algorithm>
 #include <limits>
 #include <utility>
+#include <tuple>
 #include <cassert>
+#include <cstddef>
 #include <random>
+#include <numeric>
 
 namespace impl {
-    AABB constructBVH(std::vector<AABB> &&bounding_boxes) {
+    // Samples a direction in the hemisphere around the z-axis proportionally to the cosine to the axis,
+    //  returning the direction and its probability density with respect to solid angle
+    std::tuple<vec3<float>, float> sampleCosineHemisphere(float u1, float u2) {
+        constexpr float pi = static_cast<float>(M_PI);
+
+        auto r = std::sqrt(u1);
+        auto phi = 2.0F * pi * u2;
+        auto cos_theta = std::sqrt(std::max(1.0F - u1, 0.0F));
+
+        return std::make_tuple(vec3<float>{r * std::cos(phi), r * std::sin(phi), cos_theta}, cos_theta / pi);
+    }
+
+    // Transforms a direction given relative to the z-axis into the frame around the given axis
+    vec3<float> toWorld(vec3<float> local, vec3<float> axis) {
+        auto tangent = std::abs(axis[0]) > 0.9F ? vec3<float>{0.0F, 1.0F, 0.0F} : vec3<float>{1.0F, 0.0F, 0.0F};
+        auto b1 = cross(axis, tangent).normalize();
+        auto b2 = cross(axis, b1);
+
+        return (b1 * local[0] + b2 * local[1] + axis * local[2]).normalize();
+    }
+
+    // Subtrees with fewer nodes than this are always constructed eagerly, since deferring them saves little work
+    constexpr std::size_t min_deferred_node_count = 16;
+
+    // Constructs a BVH from the given nodes
+    // If eager_depth is non-negative, subtrees below that depth are deferred,
+    //  and will construct a further eager_depth levels once they are first expanded
+    AABB constructBVH(std::vector<AABB> &&bounding_boxes, int eager_depth = -1, int depth = 0) {
         if(bounding_boxes.empty()) {
             return {};
         }
@@ -18,6 +48,10 @@ namespace impl {
             return std::move(bounding_boxes[0]);
         }
 
+        if(eager_depth >= 0 && depth >= eager_depth && bounding_boxes.size() >= min_deferred_node_count) {
+            return {std::move(bounding_boxes), eager_depth};
+        }
+
         constexpr int dim_count = 3;
 
         // Determine median lower location (cutoff) in each dimension
@@ -93,14 +127,27 @@ namespace impl {
             left_children.erase(last_it);
         }
 
-        AABB left_child = constructBVH(std::move(left_children));
-        AABB right_child = constructBVH(std::move(right_children));
+        AABB left_child = constructBVH(std::move(left_children), eager_depth, depth + 1);
+        AABB right_child = constructBVH(std::move(right_children), eager_depth, depth + 1);
 
         AABB combined(std::move(left_child), std::move(right_child));
 
         return combined;
     }
 
+    void expandDeferred(const AABB &aabb) {
+        DeferredAABBChildren &deferred = *aabb.deferred;
+
+        std::call_once(deferred.expanded, [&aabb, &deferred]() {
+            // Always construct at least the root of the subtree, which takes the place of the deferred node
+            AABB subtree = constructBVH(std::move(deferred.bounding_boxes), std::max(deferred.eager_depth, 1));
+            assert(!subtree.leaf);
+
+            aabb.left = std::move(subtree.left);
+            aabb.right = std::move(subtree.right);
+        });
+    }
+
     std::tuple<float, const Object *> getChildIntersection(const AABB &aabb, const Ray &ray, float t_max) {
         if(aabb.leaf) {
             auto child_t = aabb.child->getIntersection(ray);
@@ -108,6 +155,10 @@ namespace impl {
             return std::make_tuple(child_t, aabb.child.get());
         }
 
+        if(aabb.deferred) {
+            expandDeferred(aabb);
+        }
+
         constexpr auto zero = static_cast<float>(0);
 
         auto left_t = aabb.left->getIntersection(ray);
@@ -150,33 +201,90 @@ namespace impl {
     }
 }
 
-Scene::Scene(std::vector<std::unique_ptr<Object>> &&objects, std::vector<std::unique_ptr<LightSource>> &&light_sources) {
+static_assert(sizeof(EmissiveTriangle) == 128 && offsetof(EmissiveTriangle, normals) <= 64);
+
+EmissiveTriangle::EmissiveTriangle(const Triangle &triangle, Spectrum emission) noexcept :
+  a(triangle.getA()), ab(triangle.getAB()), ac(triangle.getAC()), inv_area(1.0F / triangle.getSurfaceArea()),
+  emission(emission), cull_backface(triangle.isBackfaceCulled()), normals{triangle.normal_a, triangle.normal_b, triangle.normal_c} {}
+
+Scene::Scene(std::vector<std::unique_ptr<Object>> &&objects, std::vector<std::unique_ptr<LightSource>> &&light_sources, const SceneOptions &options) {
     this->light_sources = std::move(light_sources);
 
+    // The objects are moved into the BVH below, so their count is needed to tell whether the bounds are those of an empty scene
+    const auto object_count = objects.size();
+
     std::vector<AABB> aabbs;
-    aabbs.reserve(objects.size());
+    aabbs.reserve(object_count);
     for(std::unique_ptr<Object> &object : objects) {
         aabbs.emplace_back(object->getBoundingVolume(), std::move(object));
     }
 
-    this->bounding_box = impl::constructBVH(std::move(aabbs));
+    this->bounding_box = impl::constructBVH(std::move(aabbs), options.lazy_bvh ? std::max(options.eager_bvh_depth, 0) : -1);
+
+    // Infinite light sources need the extent of the scene to place their samples and estimate their power
+    auto scene_low = this->bounding_box.area.low;
+    auto scene_high = this->bounding_box.area.high;
+    vec3<float> scene_center = {0.0F, 0.0F, 0.0F};
+    float scene_radius = 1.0F;
+    if(object_count > 0 && std::isfinite((scene_high - scene_low).getLengthSquared())) {
+        scene_center = (scene_low + scene_high) * 0.5F;
+        scene_radius = std::max((scene_high - scene_low).getLength() * 0.5F, 1E-3F);
+    }
+
+    int light_source_count = static_cast<int>(this->light_sources.size());
+    for(int i = 0; i < light_source_count; i++) {
+        this->light_sources[i]->setSceneBounds(scene_center, scene_radius);
+        if(this->light_sources[i]->isInfinite()) {
+            this->infinite_light_indices.push_back(i);
+        }
+    }
 
     // Initialize object light sources
     this->registerEmissiveObjects(this->bounding_box);
+    this->packEmissiveTriangles();
 
-    int emissive_object_count = static_cast<int>(this->object_light_source_probabilities.size());
-
-    auto cumulative_probability = 0.0F;
+    int emissive_object_count = static_cast<int>(this->object_light_sources.size());
     for(int i = 0; i < emissive_object_count; i++) {
-        float probability = this->object_light_source_probabilities[i];
+        this->object_light_source_indices.emplace(this->object_light_sources[i], i);
+    }
+
+    this->object_sample_count = std::min(2 + static_cast<int>(std::log10(emissive_object_count + 1)), emissive_object_count);
 
-        this->object_light_source_probabilities[i] += cumulative_probability;
-        cumulative_probability += probability;
+    // Combine the light sources with the group of emissive objects, using comparable estimates of their power
+    std::vector<float> light_powers;
+    light_powers.reserve(light_source_count + 1);
+    for(const std::unique_ptr<LightSource> &light : this->light_sources) {
+        light_powers.push_back(std::max(light->getPower(), 0.0F));
+    }
+    if(emissive_object_count > 0) {
+        // Emissive surfaces emit into the hemisphere around their normal
+        constexpr float pi = static_cast<float>(M_PI);
+        light_powers.push_back(pi * std::accumulate(this->object_light_source_powers.begin(), this->object_light_source_powers.end(), 0.0F));
     }
 
-    // Normalize probabilities
-    for(int i = 0; i < emissive_object_count; i++) {
-        this->object_light_source_probabilities[i] /= cumulative_probability;
+    if(!light_powers.empty()) {
+        // Fall back to uniform selection if no light source reports any power
+        if(!(std::accumulate(light_powers.begin(), light_powers.end(), 0.0F) > 0.0F)) {
+            std::fill(light_powers.begin(), light_powers.end(), 1.0F);
+        }
+
+        this->light_table = AliasTable(light_powers);
+        if(emissive_object_count > 0) {
+            this->emitter_group_probability = this->light_table.getProbability(this->light_table.size() - 1);
+        }
+    }
+
+    this->light_sample_count = std::max(options.light_sample_count, 0);
+
+    this->emitter_selection = options.emitter_selection;
+    if(this->object_light_sources.empty()) {
+        return;
+    }
+
+    // The power distribution is also used to choose the origins of light paths, independent of the emitter selection
+    this->emitter_table = AliasTable(this->object_light_source_powers);
+    if(this->emitter_selection == EmitterSelection::LightBVH) {
+        this->light_bvh = LightBVH(this->object_light_sources, this->object_light_source_powers);
     }
 }
 
@@ -199,7 +307,13 @@ void Scene::registerEmissiveObjects(const AABB &aabb) {
         }
 
         object_light_sources.push_back(object);
-        object_light_source_probabilities.push_back(object_probability);
+        object_light_source_powers.push_back(object_probability);
+    }
+    else if(aabb.deferred) {
+        // Visit the pending nodes directly to avoid expanding deferred subtrees
+        for(const AABB &child : aabb.deferred->bounding_boxes) {
+            registerEmissiveObjects(child);
+        }
     }
     else {
         registerEmissiveObjects(*aabb.left);
@@ -207,6 +321,37 @@ void Scene::registerEmissiveObjects(const AABB &aabb) {
     }
 }
 
+void Scene::packEmissiveTriangles() {
+    // Move triangles with constant emission to the front, so that they can be sampled from the packed arrays
+    std::vector<std::pair<const Object *, float>> emitters;
+    emitters.reserve(this->object_light_sources.size());
+
+    auto emitter_count = static_cast<int>(this->object_light_sources.size());
+    for(int i = 0; i < emitter_count; i++) {
+        const Object *object = this->object_light_sources[i];
+        float power = this->object_light_source_powers[i];
+
+        const auto *triangle = dynamic_cast<const Triangle *>(object);
+        const auto *material_handler = dynamic_cast<const ConstantMaterialHandler *>(object->getMaterialHandler());
+        const auto *material = material_handler ? dynamic_cast<const ConstantMaterial *>(material_handler->probeMaterial()) : nullptr;
+
+        if(triangle && material) {
+            this->emissive_triangles.emplace_back(*triangle, material->probeEmission());
+            this->object_light_sources[this->emissive_triangles.size() - 1] = object;
+            this->object_light_source_powers[this->emissive_triangles.size() - 1] = power;
+        }
+        else {
+            emitters.emplace_back(object, power);
+        }
+    }
+
+    auto packed_count = this->emissive_triangles.size();
+    for(int i = 0; i < static_cast<int>(emitters.size()); i++) {
+        this->object_light_sources[packed_count + i] = emitters[i].first;
+        this->object_light_source_powers[packed_count + i] = emitters[i].second;
+    }
+}
+
 std::tuple<float, const Object *> Scene::getIntersection(const Ray &ray) const noexcept {
     auto t = this->bounding_box.getIntersection(ray);
     assert(!std::isnan(t));
@@ -219,71 +364,292 @@ std::tuple<float, const Object *> Scene::getIntersection(const Ray &ray) const n
     }
 }
 
-std::vector<std::tuple<vec3<float>, Spectrum, float>> Scene::sampleLights(vec3<float> pos, vec3<float> /*n*/, RandomEngine &re) const noexcept {
-    std::uniform_real_distribution<float> dist(0, 1);
+AABBArea Scene::getBounds() const noexcept {
+    return this->bounding_box.area;
+}
 
-    int emissive_object_count = static_cast<int>(this->object_light_sources.size());
-    int object_sample_count = std::min(2 + static_cast<int>(std::log10(emissive_object_count + 1)), emissive_object_count);
+int Scene::getMaxLightSampleCount() const noexcept {
+    if(this->light_sample_count > 0) {
+        return this->light_sample_count;
+    }
 
-    std::vector<std::tuple<vec3<float>, Spectrum, float>> lights;
-    lights.reserve(this->light_sources.size() + object_sample_count);
+    return static_cast<int>(this->light_sources.size()) + this->object_sample_count;
+}
 
-    for(const std::unique_ptr<LightSource> &light : this->light_sources) {
-        auto [target, pd] = light->importanceSample(pos);
+std::tuple<LightSample, bool> Scene::sampleEmissiveObject(vec3<float> pos, vec3<float> n, RandomEngine &re) const noexcept {
+    auto r = re.getFloat();
 
-        Ray ray{pos, (target - pos).normalize()};
-        lights.emplace_back(target, light->getSpectrum(ray), pd);
+    int object_index = -1;
+    float selection_p = 0.0F;
+
+    if(this->emitter_selection == EmitterSelection::LightBVH) {
+        std::tie(object_index, selection_p) = this->light_bvh.sample(pos, n, r);
+
+        if(object_index < 0) {
+            return std::make_tuple(LightSample{}, false);
+        }
     }
+    else {
+        std::tie(object_index, selection_p) = this->emitter_table.sample(r);
+    }
+    assert(object_index >= 0);
+    assert(object_index < static_cast<int>(this->object_light_sources.size()));
+
+    vec3<float> surface_pos;
+    vec3<float> surface_n;
+    float surface_p;
+    bool surface_cull;
+    Spectrum emission;
 
-    for(int i = 0; i < object_sample_count; i++) {
-        auto r = dist(re);
+    if(object_index < static_cast<int>(this->emissive_triangles.size())) {
+        const auto &triangle = this->emissive_triangles[object_index];
 
-        auto it = std::lower_bound(this->object_light_source_probabilities.begin(), this->object_light_source_probabilities.end(), r);
-        assert(it != this->object_light_source_probabilities.end());
+        auto [r1, r2] = re.getFloats<2>();
 
-        int object_index = static_cast<int>(it - this->object_light_source_probabilities.begin());
-        assert(object_index >= 0);
-        assert(object_index < this->object_light_sources.size());
+        // Barycentric coordinates of the sampled point
+        auto [v, w, p] = sampleTriangle(pos, triangle.a, triangle.ab, triangle.ac, triangle.inv_area, r1, r2);
+        auto u = 1.0F - v - w;
 
-        assert(this->object_light_source_probabilities[object_index] >= r);
-        assert(object_index == 0 || this->object_light_source_probabilities[object_index - 1] < r);
+        surface_pos = triangle.a + triangle.ab * v + triangle.ac * w;
+        surface_n = (triangle.normals[0] * u + triangle.normals[1] * v + triangle.normals[2] * w).normalize();
+        surface_p = p;
+        surface_cull = triangle.cull_backface;
+        emission = triangle.emission;
+    }
+    else {
+        const auto *object = this->object_light_sources[object_index];
+
+        std::tie(surface_pos, surface_p, surface_cull) = object->sampleSurface(pos, re);
+        surface_n = object->getSurfaceNormal(surface_pos);
+    }
 
-        auto selection_p = this->object_light_source_probabilities[object_index];
-        if(object_index > 0) {
-            selection_p -= this->object_light_source_probabilities[object_index - 1];
+    // Densities are with respect to solid angle as seen from the position
+    if(!(surface_p > 0.0F)) {
+        return std::make_tuple(LightSample{}, false);
+    }
+
+    auto to_light = (surface_pos - pos);
+    if(!(to_light.getLengthSquared() > 0.0F)) {
+        return std::make_tuple(LightSample{}, false);
+    }
+    auto dir = to_light.normalize();
+
+    if(surface_cull) {
+        if(!(dot(dir, surface_n) < 0.0F)) {
+            return std::make_tuple(LightSample{}, false);
         }
-        selection_p *= float(object_sample_count);
+    }
 
-        const auto *object = this->object_light_sources[object_index];
+    Ray ray{pos, dir};
+    if(object_index >= static_cast<int>(this->emissive_triangles.size())) {
+        const auto *material = this->object_light_sources[object_index]->getMaterialHandler()->getMaterial(surface_pos);
+        emission = material->getEmission(ray, surface_pos);
+    }
 
-        auto [surface_pos, surface_p, surface_cull] = object->sampleSurface(re);
-        auto surface_n = object->getSurfaceNormal(surface_pos);
+    int light_id = static_cast<int>(this->light_sources.size()) + object_index;
+
+    return std::make_tuple(LightSample{surface_pos, emission, selection_p * surface_p, true, light_id}, true);
+}
 
-        auto to_light = (surface_pos - pos);
-        auto dir = to_light.normalize();
+std::vector<LightSample> Scene::sampleLights(vec3<float> pos, vec3<float> n, RandomEngine &re) const noexcept {
+    std::vector<LightSample> lights(this->getMaxLightSampleCount());
 
-        auto abs_dot = std::abs(dot(-dir, surface_n));
+    int light_count = this->sampleLights(pos, n, re, lights);
+    lights.resize(light_count);
 
-        if(!(abs_dot > 0.0F)) {
+    return lights;
+}
+
+int Scene::sampleLights(vec3<float> pos, vec3<float> n, RandomEngine &re, std::span<LightSample> lights) const noexcept {
+    int light_count = 0;
+    int max_light_count = static_cast<int>(lights.size());
+
+    // Every sample takes its own dimensions, so that the dimensions of a sample do not depend on how many numbers the others drew
+    auto dimension = re.getDimension();
+
+    if(this->light_sample_count > 0) {
+        for(int i = 0; i < this->light_sample_count && light_count < max_light_count; i++) {
+            re.setDimension(dimension + static_cast<std::uint32_t>(i) * light_sample_dimension_count);
+            auto [sample, valid] = this->sampleLight(pos, n, re);
+            if(!valid) {
+                continue;
+            }
+
+            sample.pd *= float(this->light_sample_count);
+            lights[light_count++] = sample;
+        }
+
+        return light_count;
+    }
+
+    int light_source_count = static_cast<int>(this->light_sources.size());
+    for(int light_index = 0; light_index < light_source_count; light_index++) {
+        if(light_count == max_light_count) {
+            return light_count;
+        }
+
+        const auto &light = this->light_sources[light_index];
+
+        re.setDimension(dimension + static_cast<std::uint32_t>(light_index) * light_sample_dimension_count + 2);
+        auto [target, pd] = light->importanceSample(pos, re);
+        if(!(pd > 0.0F)) {
             continue;
         }
-        if(!(to_light.getLengthSquared() > 0.0F)) {
+
+        Ray ray{pos, (target - pos).normalize()};
+        lights[light_count++] = {target, light->getSpectrum(ray), pd, light->isInfinite(), light_index};
+    }
+
+    for(int i = 0; i < this->object_sample_count && light_count < max_light_count; i++) {
+        re.setDimension(dimension + static_cast<std::uint32_t>(light_source_count + i) * light_sample_dimension_count + 1);
+        auto [sample, valid] = this->sampleEmissiveObject(pos, n, re);
+        if(!valid) {
             continue;
         }
-        if(surface_cull) {
-            if(!(dot(dir, surface_n) < 0.0F)) {
-                continue;
-            }
+
+        sample.pd *= float(this->object_sample_count);
+        lights[light_count++] = sample;
+    }
+
+    return light_count;
+}
+
+std::tuple<LightSample, bool> Scene::sampleLight(vec3<float> pos, vec3<float> n, RandomEngine &re) const noexcept {
+    if(this->light_table.empty()) {
+        return std::make_tuple(LightSample{}, false);
+    }
+
+    int light_source_count = static_cast<int>(this->light_sources.size());
+    auto dimension = re.getDimension();
+    auto [choice, selection_p] = this->light_table.sample(re.getFloat());
+
+    if(choice < light_source_count) {
+        const auto &light = this->light_sources[choice];
+        re.setDimension(dimension + 2);
+        auto [target, pd] = light->importanceSample(pos, re);
+        if(!(pd > 0.0F)) {
+            return std::make_tuple(LightSample{}, false);
         }
 
-        // Conversion factor between ray direction pdf and surface point pdf
-        auto conversion_factor = to_light.getLengthSquared() / abs_dot;
+        Ray ray{pos, (target - pos).normalize()};
+        return std::make_tuple(LightSample{target, light->getSpectrum(ray), selection_p * pd, light->isInfinite(), choice}, true);
+    }
 
-        const auto *material = object->getMaterialHandler()->getMaterial(surface_pos);
+    auto [sample, valid] = this->sampleEmissiveObject(pos, n, re);
+    sample.pd *= selection_p;
 
-        Ray ray{pos, dir};
-        lights.emplace_back(surface_pos, material->getEmission(ray, surface_pos), selection_p * surface_p * conversion_factor);
+    return std::make_tuple(sample, valid);
+}
+
+float Scene::getLightPdf(vec3<float> pos, vec3<float> n, const Object *object, vec3<float> light_pos) const noexcept {
+    auto it = this->object_light_source_indices.find(object);
+    if(it == this->object_light_source_indices.end()) {
+        return 0.0F;
     }
+    int object_index = it->second;
 
-    return lights;
+    float selection_p;
+    if(this->emitter_selection == EmitterSelection::LightBVH) {
+        selection_p = this->light_bvh.getProbability(pos, n, object_index);
+    }
+    else {
+        selection_p = this->emitter_table.getProbability(object_index);
+    }
+    if(this->light_sample_count > 0) {
+        selection_p *= this->emitter_group_probability * float(this->light_sample_count);
+    }
+    else {
+        selection_p *= float(this->object_sample_count);
+    }
+
+    if(object_index < static_cast<int>(this->emissive_triangles.size())) {
+        const auto &triangle = this->emissive_triangles[object_index];
+
+        return selection_p * getTrianglePdf(pos, triangle.a, triangle.ab, triangle.ac, triangle.inv_area, light_pos);
+    }
+
+    return selection_p * object->getSamplePdf(pos, light_pos);
+}
+
+int Scene::getInfiniteLightCount() const noexcept {
+    return static_cast<int>(this->infinite_light_indices.size());
+}
+
+std::tuple<Spectrum, float> Scene::getInfiniteLightEmission(int light_index, vec3<float> pos, const Ray &ray) const noexcept {
+    assert(light_index >= 0 && light_index < this->getInfiniteLightCount());
+
+    int index = this->infinite_light_indices[light_index];
+    const auto &light = this->light_sources[index];
+
+    float pd = light->getPdf(pos, ray.dir);
+    if(this->light_sample_count > 0) {
+        pd *= this->light_table.getProbability(index) * float(this->light_sample_count);
+    }
+
+    return std::make_tuple(light->getSpectrum(ray), pd);
+}
+
+int Scene::getLightSourceCount() const noexcept {
+    return static_cast<int>(this->light_sources.size());
+}
+
+std::tuple<EmissionSample, bool> Scene::sampleEmission(RandomEngine &re) const noexcept {
+    if(this->emitter_table.empty()) {
+        return std::make_tuple(EmissionSample{}, false);
+    }
+
+    // The side of two-sided emitters is drawn along with the object, so that every pair of dimensions is used by a single decision
+    auto [object_r, side_r] = re.getFloats<2>();
+    auto [object_index, selection_p] = this->emitter_table.sample(object_r);
+    const auto *object = this->object_light_sources[object_index];
+
+    vec3<float> pos;
+    float area_pd;
+    std::tie(pos, area_pd, std::ignore) = object->sampleSurface(re);
+    if(!(area_pd > 0.0F)) {
+        return std::make_tuple(EmissionSample{}, false);
+    }
+
+    auto n = object->getSurfaceNormal(pos);
+    assertNormalized(n);
+
+    // Cosine-weighted direction around the normal, flipped to the back face for surfaces emitting from both sides
+    auto [r1, r2] = re.getFloats<2>();
+    auto [local_dir, dir_pd] = impl::sampleCosineHemisphere(r1, r2);
+    auto side_n = n;
+    if(std::get<2>(object->getNormalBounds())) {
+        if(side_r < 0.5F) {
+            side_n = n * -1.0F;
+        }
+        dir_pd *= 0.5F;
+    }
+    auto dir = impl::toWorld(local_dir, side_n);
+
+    if(!(dir_pd > 0.0F)) {
+        return std::make_tuple(EmissionSample{}, false);
+    }
+
+    return std::make_tuple(EmissionSample{pos, n, dir, object, selection_p * area_pd, dir_pd}, true);
+}
+
+std::tuple<float, float> Scene::getEmissionPdf(const Object *object, vec3<float> pos, vec3<float> dir) const noexcept {
+    constexpr float pi = static_cast<float>(M_PI);
+
+    auto it = this->object_light_source_indices.find(object);
+    if(it == this->object_light_source_indices.end()) {
+        return std::make_tuple(0.0F, 0.0F);
+    }
+
+    auto area = object->getSurfaceArea();
+    if(!(area > 0.0F)) {
+        return std::make_tuple(0.0F, 0.0F);
+    }
+
+    auto pos_pd = this->emitter_table.getProbability(it->second) / area;
+
+    auto cos_theta = dot(object->getSurfaceNormal(pos), dir);
+    auto two_sided = std::get<2>(object->getNormalBounds());
+    auto dir_pd = two_sided ? 0.5F * std::abs(cos_theta) / pi : std::max(cos_theta, 0.0F) / pi;
+
+    return std::make_tuple(pos_pd, dir_pd);
 }
@@ -0,0 +1,173 @@
+#include <PathTrace/util/distribution.h>
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+#include <cmath>
+
+AliasTable::AliasTable(const std::vector<float> &weights) {
+    int count = static_cast<int>(weights.size());
+    if(count == 0) {
+        return;
+    }
+
+    // Accumulate in double precision to avoid losing small weights next to large ones
+    double total = std::accumulate(weights.begin(), weights.end(), 0.0);
+    assert(total > 0.0);
+
+    this->bins.resize(count);
+
+    std::vector<double> scaled(count);
+    std::vector<int> small;
+    std::vector<int> large;
+
+    for(int i = 0; i < count; i++) {
+        assert(weights[i] >= 0.0F);
+
+        this->bins[i].p = static_cast<float>(weights[i] / total);
+        this->bins[i].alias = i;
+
+        // Scale so that the average bin holds exactly 1
+        scaled[i] = weights[i] / total * count;
+
+        if(scaled[i] < 1.0) {
+            small.push_back(i);
+        }
+        else {
+            large.push_back(i);
+        }
+    }
+
+    // Fill each underfull bin with the excess of an overfull one
+    while(!small.empty() && !large.empty()) {
+        int s = small.back();
+        small.pop_back();
+        int l = large.back();
+
+        this->bins[s].threshold = static_cast<float>(scaled[s]);
+        this->bins[s].alias = l;
+
+        scaled[l] -= 1.0 - scaled[s];
+        if(scaled[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+
+    // Remaining bins are full up to rounding errors
+    for(int i : small) {
+        this->bins[i].threshold = 1.0F;
+        this->bins[i].alias = i;
+    }
+    for(int i : large) {
+        this->bins[i].threshold = 1.0F;
+        this->bins[i].alias = i;
+    }
+}
+
+int AliasTable::size() const noexcept {
+    return static_cast<int>(this->bins.size());
+}
+
+bool AliasTable::empty() const noexcept {
+    return this->bins.empty();
+}
+
+std::tuple<int, float> AliasTable::sample(float u) const noexcept {
+    assert(!this->bins.empty());
+
+    // Use the integer part of the scaled value to choose a bin, and the remainder to choose between the bin and its alias
+    float scaled = u * static_cast<float>(this->bins.size());
+    int index = std::min(static_cast<int>(scaled), static_cast<int>(this->bins.size()) - 1);
+    float remainder = scaled - static_cast<float>(index);
+
+    const Bin &bin = this->bins[index];
+    if(remainder >= bin.threshold) {
+        index = bin.alias;
+    }
+
+    return std::make_tuple(index, this->bins[index].p);
+}
+
+float AliasTable::getProbability(int index) const noexcept {
+    assert(index >= 0 && index < static_cast<int>(this->bins.size()));
+
+    return this->bins[index].p;
+}
+
+namespace impl {
+    // Builds the normalized cumulative distribution of the given weights, returning the sum of the weights
+    double buildCDF(const float *weights, int count, float *cdf) {
+        double sum = 0.0;
+
+        cdf[0] = 0.0F;
+        for(int i = 0; i < count; i++) {
+            sum += weights[i];
+            cdf[i + 1] = static_cast<float>(sum);
+        }
+
+        // Without any weight, fall back to a uniform distribution
+        for(int i = 1; i <= count; i++) {
+            cdf[i] = sum > 0.0 ? static_cast<float>(cdf[i] / sum) : static_cast<float>(i) / static_cast<float>(count);
+        }
+        cdf[count] = 1.0F;
+
+        return sum;
+    }
+
+    // Samples a piecewise constant distribution given its cumulative distribution,
+    //  returning the sampled position in range [0, 1) and the index of the chosen piece
+    std::tuple<float, int> sampleCDF(const float *cdf, int count, float u) {
+        // Find the last piece whose cumulative value does not exceed u
+        const float *it = std::upper_bound(cdf, cdf + count + 1, u);
+        int index = std::clamp(static_cast<int>(it - cdf) - 1, 0, count - 1);
+
+        float width = cdf[index + 1] - cdf[index];
+        float offset = width > 0.0F ? std::clamp((u - cdf[index]) / width, 0.0F, 1.0F) : 0.5F;
+
+        float pos = (static_cast<float>(index) + offset) / static_cast<float>(count);
+
+        return std::make_tuple(std::min(pos, std::nextafter(1.0F, 0.0F)), index);
+    }
+}
+
+Distribution2D::Distribution2D(const std::vector<float> &weights, int width, int height) :
+  width(width), height(height), densities(weights.size()), conditional_cdfs((width + 1) * height), marginal_cdf(height + 1) {
+    assert(static_cast<int>(weights.size()) == width * height);
+
+    std::vector<float> row_sums(height);
+    for(int y = 0; y < height; y++) {
+        row_sums[y] = static_cast<float>(impl::buildCDF(&weights[y * width], width, &this->conditional_cdfs[y * (width + 1)]));
+    }
+
+    double total = impl::buildCDF(row_sums.data(), height, this->marginal_cdf.data());
+
+    // Densities with respect to the unit square are the weights divided by their mean
+    for(int i = 0; i < width * height; i++) {
+        assert(weights[i] >= 0.0F);
+
+        this->densities[i] = total > 0.0 ? static_cast<float>(weights[i] * width * height / total) : 1.0F;
+    }
+}
+
+bool Distribution2D::empty() const noexcept {
+    return this->densities.empty();
+}
+
+std::tuple<float, float, float> Distribution2D::sample(float u1, float u2) const noexcept {
+    assert(!this->empty());
+
+    auto [y, row] = impl::sampleCDF(this->marginal_cdf.data(), this->height, u2);
+    auto [x, column] = impl::sampleCDF(&this->conditional_cdfs[row * (this->width + 1)], this->width, u1);
+
+    return std::make_tuple(x, y, this->densities[row * this->width + column]);
+}
+
+float Distribution2D::getPdf(float x, float y) const noexcept {
+    assert(!this->empty());
+
+    int column = std::clamp(static_cast<int>(x * static_cast<float>(this->width)), 0, this->width - 1);
+    int row = std::clamp(static_cast<int>(y * static_cast<float>(this->height)), 0, this->height - 1);
+
+    return this->densities[row * this->width + column];
+}
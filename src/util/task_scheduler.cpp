@@ -0,0 +1,219 @@
+#include <PathTrace/util/task_scheduler.h>
+#include <PathTrace/base.h>
+
+#include <algorithm>
+#include <cassert>
+
+WorkStealingDeque::Buffer::Buffer(std::int64_t capacity) : capacity(capacity), tasks(std::make_unique<std::atomic<int>[]>(capacity)) {}
+
+WorkStealingDeque::WorkStealingDeque(int capacity) {
+    this->buffers.push_back(std::make_unique<Buffer>(std::max(capacity, 1)));
+    this->buffer.store(this->buffers.back().get(), std::memory_order_relaxed);
+}
+
+void WorkStealingDeque::push(int task) {
+    assert(task >= 0);
+
+    auto b = this->bottom.load(std::memory_order_relaxed);
+    auto t = this->top.load(std::memory_order_acquire);
+    Buffer *current = this->buffer.load(std::memory_order_relaxed);
+
+    // Grow by copying the remaining tasks into a buffer of twice the capacity, at the same indices modulo the capacity
+    if(b - t > current->capacity - 1) {
+        this->buffers.push_back(std::make_unique<Buffer>(2 * current->capacity));
+        Buffer *grown = this->buffers.back().get();
+
+        for(auto i = t; i < b; i++) {
+            grown->tasks[i % grown->capacity].store(current->tasks[i % current->capacity].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+
+        this->buffer.store(grown, std::memory_order_release);
+        current = grown;
+    }
+
+    current->tasks[b % current->capacity].store(task, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    this->bottom.store(b + 1, std::memory_order_relaxed);
+}
+
+int WorkStealingDeque::pop() noexcept {
+    auto b = this->bottom.load(std::memory_order_relaxed) - 1;
+    Buffer *current = this->buffer.load(std::memory_order_relaxed);
+    this->bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto t = this->top.load(std::memory_order_relaxed);
+
+    if(t > b) {
+        this->bottom.store(b + 1, std::memory_order_relaxed);
+        return empty;
+    }
+
+    int task = current->tasks[b % current->capacity].load(std::memory_order_relaxed);
+    if(t == b) {
+        // The last task may be stolen concurrently, in which case the thief wins
+        if(!this->top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            task = empty;
+        }
+        this->bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    return task;
+}
+
+std::tuple<int, bool> WorkStealingDeque::steal() noexcept {
+    auto t = this->top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto b = this->bottom.load(std::memory_order_acquire);
+
+    if(t >= b) {
+        return std::make_tuple(empty, true);
+    }
+
+    Buffer *current = this->buffer.load(std::memory_order_acquire);
+    int task = current->tasks[t % current->capacity].load(std::memory_order_relaxed);
+    if(!this->top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return std::make_tuple(empty, false);
+    }
+
+    return std::make_tuple(task, false);
+}
+
+TaskScheduler::TaskScheduler(int worker_count) :
+  worker_count(worker_count > 0 ? worker_count : std::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 1)),
+  deques(std::make_unique<WorkStealingDeque[]>(this->worker_count)) {
+    this->threads.reserve(this->worker_count - 1);
+    for(int worker = 1; worker < this->worker_count; worker++) {
+        this->threads.emplace_back(&TaskScheduler::runThread, this, worker);
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stopping = true;
+    }
+    this->start_condition.notify_all();
+
+    for(auto &thread : this->threads) {
+        thread.join();
+    }
+}
+
+int TaskScheduler::getWorkerCount() const noexcept {
+    return this->worker_count;
+}
+
+void TaskScheduler::runThread(int worker) {
+    std::uint64_t finished_run_count = 0;
+
+    for(;;) {
+        const std::function<void(int, int)> *run_function = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->start_condition.wait(lock, [&]() { return this->stopping || this->run_count != finished_run_count; });
+
+            if(this->stopping) {
+                return;
+            }
+
+            finished_run_count = this->run_count;
+            run_function = this->function;
+        }
+
+        this->runWorker(worker, *run_function);
+
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+
+            if(--this->running_thread_count == 0) {
+                this->finish_condition.notify_one();
+            }
+        }
+    }
+}
+
+void TaskScheduler::runWorker(int worker, const std::function<void(int, int)> &function) {
+    auto &deque = this->deques[worker];
+
+    // Victims are chosen randomly, so that idle workers do not all steal from the same one
+    xorshift victim_engine(static_cast<std::uint64_t>(worker) + 1);
+
+    auto steal = [&]() {
+        if(this->worker_count > 1) {
+            for(int attempt = 0; attempt < this->worker_count; attempt++) {
+                auto victim = static_cast<int>(victim_engine() % static_cast<std::uint32_t>(this->worker_count - 1));
+                victim += victim >= worker ? 1 : 0;
+
+                auto [task, is_empty] = this->deques[victim].steal();
+                if(task != WorkStealingDeque::empty) {
+                    return task;
+                }
+            }
+        }
+
+        // No tasks are added while running, so the workers are done once all deques are found to be empty
+        for(;;) {
+            bool all_empty = true;
+            for(int victim = 0; victim < this->worker_count; victim++) {
+                if(victim == worker) {
+                    continue;
+                }
+
+                auto [task, is_empty] = this->deques[victim].steal();
+                if(task != WorkStealingDeque::empty) {
+                    return task;
+                }
+                all_empty = all_empty && is_empty;
+            }
+
+            if(all_empty) {
+                return WorkStealingDeque::empty;
+            }
+        }
+    };
+
+    for(;;) {
+        int task = deque.pop();
+        if(task == WorkStealingDeque::empty) {
+            task = steal();
+            if(task == WorkStealingDeque::empty) {
+                break;
+            }
+        }
+
+        function(task, worker);
+    }
+}
+
+void TaskScheduler::run(int task_count, const std::function<void(int, int)> &function) {
+    if(task_count <= 0) {
+        return;
+    }
+
+    // Tasks are pushed in descending order, so that each worker pops its range in ascending order and thieves take its last tasks
+    // Pushing into the deques of other workers is the one exception to pushes by the owner, as no worker accesses them in between runs
+    for(int worker = 0; worker < this->worker_count; worker++) {
+        auto begin = static_cast<int>(static_cast<std::int64_t>(task_count) * worker / this->worker_count);
+        auto end = static_cast<int>(static_cast<std::int64_t>(task_count) * (worker + 1) / this->worker_count);
+
+        for(int task = end - 1; task >= begin; task--) {
+            this->deques[worker].push(task);
+        }
+    }
+
+    // Publishing the run through the mutex also publishes the pushed tasks to the threads owning the deques
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->function = &function;
+        this->run_count++;
+        this->running_thread_count = static_cast<int>(this->threads.size());
+    }
+    this->start_condition.notify_all();
+
+    this->runWorker(0, function);
+
+    // Other workers may still be running the last tasks they stole
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->finish_condition.wait(lock, [&]() { return this->running_thread_count == 0; });
+    this->function = nullptr;
+}
@@ -1,157 +1,1299 @@
 #include <PathTrace/worker.h>
+#include <PathTrace/metropolis.h>
+#include <PathTrace/util/distribution.h>
+#include <PathTrace/util/task_scheduler.h>
 
 #include <cassert>
 #include <cmath>
-#include <thread>
 #include <condition_variable>
 #include <atomic>
-#include <queue>
+#include <mutex>
+#include <array>
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+#include <numeric>
 
 namespace impl {
+    // Counters from which the seeds of the stages of a render are derived, so that each stage uses independent random numbers
+    constexpr std::uint64_t guide_training_seed_stream = 1;
+    constexpr std::uint64_t radiance_cache_training_seed_stream = 2;
+    constexpr std::uint64_t photon_seed_stream = 3;
+    constexpr std::uint64_t metropolis_seed_stream = 4;
+    constexpr std::uint64_t tile_seed_stream = 5;
+
+    // Number of photons traced using random numbers derived from the same seed
+    constexpr int photon_batch_size = 4096;
+
+    // Number of bootstrap samples of Metropolis light transport evaluated by each task
+    constexpr int bootstrap_batch_size = 1024;
+
+    // Scale of the fixed-point sums of splat images, and the largest scaled contribution added at once
+    constexpr double splat_scale = 4294967296.0;
+    constexpr double max_splat_value = 9007199254740992.0;
+
+    // Dimensions of the numbers of a pixel sample, such that every decision draws from the same dimensions in all samples of the pixel,
+    //  no matter how many numbers the decisions before it consumed
+    // The position in the pixel takes dimensions 0-1 and the aperture 2-3, which are followed by the emission sample of bidirectional
+    //  path tracing and a block of dimensions for each vertex of the path
+    constexpr std::uint32_t camera_dimension_count = 4;
+
+    // Offsets of the decisions within the block of a vertex, which are followed by the dimensions of the light samples
+    constexpr std::uint32_t roulette_dimension = 0;
+    constexpr std::uint32_t guiding_dimension = 1;
+    constexpr std::uint32_t scattering_dimension = 2;
+    constexpr std::uint32_t vertex_decision_dimension_count = 4;
+
+    struct DimensionLayout {
+        //! First dimension of the emission sample starting the light subpath, only used by bidirectional path tracing
+        std::uint32_t emission;
+        //! First dimension of the block of the first vertex after the camera
+        std::uint32_t first_vertex;
+        //! Number of dimensions of the block of each vertex
+        std::uint32_t vertex_stride;
+        //! Offset of the decisions of the vertex of the light subpath at the same depth within the block of a vertex
+        std::uint32_t light_subpath;
+
+        std::uint32_t getVertex(int index) const { return this->first_vertex + static_cast<std::uint32_t>(index) * this->vertex_stride; }
+    };
+
+    DimensionLayout getDimensionLayout(const WorkItem &item, bool bidirectional) {
+        const auto &options = item.job->options;
+
+        // Resampled direct lighting draws a light sample for every candidate, while bidirectional path tracing samples all light sources at once
+        int light_sample_count = item.job->scene.getMaxLightSampleCount();
+        if(options.direct_lighting == DirectLighting::Resampled && !bidirectional) {
+            light_sample_count = std::max(options.resampling_candidate_count, 1);
+        }
+        std::uint32_t light_subpath = vertex_decision_dimension_count + static_cast<std::uint32_t>(light_sample_count) * Scene::light_sample_dimension_count;
+
+        if(!bidirectional) {
+            return {camera_dimension_count, camera_dimension_count, light_subpath, light_subpath};
+        }
+
+        return {camera_dimension_count, camera_dimension_count + Scene::emission_sample_dimension_count, light_subpath + vertex_decision_dimension_count,
+                light_subpath};
+    }
+
+    float getContribution(Color<float> color) {
+        return /* color[3] * */ (color[0] + color[1] + color[2]) / 3.0F;
+    }
+
+    float getContribution(Spectrum spectrum) {
+        auto color = spectrum.getColor();
+
+        return getContribution(color);
+    }
+
+    bool isNonNegative(Spectrum spectrum) {
+        return isNonNegative(spectrum.getColor());
+    }
+
+    // Weight of a sample using the power heuristic for multiple importance sampling with one other strategy
+    // Computed in double precision since densities of nearly grazing light samples may be very large
+    float getPowerHeuristic(float pd, float other_pd) {
+        double pd2 = static_cast<double>(pd) * pd;
+        double other_pd2 = static_cast<double>(other_pd) * other_pd;
+
+        if(!(pd2 + other_pd2 > 0.0)) {
+            return 0.0F;
+        }
+        if(std::isinf(pd2)) {
+            return 1.0F;
+        }
+
+        return static_cast<float>(pd2 / (pd2 + other_pd2));
+    }
+
+    // Weight of emission found by BSDF sampling, given the densities of BSDF sampling and light sampling generating the same direction
+    // A BSDF density of 0 indicates that the direction could not have been generated by light sampling
+    float getEmissionWeight(const WorkItem &item, float bsdf_pd, float light_pd) {
+        if(!(bsdf_pd > 0.0F)) {
+            return 1.0F;
+        }
+
+        if(item.job->options.direct_lighting == DirectLighting::Resampled || !item.job->options.multiple_importance_sampling) {
+            // Resampled direct lighting has no tractable density, so it accounts for all emission it can sample, like light sampling without MIS
+            return light_pd > 0.0F ? 0.0F : 1.0F;
+        }
+
+        return getPowerHeuristic(bsdf_pd, light_pd);
+    }
+
+    // Path guiding is only applied at vertices whose BSDF has a density that guided sampling can be combined with
+    bool isGuided(const WorkItem &item, const BSDF *bsdf) {
+        return item.path_guide != nullptr && item.path_guide->isTrained() && !bsdf->isDiscrete();
+    }
+
+    // Density of sampling the outgoing ray at a vertex, which mixes the densities of the BSDF and the path guide if guiding is applied
+    float getScatteringPdf(const WorkItem &item, const Ray &ray, const Ray &next_ray, vec3<float> pos, vec3<float> n, const BSDF *bsdf,
+                           const Material *material) {
+        float bsdf_pd = bsdf->getPdf(ray, next_ray, pos, n, material);
+        if(!isGuided(item, bsdf)) {
+            return bsdf_pd;
+        }
+
+        float guiding_probability = item.job->options.guiding_probability;
+
+        return guiding_probability * item.path_guide->getPdf(pos, next_ray.dir) + (1.0F - guiding_probability) * bsdf_pd;
+    }
+
+    // Vertex of a path at which the radiance arriving along the next ray is recorded into the path guide
+    struct GuideRecord {
+        vec3<float> pos;
+        vec3<float> dir;
+        //! Probability density of sampling the direction
+        float pd;
+        //! Throughput of the path up to and including the scattering at the vertex
+        float throughput;
+        //! Contribution of the path before continuing along the direction
+        float previous_contribution;
+    };
+
+    thread_local std::vector<GuideRecord> guide_records;
+
+    // Vertex of a path at which the reflected radiance found along the rest of the path is recorded into the radiance cache
+    struct CacheRecord {
+        vec3<float> pos;
+        vec3<float> n;
+        //! Throughput of the path up to the vertex, excluding the scattering at the vertex
+        Color<float> throughput;
+        //! Contribution of the path including the emission at the vertex
+        Color<float> previous_contribution;
+    };
+
+    thread_local std::vector<CacheRecord> cache_records;
+
+    // Scratch buffer for light samples, which is reused across path vertices to avoid allocations
+    thread_local std::vector<LightSample> light_sample_buffer;
+
+    // Computes the contribution of a light sample to the radiance leaving along the reversed incoming ray, ignoring occlusion
+    // The contribution is not divided by the probability density of the light sample
+    std::tuple<Spectrum, Ray> getUnoccludedContribution(const Ray &ray, vec3<float> pos, vec3<float> n, const BSDF *bsdf, const Material *material,
+                                                        const LightSample &sample, float epsilon) {
+        assert(sample.pd >= 0.0F);
+        assertNonNegative(sample.spectrum);
+
+        auto light_dir = (sample.pos - pos).normalize();
+        Ray light_ray = {pos + light_dir * epsilon, light_dir};
+
+        auto [base_spectrum, shading_factor, shadow_ray_pd] = bsdf->getSpectrum(ray, light_ray, pos, n, sample.spectrum, material, true);
+        assert(shading_factor >= 0.0F && shading_factor <= 1.0F);
+        assert(shadow_ray_pd >= 0.0F);
+        assertNonNegative(base_spectrum);
+
+        if(!(shadow_ray_pd > 0.0F)) {
+            return std::make_tuple(Spectrum{}, light_ray);
+        }
+
+        return std::make_tuple(base_spectrum * (shading_factor / shadow_ray_pd), light_ray);
+    }
+
+    // Small direct-mapped cache of the object that last occluded a shadow ray towards each light,
+    //  exploiting that neighboring shadow rays towards the same light are often blocked by the same object
+    struct OccluderCache {
+        static constexpr int size = 64;
+
+        std::array<const Object *, size> occluders;
+        std::int64_t shadow_ray_count;
+        std::int64_t hit_count;
+
+        void clear() {
+            this->occluders.fill(nullptr);
+            this->shadow_ray_count = 0;
+            this->hit_count = 0;
+        }
+    };
+
+    // The cache is cleared for every tile, since cached objects are only valid while the scene of a job exists
+    thread_local OccluderCache occluder_cache;
+
+    bool isUnoccluded(const Scene &scene, const Ray &light_ray, vec3<float> pos, const LightSample &sample, float epsilon) {
+        // The shadow ray starts epsilon along the way, so the light itself is hit at a distance of about length - epsilon,
+        //  and rounding errors must not count that as an occlusion
+        float max_t = (sample.pos - pos).getLength() - 2.0F * epsilon;
+
+        occluder_cache.shadow_ray_count++;
+
+        // Any intersection in front of the light is an occlusion, so the cached object can be tested on its own
+        const Object *&cached_occluder = occluder_cache.occluders[static_cast<unsigned int>(sample.light_id) % OccluderCache::size];
+        if(cached_occluder != nullptr) {
+            float cached_t = cached_occluder->getIntersection(light_ray);
+            if(cached_t >= 0.0F && cached_t < max_t) {
+                occluder_cache.hit_count++;
+                return false;
+            }
+        }
+
+        auto [light_t, occluder] = scene.getIntersection(light_ray);
+        if(light_t < 0.0F || light_t >= max_t) {
+            return true;
+        }
+
+        cached_occluder = occluder;
+        return false;
+    }
+
+    // Estimates direct lighting by sampling every light source and several emissive objects,
+    //  weighting the samples of emissive objects against BSDF sampling unless the path does not continue by sampling the BSDF
+    Spectrum getDirectLighting(const WorkItem &item, const Ray &ray, vec3<float> pos, vec3<float> n, const BSDF *bsdf, const Material *material,
+                               RandomEngine &re, bool bsdf_sampled = true) {
+        const auto epsilon = item.job->options.epsilon;
+
+        Spectrum direct_spectrum;
+
+        int light_count = item.job->scene.sampleLights(pos, n, re, light_sample_buffer);
+        for(int light_index = 0; light_index < light_count; light_index++) {
+            const auto &sample = light_sample_buffer[light_index];
+
+            auto [contribution, light_ray] = getUnoccludedContribution(ray, pos, n, bsdf, material, sample, epsilon);
+            if(!(getContribution(contribution) > 0.0F)) {
+                continue;
+            }
+
+            if(!isUnoccluded(item.job->scene, light_ray, pos, sample, epsilon)) {
+                continue;
+            }
+
+            float light_weight = 1.0F;
+            if(sample.bsdf_reachable && bsdf_sampled && item.job->options.multiple_importance_sampling) {
+                light_weight = getPowerHeuristic(sample.pd, getScatteringPdf(item, ray, light_ray, pos, n, bsdf, material));
+            }
+
+            auto weighed_spectrum = contribution * (light_weight / sample.pd);
+            assertNonNegative(weighed_spectrum);
+
+            direct_spectrum = direct_spectrum + weighed_spectrum;
+        }
+
+        return direct_spectrum;
+    }
+
+    // Estimates direct lighting using resampled importance sampling, where many light candidates are drawn
+    //  and a single one is chosen proportionally to its unoccluded contribution using a weighted reservoir,
+    //  so that only one shadow ray needs to be traced
+    Spectrum getResampledDirectLighting(const WorkItem &item, const Ray &ray, vec3<float> pos, vec3<float> n, const BSDF *bsdf,
+                                        const Material *material, RandomEngine &re) {
+        const auto epsilon = item.job->options.epsilon;
+        const auto candidate_count = std::max(item.job->options.resampling_candidate_count, 1);
+
+        // Reservoir holding the chosen candidate
+        LightSample chosen_sample{};
+        Spectrum chosen_contribution;
+        Ray chosen_ray{};
+        float chosen_target = 0.0F;
+        float weight_sum = 0.0F;
+
+        // Every candidate takes the dimensions of a light sample, while the reservoir draws a varying number of numbers
+        auto dimension = re.getDimension();
+        for(int candidate = 0; candidate < candidate_count; candidate++) {
+            re.setDimension(dimension + static_cast<std::uint32_t>(candidate) * Scene::light_sample_dimension_count);
+            auto [sample, valid] = item.job->scene.sampleLight(pos, n, re);
+            if(!valid || !(sample.pd > 0.0F)) {
+                continue;
+            }
+
+            auto [contribution, light_ray] = getUnoccludedContribution(ray, pos, n, bsdf, material, sample, epsilon);
+
+            float target = getContribution(contribution);
+            if(!(target > 0.0F)) {
+                continue;
+            }
+
+            float weight = target / sample.pd;
+            weight_sum += weight;
+
+            if(re.getIndependentFloats<1>()[0] * weight_sum < weight) {
+                chosen_sample = sample;
+                chosen_contribution = contribution;
+                chosen_ray = light_ray;
+                chosen_target = target;
+            }
+        }
+
+        if(!(chosen_target > 0.0F)) {
+            return {};
+        }
+
+        if(!isUnoccluded(item.job->scene, chosen_ray, pos, chosen_sample, epsilon)) {
+            return {};
+        }
+
+        return chosen_contribution * (weight_sum / (static_cast<float>(candidate_count) * chosen_target));
+    }
+
+    // Probability of continuing a path after a vertex using russian roulette, which is proportional to the throughput of the path,
+    //  so that the paths surviving the roulette carry similar weights
+    float getBounceProbability(const RenderOptions &options, int path_length, Spectrum spectrum, double divisor) {
+        if(options.max_path_length > 0 && path_length >= options.max_path_length) {
+            return 0.0F;
+        }
+        if(path_length <= options.russian_roulette_min_length) {
+            return 1.0F;
+        }
+
+        float throughput = getContribution(spectrum) / static_cast<float>(divisor);
+        if(!(throughput > 0.0F)) {
+            return 0.0F;
+        }
+
+        return std::clamp(throughput, std::clamp(options.russian_roulette_min_probability, 0.0F, 1.0F), 1.0F);
+    }
+
+    std::tuple<Spectrum, bool> getSample(const WorkItem &item, float x_camera, float y_camera, RandomEngine &re) {
+        // Sensor coordinates span [-1, 1], so that a pixel covers 2 / width of them, which light subpaths of BDPT are connected to as well
+        const auto pixel_width = 2.0F / static_cast<float>(item.job->options.image_width);
+        const auto pixel_height = 2.0F / static_cast<float>(item.job->options.image_height);
+
+        const auto epsilon = item.job->options.epsilon;
+
+        auto max_light_count = static_cast<std::size_t>(item.job->scene.getMaxLightSampleCount());
+        if(light_sample_buffer.size() < max_light_count) {
+            light_sample_buffer.resize(max_light_count);
+        }
+
+        guide_records.clear();
+        cache_records.clear();
+
+        const auto layout = getDimensionLayout(item, false);
+
+        Ray ray = item.job->camera.shootRay(x_camera, y_camera, pixel_width, pixel_height, re);
+        assertNormalized(ray.dir);
+
+        bool sample_collected = false;
+        double sample_divisor = 1.0F;
+        double sample_bounce_pd = 1.0;
+        Spectrum sample_spectrum = {Color<float>(1.0F, 1.0F, 1.0F, 1.0F)};
+        Spectrum out_spectrum;
+        int path_length = 0;
+
+        // Position, normal and BSDF sampling density of the previous vertex, used to weight emission found by BSDF sampling
+        // A density of 0 indicates that the previous direction could not have been generated by light sampling
+        vec3<float> previous_pos;
+        vec3<float> previous_n;
+        float previous_bsdf_pd = 0.0F;
+        for(;;) {
+            auto [t, object] = item.job->scene.getIntersection(ray);
+
+            if(t < static_cast<float>(0)) {
+                // Rays escaping the scene collect the emission of infinite light sources
+                int infinite_light_count = item.job->scene.getInfiniteLightCount();
+                for(int light_index = 0; light_index < infinite_light_count; light_index++) {
+                    auto [emission, light_pd] = item.job->scene.getInfiniteLightEmission(light_index, previous_pos, ray);
+                    float emission_weight = getEmissionWeight(item, previous_bsdf_pd, light_pd);
+
+                    assert(sample_bounce_pd > 0.0);
+                    out_spectrum = out_spectrum + sample_spectrum * emission * (emission_weight / static_cast<float>(sample_divisor * sample_bounce_pd));
+                }
+
+                if(infinite_light_count > 0) {
+                    sample_collected = true;
+                }
+                break;
+            }
+            path_length++;
+
+            sample_collected = true;
+
+            auto pos = ray.origin + ray.dir * t;
+            auto n = object->getSurfaceNormal(pos);
+            assertNormalized(n);
+
+            const auto *material_handler = object->getMaterialHandler();
+            const auto *material = material_handler->getMaterial(pos);
+            const auto *bsdf = material_handler->getBSDF(pos);
+
+            auto emission = material->getEmission(ray, pos);
+            if(getContribution(emission) > 0.0F) {
+                float emission_weight = 1.0F;
+                if(previous_bsdf_pd > 0.0F) {
+                    auto light_pd = item.job->scene.getLightPdf(previous_pos, previous_n, object, pos);
+                    emission_weight = getEmissionWeight(item, previous_bsdf_pd, light_pd);
+                }
+
+                assert(sample_bounce_pd > 0.0);
+                out_spectrum = out_spectrum + sample_spectrum * emission * (emission_weight / static_cast<float>(sample_divisor * sample_bounce_pd));
+            }
+
+            if(item.radiance_cache != nullptr && !bsdf->isDiscrete()) {
+                // Light reflected after a diffuse bounce varies slowly, so the path is terminated using the cached light
+                if(previous_bsdf_pd > 0.0F) {
+                    auto [cached_radiance, cache_hit] = item.radiance_cache->get(pos, n);
+                    if(cache_hit) {
+                        out_spectrum = out_spectrum + sample_spectrum * Spectrum{cached_radiance} / static_cast<float>(sample_divisor * sample_bounce_pd);
+                        break;
+                    }
+                }
+
+                if(item.record_radiance_cache) {
+                    auto throughput = (sample_spectrum / static_cast<float>(sample_divisor * sample_bounce_pd)).getColor();
+                    cache_records.push_back({pos, n, throughput, out_spectrum.getColor()});
+                }
+            }
+
+            float bounce_probability = getBounceProbability(item.job->options, path_length, sample_spectrum, sample_divisor * sample_bounce_pd);
+            assert(bounce_probability >= 0.0F && bounce_probability <= 1.0F);
+
+            auto vertex_dimension = layout.getVertex(path_length - 1);
+            re.setDimension(vertex_dimension + roulette_dimension);
+            bool do_bounce = re.getFloat() < bounce_probability;
+            bool sample_light_sources = true; // !do_bounce;
+
+            if(sample_light_sources) {
+                re.setDimension(vertex_dimension + vertex_decision_dimension_count);
+                Spectrum direct_spectrum;
+                if(item.job->options.direct_lighting == DirectLighting::Resampled) {
+                    direct_spectrum = getResampledDirectLighting(item, ray, pos, n, bsdf, material, re);
+                }
+                else {
+                    // Once the path cannot continue, emission is only found by sampling the lights, so their samples are not weighted
+                    direct_spectrum = getDirectLighting(item, ray, pos, n, bsdf, material, re, bounce_probability > 0.0F);
+                }
+
+                assert(sample_bounce_pd >= 0.0);
+                out_spectrum = out_spectrum + sample_spectrum * direct_spectrum / static_cast<float>(sample_divisor * sample_bounce_pd);
+            }
+
+            if(!do_bounce) {
+                sample_bounce_pd *= 1.0F - bounce_probability;
+                break;
+            }
+            sample_bounce_pd *= bounce_probability;
+
+            if(sample_bounce_pd <= 1E-20) {
+                break;
+            }
+
+            // Generate next ray
+            Ray next_ray{};
+            if(isGuided(item, bsdf)) {
+                // Choose between sampling the path guide and the BSDF, weighting the sample by the density of the mixture of both
+                re.setDimension(vertex_dimension + guiding_dimension);
+                bool guided = re.getFloat() < item.job->options.guiding_probability;
+
+                re.setDimension(vertex_dimension + scattering_dimension);
+                if(guided) {
+                    auto [r1, r2] = re.getFloats<2>();
+                    auto guided_dir = std::get<0>(item.path_guide->sample(pos, r1, r2));
+                    next_ray = {pos + guided_dir * epsilon, guided_dir};
+                }
+                else {
+                    next_ray = std::get<0>(bsdf->propagateRay(ray, pos, n, epsilon, re, material));
+                }
+                assertNormalized(next_ray.dir);
+
+                float scattering_pd = getScatteringPdf(item, ray, next_ray, pos, n, bsdf, material);
+
+                auto [shaded_spectrum, shading_factor, shading_pd] = bsdf->getSpectrum(ray, next_ray, pos, n, sample_spectrum, material, true);
+                assert(shading_factor >= 0.0F && shading_factor <= 1.0F);
+                if(!(scattering_pd > 0.0F) || !(shading_factor > 0.0F) || !(shading_pd > 0.0F)) {
+                    break;
+                }
+
+                previous_pos = pos;
+                previous_n = n;
+                previous_bsdf_pd = scattering_pd;
+
+                sample_divisor *= scattering_pd * shading_pd;
+                sample_divisor /= shading_factor;
+                sample_spectrum = shaded_spectrum;
+                assertNonNegative(sample_spectrum);
+            }
+            else {
+                re.setDimension(vertex_dimension + scattering_dimension);
+                auto [propagated_ray, ray_factor, ray_pd] = bsdf->propagateRay(ray, pos, n, epsilon, re, material);
+                assertNormalized(propagated_ray.dir);
+                assert(ray_pd > 0.0F);
+                next_ray = propagated_ray;
+
+                previous_pos = pos;
+                previous_n = n;
+                previous_bsdf_pd = bsdf->getPdf(ray, next_ray, pos, n, material);
+
+                sample_divisor *= ray_pd;
+                sample_divisor /= ray_factor;
+
+                auto [shaded_spectrum, shading_factor, shading_pd] = bsdf->getSpectrum(ray, next_ray, pos, n, sample_spectrum, material, false);
+                assert(shading_pd > 0.0F);
+                assert(shading_factor >= 0.0F && shading_factor <= 1.0F);
+                sample_divisor *= shading_pd;
+                sample_divisor /= shading_factor;
+                sample_spectrum = shaded_spectrum;
+                assertNonNegative(sample_spectrum);
+            }
+
+            if(sample_divisor <= 1E-20) {
+                break;
+            }
+
+            if(item.record_path_guide && !bsdf->isDiscrete() && previous_bsdf_pd > 0.0F) {
+                float throughput = getContribution(sample_spectrum) / static_cast<float>(sample_divisor * sample_bounce_pd);
+                guide_records.push_back({pos, next_ray.dir, previous_bsdf_pd, throughput, getContribution(out_spectrum)});
+            }
+
+            ray = next_ray;
+        }
+
+        if(item.record_path_guide) {
+            // The radiance arriving at each vertex is the contribution found after it, divided by the throughput up to the vertex
+            float contribution = getContribution(out_spectrum);
+            for(const GuideRecord &record : guide_records) {
+                if(!(record.throughput > 0.0F)) {
+                    continue;
+                }
+
+                float radiance = std::max(contribution - record.previous_contribution, 0.0F) / record.throughput;
+                item.path_guide->record(record.pos, record.dir, radiance / record.pd);
+            }
+        }
+
+        if(item.record_radiance_cache) {
+            // The radiance reflected at each vertex is the contribution found after it, divided by the throughput up to the vertex
+            auto contribution = out_spectrum.getColor();
+            for(const CacheRecord &record : cache_records) {
+                Color<float> radiance = {0.0F, 0.0F, 0.0F, 0.0F};
+                for(int channel = 0; channel < 3; channel++) {
+                    if(record.throughput[channel] > 0.0F) {
+                        radiance[channel] = std::max(contribution[channel] - record.previous_contribution[channel], 0.0F) / record.throughput[channel];
+                    }
+                }
+
+                item.radiance_cache->record(record.pos, record.n, radiance);
+            }
+        }
+
+        auto out_color = out_spectrum.getColor();
+        out_color[3] = sample_collected ? 1.0F : 0.0F;
+        out_spectrum = {out_color};
+
+        return std::make_tuple(out_spectrum, sample_collected);
+    }
+
+    // Longest subpath traced from the camera or a light by bidirectional path tracing, in vertices including its origin
+    constexpr int max_subpath_vertex_count = 64;
+
+    enum class VertexType { Camera, Light, Surface };
+
+    // Vertex of a subpath traced from the camera or a light by bidirectional path tracing
+    struct PathVertex {
+        VertexType type;
+        vec3<float> pos;
+        //! Surface normal, which is unused for the camera vertex
+        vec3<float> n;
+        //! Ray along which the vertex was reached, which is unused for the first vertex of a subpath
+        Ray ray;
+        const Object *object;
+        const Material *material;
+        const BSDF *bsdf;
+        //! Throughput of the subpath up to the vertex, divided by the probability density of sampling it
+        Spectrum beta;
+        //! Probability density with respect to area of sampling the vertex from the previous vertex of its subpath
+        float pdf_fwd;
+        //! Probability density with respect to area of sampling the vertex from the next vertex, as if the path was traced in reverse
+        float pdf_rev;
+        //! Whether the vertex can not be connected to other vertices, since it only scatters into discrete directions
+        bool discrete;
+    };
+
+    thread_local std::vector<PathVertex> camera_vertices;
+    thread_local std::vector<PathVertex> light_vertices;
+
+    // Converts a probability density with respect to solid angle at a position into a density with respect to area at a vertex
+    float convertToArea(float pdf_dir, vec3<float> from, const PathVertex &to) {
+        auto offset = to.pos - from;
+        auto distance2 = offset.getLengthSquared();
+        if(!(distance2 > 0.0F)) {
+            return 0.0F;
+        }
+
+        // The camera is a point, which has no surface to project onto
+        if(to.type == VertexType::Camera) {
+            return pdf_dir / distance2;
+        }
+
+        return pdf_dir * std::abs(dot(to.n, offset)) / (distance2 * std::sqrt(distance2));
+    }
+
+    // Probability density with respect to area of sampling the next vertex from a vertex that was reached from the previous vertex
+    float getVertexPdf(const WorkItem &item, const PathVertex *previous, const PathVertex &vertex, const PathVertex &next) {
+        auto dir = (next.pos - vertex.pos).normalize();
+
+        float pdf_dir = 0.0F;
+        switch(vertex.type) {
+            case VertexType::Camera:
+                pdf_dir = std::get<2>(item.job->camera.projectDirection(dir));
+                break;
+            case VertexType::Light:
+                pdf_dir = std::get<1>(item.job->scene.getEmissionPdf(vertex.object, vertex.pos, dir));
+                break;
+            case VertexType::Surface:
+                assert(previous != nullptr);
+                pdf_dir =
+                  vertex.bsdf->getPdf({previous->pos, (vertex.pos - previous->pos).normalize()}, {vertex.pos, dir}, vertex.pos, vertex.n, vertex.material);
+                break;
+        }
+
+        return convertToArea(pdf_dir, vertex.pos, next);
+    }
+
+    // Emission leaving a point on an emissive object in a direction
+    Spectrum getEmittedSpectrum(const PathVertex &vertex, vec3<float> dir) {
+        // One-sided emitters only emit to the front, as rays can not hit their back
+        if(!std::get<2>(vertex.object->getNormalBounds()) && !(dot(vertex.n, dir) > 0.0F)) {
+            return {};
+        }
+
+        return vertex.material->getEmission({vertex.pos + dir, dir * -1.0F}, vertex.pos);
+    }
+
+    // BSDF at a vertex of the camera subpath scattering light arriving from a position, multiplied by the cosine towards the position
+    Spectrum getCameraScattering(const PathVertex &vertex, vec3<float> light_pos) {
+        Ray to_light = {vertex.pos, (light_pos - vertex.pos).normalize()};
+
+        auto [spectrum, shading_factor, shading_pd] =
+          vertex.bsdf->getSpectrum(vertex.ray, to_light, vertex.pos, vertex.n, {Color<float>(1.0F, 1.0F, 1.0F, 1.0F)}, vertex.material, true);
+        if(!(shading_pd > 0.0F)) {
+            return {};
+        }
+
+        return spectrum * (shading_factor / shading_pd);
+    }
+
+    // BSDF at a vertex of the light subpath scattering the arriving light towards a position, multiplied by the cosine towards the position
+    Spectrum getLightScattering(const PathVertex &vertex, vec3<float> camera_pos) {
+        auto dir = (camera_pos - vertex.pos).normalize();
+        Ray from_camera = {camera_pos, dir * -1.0F};
+        Ray to_light = {vertex.pos, vertex.ray.dir * -1.0F};
+
+        auto [spectrum, shading_factor, shading_pd] =
+          vertex.bsdf->getSpectrum(from_camera, to_light, vertex.pos, vertex.n, {Color<float>(1.0F, 1.0F, 1.0F, 1.0F)}, vertex.material, true);
+        if(!(shading_pd > 0.0F) || !(shading_factor > 0.0F)) {
+            return {};
+        }
+
+        // The shading factor contains the cosine towards the light, which is replaced by the cosine towards the camera
+        auto light_cos = std::abs(dot(vertex.n, to_light.dir));
+        auto camera_cos = std::abs(dot(vertex.n, dir));
+
+        return spectrum * (shading_factor / shading_pd * camera_cos / light_cos);
+    }
+
+    bool isVisible(const Scene &scene, vec3<float> from, vec3<float> to, float epsilon) {
+        auto offset = to - from;
+        auto distance = offset.getLength();
+        auto dir = offset / distance;
+
+        auto [t, object] = scene.getIntersection({from + dir * epsilon, dir});
+
+        return t < 0.0F || t >= distance - 2.0F * epsilon;
+    }
+
+    // Ray and throughput with which a subpath left the scene
+    struct SubpathEnd {
+        bool escaped;
+        Ray ray;
+        Spectrum beta;
+        //! Probability density with respect to solid angle of the BSDF sampling the ray, or 0 if it could not have been sampled otherwise
+        float bsdf_pd;
+    };
+
+    // Extends a subpath by tracing and scattering a ray leaving its last vertex, until the path is terminated by russian roulette
+    //  or reaches the maximum path length, both counting the vertices of the subpath after its first one
+    // The decisions at each vertex draw from the dimensions starting at the given one, which advance by the given stride from vertex to vertex
+    SubpathEnd extendSubpath(const WorkItem &item, Ray ray, Spectrum beta, float pdf_dir, std::vector<PathVertex> &vertices, RandomEngine &re,
+                             std::uint32_t dimension, std::uint32_t dimension_stride) {
+        const auto epsilon = item.job->options.epsilon;
+
+        // Light subpaths start with the emitted radiance, so russian roulette uses the throughput relative to the start of the subpath
+        const double start_contribution = getContribution(beta);
+
+        float bsdf_pd = 0.0F;
+        while(static_cast<int>(vertices.size()) < max_subpath_vertex_count) {
+            auto [t, object] = item.job->scene.getIntersection(ray);
+            if(t < 0.0F) {
+                return {true, ray, beta, bsdf_pd};
+            }
+
+            auto pos = ray.origin + ray.dir * t;
+            auto n = object->getSurfaceNormal(pos);
+            assertNormalized(n);
+
+            const auto *material_handler = object->getMaterialHandler();
+            const auto *material = material_handler->getMaterial(pos);
+            const auto *bsdf = material_handler->getBSDF(pos);
+
+            PathVertex vertex = {VertexType::Surface, pos, n, ray, object, material, bsdf, beta, 0.0F, 0.0F, bsdf->isDiscrete()};
+            vertex.pdf_fwd = convertToArea(pdf_dir, vertices.back().pos, vertex);
+            vertices.push_back(vertex);
+
+            float bounce_probability = getBounceProbability(item.job->options, static_cast<int>(vertices.size()) - 1, beta, start_contribution);
+            re.setDimension(dimension + roulette_dimension);
+            if(!(re.getFloat() < bounce_probability)) {
+                break;
+            }
+
+            re.setDimension(dimension + scattering_dimension);
+            auto [next_ray, ray_factor, ray_pd] = bsdf->propagateRay(ray, pos, n, epsilon, re, material);
+            assertNormalized(next_ray.dir);
+
+            auto [shaded_spectrum, shading_factor, shading_pd] = bsdf->getSpectrum(ray, next_ray, pos, n, beta, material, false);
+            if(!(ray_pd > 0.0F) || !(shading_pd > 0.0F) || !(ray_factor * shading_factor > 0.0F)) {
+                break;
+            }
+
+            beta = shaded_spectrum * (ray_factor * shading_factor / (ray_pd * shading_pd * bounce_probability));
+            assertNonNegative(beta);
+
+            // Discrete directions get a nominal density of 1 in both directions, and are never connected to
+            float pdf_rev_dir = 1.0F;
+            pdf_dir = 1.0F;
+            bsdf_pd = 0.0F;
+            if(!vertex.discrete) {
+                pdf_dir = bsdf->getPdf(ray, next_ray, pos, n, material);
+                pdf_rev_dir = bsdf->getPdf({pos + next_ray.dir, next_ray.dir * -1.0F}, {pos, ray.dir * -1.0F}, pos, n, material);
+                bsdf_pd = pdf_dir;
+            }
+
+            auto &previous = vertices[vertices.size() - 2];
+            previous.pdf_rev = convertToArea(pdf_rev_dir, pos, previous);
+
+            ray = next_ray;
+            dimension += dimension_stride;
+        }
+
+        return {false, ray, beta, 0.0F};
+    }
+
+    // Ratio of the probability densities of sampling a vertex in reverse and forward direction, for comparing sampling strategies
+    double getStrategyRatio(const PathVertex &vertex) {
+        return vertex.pdf_fwd > 0.0F ? static_cast<double>(vertex.pdf_rev) / vertex.pdf_fwd : 0.0;
+    }
+
+    // Weight of connecting the first s vertices of the light subpath with the first t vertices of the camera subpath,
+    //  using the power heuristic over all strategies that could have sampled the same path
+    float getBidirectionalWeight(const WorkItem &item, int s, int t) {
+        if(s + t == 2) {
+            return 1.0F;
+        }
+
+        PathVertex *qs = s > 0 ? &light_vertices[s - 1] : nullptr;
+        PathVertex *qs_minus = s > 1 ? &light_vertices[s - 2] : nullptr;
+        PathVertex &pt = camera_vertices[t - 1];
+        PathVertex *pt_minus = t > 1 ? &camera_vertices[t - 2] : nullptr;
+
+        // Update the reverse densities around the connection, restoring them afterwards
+        std::array<float, 4> saved_pdfs = {pt.pdf_rev, pt_minus ? pt_minus->pdf_rev : 0.0F, qs ? qs->pdf_rev : 0.0F, qs_minus ? qs_minus->pdf_rev : 0.0F};
+        bool saved_discrete = pt.discrete;
+
+        if(s > 0) {
+            pt.pdf_rev = getVertexPdf(item, qs_minus, *qs, pt);
+            if(pt_minus) {
+                pt_minus->pdf_rev = getVertexPdf(item, qs, pt, *pt_minus);
+            }
+            qs->pdf_rev = getVertexPdf(item, pt_minus, pt, *qs);
+            if(qs_minus) {
+                qs_minus->pdf_rev = getVertexPdf(item, &pt, *qs, *qs_minus);
+            }
+        }
+        else {
+            // The camera subpath hit an emissive object, which light subpaths would have started on
+            assert(pt_minus != nullptr);
+            auto [pos_pd, dir_pd] = item.job->scene.getEmissionPdf(pt.object, pt.pos, (pt_minus->pos - pt.pos).normalize());
+            pt.pdf_rev = pos_pd;
+            pt_minus->pdf_rev = convertToArea(dir_pd, pt.pos, *pt_minus);
+            pt.discrete = false;
+        }
+
+        double sum = 0.0;
+
+        double ratio = 1.0;
+        for(int i = t - 1; i > 0; i--) {
+            ratio *= getStrategyRatio(camera_vertices[i]);
+            if(!camera_vertices[i].discrete && !camera_vertices[i - 1].discrete) {
+                sum += ratio * ratio;
+            }
+        }
+
+        ratio = 1.0;
+        for(int i = s - 1; i >= 0; i--) {
+            ratio *= getStrategyRatio(light_vertices[i]);
+            if(!light_vertices[i].discrete && (i == 0 || !light_vertices[i - 1].discrete)) {
+                sum += ratio * ratio;
+            }
+        }
+
+        pt.pdf_rev = saved_pdfs[0];
+        if(pt_minus) {
+            pt_minus->pdf_rev = saved_pdfs[1];
+        }
+        if(qs) {
+            qs->pdf_rev = saved_pdfs[2];
+        }
+        if(qs_minus) {
+            qs_minus->pdf_rev = saved_pdfs[3];
+        }
+        pt.discrete = saved_discrete;
+
+        return static_cast<float>(1.0 / (1.0 + sum));
+    }
+
+    // Connects the first s vertices of the light subpath to the camera, adding the weighted contribution to the splat image
+    void splatLightVertex(const WorkItem &item, int s) {
+        const auto &camera = item.job->camera;
+        const auto &qs = light_vertices[s - 1];
+        if(qs.discrete) {
+            return;
+        }
+
+        auto camera_pos = camera.getOrigin();
+        auto offset = camera_pos - qs.pos;
+        auto distance2 = offset.getLengthSquared();
+        if(!(distance2 > 0.0F)) {
+            return;
+        }
+
+        auto [x, y, camera_pd] = camera.projectDirection((qs.pos - camera_pos).normalize());
+        if(!(camera_pd > 0.0F)) {
+            return;
+        }
+
+        Spectrum scattering;
+        if(qs.type == VertexType::Light) {
+            auto dir = offset.normalize();
+            scattering = getEmittedSpectrum(qs, dir) * std::abs(dot(qs.n, dir));
+        }
+        else {
+            scattering = getLightScattering(qs, camera_pos);
+        }
+
+        // The importance of the camera for the whole sensor is the density of shooting the ray, which is independent of the pixel size,
+        //  as each camera sample traces one light path
+        auto contribution = qs.beta * scattering * (camera_pd / distance2);
+        if(!(getContribution(contribution) > 0.0F)) {
+            return;
+        }
+
+        if(!isVisible(item.job->scene, qs.pos, camera_pos, item.job->options.epsilon)) {
+            return;
+        }
+
+        // Sensor coordinates are mirrored vertically with respect to image rows
+        const auto &options = item.job->options;
+        int pixel_x = std::clamp(static_cast<int>((x + 1.0F) / 2.0F * static_cast<float>(options.image_width)), 0, options.image_width - 1);
+        int pixel_y = std::clamp(static_cast<int>((1.0F - y) / 2.0F * static_cast<float>(options.image_height)), 0, options.image_height - 1);
+
+        auto weighed_contribution = contribution * getBidirectionalWeight(item, s, 1);
+        assertNonNegative(weighed_contribution);
+
+        item.splat_image->add(pixel_x, pixel_y, weighed_contribution.getColor());
+    }
+
+    // Connects the first s vertices of the light subpath to the first t vertices of the camera subpath, where t is at least 2,
+    //  returning the weighted contribution
+    Spectrum connectVertices(const WorkItem &item, int s, int t) {
+        const auto &pt = camera_vertices[t - 1];
+
+        if(s == 0) {
+            auto emission = pt.material->getEmission(pt.ray, pt.pos);
+            if(!(getContribution(emission) > 0.0F)) {
+                return {};
+            }
+
+            return pt.beta * emission * getBidirectionalWeight(item, s, t);
+        }
+
+        const auto &qs = light_vertices[s - 1];
+        if(pt.discrete || qs.discrete) {
+            return {};
+        }
+
+        auto offset = pt.pos - qs.pos;
+        auto distance2 = offset.getLengthSquared();
+        if(!(distance2 > 0.0F)) {
+            return {};
+        }
+
+        Spectrum light_scattering;
+        if(qs.type == VertexType::Light) {
+            auto dir = offset.normalize();
+            light_scattering = getEmittedSpectrum(qs, dir) * std::abs(dot(qs.n, dir));
+        }
+        else {
+            light_scattering = getLightScattering(qs, pt.pos);
+        }
+
+        auto contribution = qs.beta * light_scattering * getCameraScattering(pt, qs.pos) * pt.beta / distance2;
+        if(!(getContribution(contribution) > 0.0F)) {
+            return {};
+        }
+
+        if(!isVisible(item.job->scene, pt.pos, qs.pos, item.job->options.epsilon)) {
+            return {};
+        }
+
+        return contribution * getBidirectionalWeight(item, s, t);
+    }
+
+    // Traces a subpath starting on an emissive object, replacing the given vertices
+    void traceLightSubpath(const WorkItem &item, std::vector<PathVertex> &vertices, RandomEngine &re, const DimensionLayout &layout) {
+        const Spectrum white = {Color<float>(1.0F, 1.0F, 1.0F, 1.0F)};
+
+        vertices.clear();
+        re.setDimension(layout.emission);
+        auto [emission_sample, emission_valid] = item.job->scene.sampleEmission(re);
+        if(!emission_valid) {
+            return;
+        }
+
+        const auto *material = emission_sample.object->getMaterialHandler()->getMaterial(emission_sample.pos);
+
+        PathVertex light_vertex = {VertexType::Light, emission_sample.pos, emission_sample.n, {}, emission_sample.object, material, nullptr,
+                                   white / emission_sample.pos_pd, emission_sample.pos_pd, 0.0F, false};
+        vertices.push_back(light_vertex);
+
+        auto emission = getEmittedSpectrum(light_vertex, emission_sample.dir);
+        auto beta = emission * (std::abs(dot(emission_sample.n, emission_sample.dir)) / (emission_sample.pos_pd * emission_sample.dir_pd));
+        if(getContribution(beta) > 0.0F) {
+            Ray light_ray = {emission_sample.pos + emission_sample.dir * item.job->options.epsilon, emission_sample.dir};
+            extendSubpath(item, light_ray, beta, emission_sample.dir_pd, vertices, re, layout.first_vertex + layout.light_subpath, layout.vertex_stride);
+        }
+    }
+
+    // Estimates direct lighting by light sources other than emissive objects, which are not sampled by light subpaths
+    Spectrum getLightSourceLighting(const WorkItem &item, const PathVertex &vertex, RandomEngine &re) {
+        const auto epsilon = item.job->options.epsilon;
+        const auto light_source_count = item.job->scene.getLightSourceCount();
+
+        Spectrum direct_spectrum;
+
+        int light_count = item.job->scene.sampleLights(vertex.pos, vertex.n, re, light_sample_buffer);
+        for(int light_index = 0; light_index < light_count; light_index++) {
+            const auto &sample = light_sample_buffer[light_index];
+            if(sample.light_id >= light_source_count) {
+                continue;
+            }
+
+            auto [contribution, light_ray] = getUnoccludedContribution(vertex.ray, vertex.pos, vertex.n, vertex.bsdf, vertex.material, sample, epsilon);
+            if(!(getContribution(contribution) > 0.0F)) {
+                continue;
+            }
+
+            if(!isUnoccluded(item.job->scene, light_ray, vertex.pos, sample, epsilon)) {
+                continue;
+            }
+
+            float light_weight = 1.0F;
+            if(sample.bsdf_reachable) {
+                light_weight = getPowerHeuristic(sample.pd, vertex.bsdf->getPdf(vertex.ray, light_ray, vertex.pos, vertex.n, vertex.material));
+            }
+
+            direct_spectrum = direct_spectrum + contribution * (light_weight / sample.pd);
+        }
+
+        return direct_spectrum;
+    }
+
+    // Estimates the light arriving at the camera using bidirectional path tracing, where one light subpath is traced for every sample,
+    //  and contributions of light subpaths connected directly to the camera are added to the splat image of the item
+    std::tuple<Spectrum, bool> getBidirectionalSample(const WorkItem &item, float x_camera, float y_camera, RandomEngine &re) {
+        const auto &camera = item.job->camera;
+        const auto &scene = item.job->scene;
+
+        // Jitter over the whole pixel, so that camera rays cover the same sensor area that light subpaths are connected to
+        const auto pixel_width = 2.0F / static_cast<float>(item.job->options.image_width);
+        const auto pixel_height = 2.0F / static_cast<float>(item.job->options.image_height);
+
+        auto max_light_count = static_cast<std::size_t>(scene.getMaxLightSampleCount());
+        if(light_sample_buffer.size() < max_light_count) {
+            light_sample_buffer.resize(max_light_count);
+        }
+
+        const Spectrum white = {Color<float>(1.0F, 1.0F, 1.0F, 1.0F)};
+
+        const auto layout = getDimensionLayout(item, true);
+
+        // Camera subpath, whose first vertex can only be connected to if all rays originate at a single point
+        Ray ray = camera.shootRay(x_camera, y_camera, pixel_width, pixel_height, re);
+        assertNormalized(ray.dir);
+
+        bool camera_connectable = item.splat_image != nullptr && camera.isPinhole();
+
+        camera_vertices.clear();
+        camera_vertices.push_back({VertexType::Camera, ray.origin, {}, ray, nullptr, nullptr, nullptr, white, 1.0F, 0.0F, !camera_connectable});
+        auto camera_end =
+          extendSubpath(item, ray, white, std::get<2>(camera.projectDirection(ray.dir)), camera_vertices, re, layout.first_vertex, layout.vertex_stride);
+
+        traceLightSubpath(item, light_vertices, re, layout);
+
+        Spectrum out_spectrum;
+
+        int camera_count = static_cast<int>(camera_vertices.size());
+        int light_count = static_cast<int>(light_vertices.size());
+        for(int t = 1; t <= camera_count; t++) {
+            for(int s = 0; s <= light_count; s++) {
+                if(s + t < 2 || (s == 1 && t == 1)) {
+                    continue;
+                }
+
+                if(t == 1) {
+                    if(camera_connectable) {
+                        splatLightVertex(item, s);
+                    }
+                    continue;
+                }
 
-    float getContribution(Color<float> color) {
-        return /* color[3] * */ (color[0] + color[1] + color[2]) / 3.0F;
-    }
+                out_spectrum = out_spectrum + connectVertices(item, s, t);
+            }
 
-    float getContribution(Spectrum spectrum) {
-        auto color = spectrum.getColor();
+            // Light sources that are not emissive objects are only sampled from the camera subpath
+            if(t >= 2 && !camera_vertices[t - 1].discrete) {
+                re.setDimension(layout.getVertex(t - 2) + vertex_decision_dimension_count);
+                out_spectrum = out_spectrum + camera_vertices[t - 1].beta * getLightSourceLighting(item, camera_vertices[t - 1], re);
+            }
+        }
 
-        return getContribution(color);
-    }
+        int infinite_light_count = scene.getInfiniteLightCount();
+        if(camera_end.escaped) {
+            for(int light_index = 0; light_index < infinite_light_count; light_index++) {
+                auto [emission, light_pd] = scene.getInfiniteLightEmission(light_index, camera_end.ray.origin, camera_end.ray);
+                float emission_weight = camera_end.bsdf_pd > 0.0F ? getPowerHeuristic(camera_end.bsdf_pd, light_pd) : 1.0F;
 
-    bool isNonNegative(Spectrum spectrum) {
-        return isNonNegative(spectrum.getColor());
-    }
+                out_spectrum = out_spectrum + camera_end.beta * emission * emission_weight;
+            }
+        }
 
-    std::tuple<Spectrum, bool> getSample(const WorkItem &item, float x_camera, float y_camera, RandomEngine &re) {
-        const auto pixel_width = 1.0F / static_cast<float>(item.job->options.image_width);
-        const auto pixel_height = 1.0F / static_cast<float>(item.job->options.image_height);
+        bool sample_collected = camera_count > 1 || infinite_light_count > 0;
 
-        const auto epsilon = item.job->options.epsilon;
+        auto out_color = out_spectrum.getColor();
+        out_color[3] = sample_collected ? 1.0F : 0.0F;
 
-        std::uniform_real_distribution<float> dist(0, 1);
+        return std::make_tuple(Spectrum{out_color}, sample_collected);
+    }
 
-        Ray ray = item.job->camera.shootRay(x_camera, y_camera, pixel_width, pixel_height, re);
-        assertNormalized(ray.dir);
+    // Traces photons from emissive objects for a pass of progressive photon mapping
+    // Photons are deposited at every non-discrete vertex except the first one, whose light is found by direct lighting at the camera paths instead
+    void tracePhotons(const FrameRenderJob &job, int photon_count, std::vector<Photon> &photons, RandomEngine &re) {
+        WorkItem item(&job, 0, 0, 0, 0);
+        const auto layout = getDimensionLayout(item, true);
 
-        bool sample_collected = false;
-        float contribution_unweighted = static_cast<float>(1);
-        double sample_divisor = 1.0F;
-        double sample_bounce_pd = 1.0;
-        Spectrum sample_spectrum = {Color<float>(1.0F, 1.0F, 1.0F, 1.0F)};
-        Spectrum out_spectrum;
-        int path_length = 0;
-        for(;;) {
-            auto [t, object] = item.job->scene.getIntersection(ray);
+        photons.clear();
+        for(int i = 0; i < photon_count; i++) {
+            traceLightSubpath(item, light_vertices, re, layout);
 
-            if(t < static_cast<float>(0)) {
-                break;
+            for(std::size_t index = 2; index < light_vertices.size(); index++) {
+                const auto &vertex = light_vertices[index];
+                if(!vertex.discrete) {
+                    photons.push_back({vertex.pos, vertex.ray.dir, vertex.beta});
+                }
             }
-            path_length++;
+        }
+    }
 
-            sample_collected = true;
+    // Gathers the photons around the vertex of a camera path, refining the statistics of its pixel
+    void gatherPhotons(const WorkItem &item, PhotonPixel &pixel, const Ray &ray, vec3<float> pos, vec3<float> n, const BSDF *bsdf, const Material *material,
+                       Spectrum beta) {
+        if(!(pixel.radius > 0.0F)) {
+            return;
+        }
 
-            auto pos = ray.origin + ray.dir * t;
-            auto n = object->getSurfaceNormal(pos);
-            assertNormalized(n);
+        Spectrum flux;
+        int found_count = 0;
+        item.photon_state->photon_map.gather(pos, pixel.radius, [&](const Photon &photon) {
+            found_count++;
 
-            const auto *material_handler = object->getMaterialHandler();
-            const auto *material = material_handler->getMaterial(pos);
-            const auto *bsdf = material_handler->getBSDF(pos);
+            Ray to_light = {pos, photon.dir * -1.0F};
+            auto light_cos = std::abs(dot(n, to_light.dir));
 
-            auto emission = material->getEmission(ray, pos);
-            assert(sample_bounce_pd > 0.0);
-            out_spectrum = out_spectrum + sample_spectrum * emission / static_cast<float>(sample_divisor * sample_bounce_pd);
+            // The shading factor contains the cosine towards the light, which the power of a photon already accounts for
+            auto [spectrum, shading_factor, shading_pd] = bsdf->getSpectrum(ray, to_light, pos, n, photon.power, material, true);
+            if(shading_pd > 0.0F && light_cos > 0.0F) {
+                flux = flux + spectrum * (shading_factor / (shading_pd * light_cos));
+            }
+        });
 
-            // TODO: Don't use raw contribution, use some relative measure instead
-            float bounce_probability = path_length <= 4 ? 1.0F : 0.1F + 0.1F * std::min(contribution_unweighted * getContribution(sample_spectrum), 1.0F);
-            assert(bounce_probability >= 0.0F && bounce_probability <= 1.0F);
+        if(found_count == 0) {
+            return;
+        }
 
-            bool do_bounce = dist(re) < bounce_probability;
-            bool sample_light_sources = true; // !do_bounce;
+        // Only a fraction of the new photons is kept, and the radius shrinks so that the density of the kept photons stays the same
+        float alpha = std::clamp(item.job->options.photon_radius_alpha, 0.0F, 1.0F);
+        float photon_count = pixel.photon_count + alpha * static_cast<float>(found_count);
+        float radius = pixel.radius * std::sqrt(photon_count / (pixel.photon_count + static_cast<float>(found_count)));
 
-            if(sample_light_sources) {
-                auto lights = item.job->scene.sampleLights(pos, n, re);
+        pixel.flux = (pixel.flux + beta * flux) * (radius * radius / (pixel.radius * pixel.radius));
+        pixel.photon_count = photon_count;
+        pixel.radius = radius;
+    }
 
-                for(const auto &[light_pos, light_spectrum, lpd] : lights) {
-                    assert(lpd >= 0.0F);
-                    assertNonNegative(light_spectrum);
+    // Renders a pass of progressive photon mapping for a pixel, by tracing a camera path through discrete scattering
+    //  to the first vertex at which photons can be gathered, adding the emission and direct lighting found along the way
+    void renderPhotonPixel(const WorkItem &item, int x, int y, RandomEngine &re) {
+        const auto &scene = item.job->scene;
+        const auto &options = item.job->options;
+        const auto epsilon = options.epsilon;
 
-                    auto to_light = (light_pos - pos);
-                    auto light_dir = to_light.normalize();
-                    Ray light_ray = {pos + light_dir * epsilon, light_dir};
+        const float one_half = static_cast<float>(1) / static_cast<float>(2);
+        float x_camera = 2 * ((static_cast<float>(x) + one_half) / static_cast<float>(options.image_width) - one_half);
+        float y_camera = -2 * ((static_cast<float>(y) + one_half) / static_cast<float>(options.image_height) - one_half);
 
-                    float light_t = std::get<0>(item.job->scene.getIntersection(light_ray));
+        auto max_light_count = static_cast<std::size_t>(scene.getMaxLightSampleCount());
+        if(light_sample_buffer.size() < max_light_count) {
+            light_sample_buffer.resize(max_light_count);
+        }
 
-                    if(light_t < static_cast<float>(0) || (light_t >= to_light.getLength() - epsilon)) {
-                        auto [base_spectrum, shading_factor, shadow_ray_pd] = bsdf->getSpectrum(ray, light_ray, pos, n, light_spectrum, material, true);
-                        assert(shading_factor >= 0.0F && shading_factor <= 1.0F);
-                        assert(shadow_ray_pd >= 0.0F);
-                        assertNonNegative(base_spectrum);
+        auto &pixel = item.photon_state->pixels[y * item.photon_state->width + x];
 
-                        if(shadow_ray_pd > static_cast<float>(0)) {
-                            auto combined_spectrum = base_spectrum * shading_factor * sample_spectrum;
-                            assertNonNegative(combined_spectrum);
+        const auto layout = getDimensionLayout(item, false);
 
-                            assert(sample_bounce_pd >= 0.0);
-                            auto weighed_spectrum = combined_spectrum / static_cast<float>(sample_divisor * sample_bounce_pd * lpd * shadow_ray_pd);
-                            assertNonNegative(weighed_spectrum);
+        Ray ray = item.job->camera.shootRay(x_camera, y_camera, 2.0F / static_cast<float>(options.image_width),
+                                            2.0F / static_cast<float>(options.image_height), re);
+        assertNormalized(ray.dir);
 
-                            out_spectrum = out_spectrum + weighed_spectrum;
-                        }
-                    }
+        Spectrum beta = {Color<float>(1.0F, 1.0F, 1.0F, 1.0F)};
+        Spectrum direct;
+        for(int vertex_count = 1; vertex_count < max_subpath_vertex_count; vertex_count++) {
+            auto [t, object] = scene.getIntersection(ray);
+            if(t < 0.0F) {
+                int infinite_light_count = scene.getInfiniteLightCount();
+                for(int light_index = 0; light_index < infinite_light_count; light_index++) {
+                    direct = direct + beta * std::get<0>(scene.getInfiniteLightEmission(light_index, ray.origin, ray));
                 }
-            }
 
-            if(!do_bounce) {
-                sample_bounce_pd *= 1.0F - bounce_probability;
+                if(infinite_light_count > 0) {
+                    pixel.collected = true;
+                }
                 break;
             }
-            sample_bounce_pd *= bounce_probability;
+            pixel.collected = true;
 
-            if(sample_bounce_pd <= 1E-20) {
+            auto pos = ray.origin + ray.dir * t;
+            auto n = object->getSurfaceNormal(pos);
+            assertNormalized(n);
+
+            const auto *material_handler = object->getMaterialHandler();
+            const auto *material = material_handler->getMaterial(pos);
+            const auto *bsdf = material_handler->getBSDF(pos);
+
+            // Emission is only found here, since lights are not sampled at discrete vertices and the path ends at the first other vertex
+            direct = direct + beta * material->getEmission(ray, pos);
+
+            auto vertex_dimension = layout.getVertex(vertex_count - 1);
+            if(!bsdf->isDiscrete()) {
+                re.setDimension(vertex_dimension + vertex_decision_dimension_count);
+                Spectrum direct_spectrum;
+                if(options.direct_lighting == DirectLighting::Resampled) {
+                    direct_spectrum = getResampledDirectLighting(item, ray, pos, n, bsdf, material, re);
+                }
+                else {
+                    direct_spectrum = getDirectLighting(item, ray, pos, n, bsdf, material, re, false);
+                }
+                direct = direct + beta * direct_spectrum;
+
+                gatherPhotons(item, pixel, ray, pos, n, bsdf, material, beta);
                 break;
             }
 
-            // Generate next ray
+            re.setDimension(vertex_dimension + scattering_dimension);
             auto [next_ray, ray_factor, ray_pd] = bsdf->propagateRay(ray, pos, n, epsilon, re, material);
             assertNormalized(next_ray.dir);
-            assert(ray_pd > 0.0F);
-
-            sample_divisor *= ray_pd;
-            sample_divisor /= ray_factor;
-            contribution_unweighted *= ray_factor;
-
-            auto [shaded_spectrum, shading_factor, shading_pd] = bsdf->getSpectrum(ray, next_ray, pos, n, sample_spectrum, material, false);
-            assert(shading_pd > 0.0F);
-            assert(shading_factor >= 0.0F && shading_factor <= 1.0F);
-            sample_divisor *= shading_pd;
-            sample_divisor /= shading_factor;
-            contribution_unweighted *= shading_factor;
-            sample_spectrum = shaded_spectrum;
-            assertNonNegative(sample_spectrum);
 
-            if(sample_divisor <= 1E-20) {
+            auto [shaded_spectrum, shading_factor, shading_pd] = bsdf->getSpectrum(ray, next_ray, pos, n, beta, material, false);
+            if(!(ray_pd > 0.0F) || !(shading_pd > 0.0F) || !(ray_factor * shading_factor > 0.0F)) {
                 break;
             }
 
+            beta = shaded_spectrum * (ray_factor * shading_factor / (ray_pd * shading_pd));
+            assertNonNegative(beta);
+
             ray = next_ray;
         }
 
-        auto out_color = out_spectrum.getColor();
-        out_color[3] = sample_collected ? 1.0F : 0.0F;
-        out_spectrum = {out_color};
+        pixel.direct = pixel.direct + direct;
+    }
 
-        return std::make_tuple(out_spectrum, sample_collected);
+    // Path sampled by Metropolis light transport, whose first two primary samples choose the pixel
+    struct MetropolisSample {
+        Spectrum spectrum;
+        int x;
+        int y;
+        //! Scalar contribution of the path, proportionally to which the Markov chains sample paths
+        float contribution;
+    };
+
+    MetropolisSample getMetropolisSample(const WorkItem &item, PrimarySampleSequence &sequence) {
+        const auto &options = item.job->options;
+
+        int x = std::min(static_cast<int>(sequence.nextSample() * static_cast<float>(options.image_width)), options.image_width - 1);
+        int y = std::min(static_cast<int>(sequence.nextSample() * static_cast<float>(options.image_height)), options.image_height - 1);
+
+        const float one_half = static_cast<float>(1) / static_cast<float>(2);
+        float x_camera = 2 * ((static_cast<float>(x) + one_half) / static_cast<float>(options.image_width) - one_half);
+        float y_camera = -2 * ((static_cast<float>(y) + one_half) / static_cast<float>(options.image_height) - one_half);
+
+        // All random decisions of the path are taken from the primary samples
+        RandomEngine re(0);
+        re.setSequence(&sequence);
+
+        auto spectrum = std::get<0>(getSample(item, x_camera, y_camera, re));
+
+        float contribution = getContribution(spectrum);
+        if(!std::isfinite(contribution) || !(contribution > 0.0F)) {
+            contribution = 0.0F;
+        }
+
+        return {spectrum, x, y, contribution};
+    }
+
+    // Length of the diagonal of the scene bounds, relative to which radii and cell sizes that are not specified are chosen
+    float getSceneDiagonal(const Scene &scene) {
+        auto bounds = scene.getBounds();
+
+        return (bounds.high - bounds.low).getLength();
+    }
+
+    void recordStatistics(const WorkItem &item) {
+        if(item.job->statistics != nullptr) {
+            item.job->statistics->shadow_ray_count.fetch_add(occluder_cache.shadow_ray_count, std::memory_order_relaxed);
+            item.job->statistics->occluder_cache_hit_count.fetch_add(occluder_cache.hit_count, std::memory_order_relaxed);
+        }
     }
 }
 
-Image<> processItem(const WorkItem &item, RandomEngine &re) {
+void processItem(const WorkItem &item, ImageView<> image) {
     using namespace impl;
 
+    assert(image.getWidth() == item.width && image.getHeight() == item.height);
+
+    // Only carries the sampler of each pixel sample, so its own numbers do not depend on the worker rendering the tile
+    RandomEngine re(deriveSeed(item.job->options.seed, tile_seed_stream));
+
     long total_collected = 0;
 
-    Image<> image(item.width, item.height);
+    occluder_cache.clear();
+
+    auto sampler = createSampler(item.job->options.sampler, item.job->options.seed);
+
+    // Photon mapping refines the statistics of each pixel once per pass, and outputs the estimate of all passes so far
+    // The camera path of each pass is the next sample of the pixel
+    if(item.photon_state != nullptr) {
+        for(int y = item.offset_y; y < item.offset_y + item.height; y++) {
+            for(int x = item.offset_x; x < item.offset_x + item.width; x++) {
+                sampler->startSample(x, y, item.photon_state->pass_count - 1);
+                re.setSequence(sampler.get());
+
+                renderPhotonPixel(item, x, y, re);
+                re.setSequence(nullptr);
+
+                image(x - item.offset_x, y - item.offset_y) = item.photon_state->get(x, y);
+            }
+        }
+
+        recordStatistics(item);
+        return;
+    }
+
+    const bool bidirectional = item.job->integrator == Integrator::Bidirectional;
+    std::int64_t light_path_count = 0;
 
     const float one_half = static_cast<float>(1) / static_cast<float>(2);
 
@@ -191,7 +1333,13 @@ Image<> processItem(const WorkItem &item, RandomEngine &re) {
             int remaining_checks = check_sample_count;
             bool accepted_candidate = false;
             for(int pixel_sample = 0; pixel_sample < item.job->options.max_sample_count; pixel_sample++) {
-                auto [out_spectrum, sample_collected] = getSample(item, x_camera, y_camera, re);
+                sampler->startSample(x, y, pixel_sample);
+                re.setSequence(sampler.get());
+
+                auto [out_spectrum, sample_collected] =
+                  bidirectional ? getBidirectionalSample(item, x_camera, y_camera, re) : getSample(item, x_camera, y_camera, re);
+                re.setSequence(nullptr);
+                light_path_count++;
 
                 if(sample_collected) {
                     assertNonNegative(out_spectrum);
@@ -322,86 +1470,177 @@ Image<> processItem(const WorkItem &item, RandomEngine &re) {
         }
     }
 
-    return image;
+    if(bidirectional && item.splat_image != nullptr) {
+        item.splat_image->path_count.fetch_add(light_path_count, std::memory_order_relaxed);
+    }
+
+    recordStatistics(item);
 }
 
-void doWork(std::queue<WorkItem> &queue, Image<> &output_image, RandomEngine re, const std::function<void(int)> &progress_callback, std::mutex &mutex_queue,
-            std::mutex &mutex_callback, std::atomic<int> &processed_tiles) {
-    for(;;) {
-        WorkItem item;
+// Renders all items on the workers of a scheduler, writing each tile into the output image
+void doWorkParallel(const std::vector<WorkItem> &items, ImageView<> output_image, const std::function<void(int)> &progress_callback,
+                    TaskScheduler &scheduler) {
+    std::mutex mutex_callback;
+    std::atomic<int> processed_tiles = 0;
+
+    scheduler.run(static_cast<int>(items.size()), [&](int task, int) {
+        const WorkItem &item = items[task];
+
+        // Tiles do not overlap, so each worker renders straight into its own region of the output image
+        processItem(item, output_image.getRegion(item.offset_x, item.offset_y, item.width, item.height));
 
-        // Note: Non-blocking parallel queue implementations are available
-        //  The current solution performs sufficiently well for large enough tile sizes
         {
-            std::lock_guard<std::mutex> lock(mutex_queue);
+            std::lock_guard<std::mutex> lock(mutex_callback);
 
-            if(queue.empty()) {
-                break;
-            }
+            int previous_progress = processed_tiles.fetch_add(1, std::memory_order_relaxed);
 
-            item = queue.front();
-            queue.pop();
+            progress_callback(previous_progress + 1);
         }
+    });
+}
 
-        Image<> tile_image = processItem(item, re);
+// Traces the photons of the next pass of progressive photon mapping in parallel, and replaces the photon map by them
+// Photons are traced in batches of a fixed size with random numbers derived from the index of the pass and batch,
+//  so that the photon map does not depend on the number of workers
+void tracePhotonPass(const FrameRenderJob &job, PhotonMappingState &state, TaskScheduler &scheduler) {
+    const int photon_count = std::max(job.options.photon_count, 0);
+    const int batch_count = (photon_count + (impl::photon_batch_size - 1)) / impl::photon_batch_size;
 
-        for(int y = 0; y < item.height; y++) {
-            for(int x = 0; x < item.width; x++) {
-                output_image(item.offset_x + x, item.offset_y + y) = tile_image(x, y);
-            }
-        }
+    const auto pass_seed = deriveSeed(deriveSeed(job.options.seed, impl::photon_seed_stream), state.pass_count);
 
-        {
-            std::lock_guard<std::mutex> lock(mutex_callback);
+    std::vector<std::vector<Photon>> batches(batch_count);
+    scheduler.run(batch_count, [&](int batch, int) {
+        int batch_photon_count = std::min(photon_count - batch * impl::photon_batch_size, impl::photon_batch_size);
 
-            int previous_progress = processed_tiles.fetch_add(1, std::memory_order_relaxed);
+        RandomEngine re(deriveSeed(pass_seed, batch));
+        impl::tracePhotons(job, batch_photon_count, batches[batch], re);
+    });
 
-            progress_callback(previous_progress + 1);
+    // Cells are at least as large as the largest gather radius, so that gathering never visits more than two cells along each axis
+    state.photon_map = PhotonMap(batches, std::max(state.getMaxRadius(), std::numeric_limits<float>::min()), scheduler);
+    state.emitted_photon_count += photon_count;
+    state.pass_count++;
+}
+
+// Renders a job using Metropolis light transport, where the Markov chains are distributed over the workers and record their paths onto a shared image
+Image<> processMetropolisJob(const FrameRenderJob &job, const std::function<void(int, int)> &progress_callback, TaskScheduler &scheduler) {
+    using namespace impl;
+
+    const auto &options = job.options;
+    const int width = options.image_width;
+    const int height = options.image_height;
+    const int bootstrap_count = std::max(options.bootstrap_sample_count, 1);
+    const int chain_count = std::max(options.metropolis_chain_count, 1);
+    const std::int64_t mutation_count = static_cast<std::int64_t>(width) * height * std::max(options.max_sample_count, 0);
+
+    WorkItem item(&job, 0, 0, width, height);
+
+    const auto metropolis_seed = deriveSeed(options.seed, impl::metropolis_seed_stream);
+    RandomEngine re(deriveSeed(metropolis_seed, 0));
+
+    // Bootstrap samples use seeds derived from their index, so that a chain can start from any of them by reconstructing its primary samples
+    std::uint64_t seed_base = deriveSeed(metropolis_seed, 1);
+
+    std::vector<float> bootstrap_weights(bootstrap_count);
+    scheduler.run((bootstrap_count + (bootstrap_batch_size - 1)) / bootstrap_batch_size, [&](int batch, int) {
+        occluder_cache.clear();
+
+        for(int i = batch * bootstrap_batch_size; i < std::min((batch + 1) * bootstrap_batch_size, bootstrap_count); i++) {
+            PrimarySampleSequence sequence(deriveSeed(seed_base, i), options.mutation_size, options.large_step_probability);
+            bootstrap_weights[i] = getMetropolisSample(item, sequence).contribution;
         }
+
+        recordStatistics(item);
+    });
+
+    // Average contribution of independent paths, which normalizes the contributions of paths sampled proportionally to their contribution
+    auto brightness = static_cast<float>(std::accumulate(bootstrap_weights.begin(), bootstrap_weights.end(), 0.0) / bootstrap_count);
+
+    Image<> output_image(width, height);
+    if(!(brightness > 0.0F) || mutation_count == 0) {
+        return output_image;
     }
-}
 
-void doWorkParallel(std::queue<WorkItem> &queue, Image<> &output_image, const std::function<void(int)> &progress_callback, int worker_count = 0) {
-    if(worker_count <= 0) {
-        worker_count = static_cast<int>(std::thread::hardware_concurrency()) - 1;
+    // Chains start from bootstrap paths chosen proportionally to their contribution, so that they are distributed as desired from the start
+    AliasTable bootstrap_table(bootstrap_weights);
+
+    std::vector<int> chain_starts(chain_count);
+    for(int &start : chain_starts) {
+        start = std::get<0>(bootstrap_table.sample(re.getFloat()));
     }
 
-    std::random_device rd;
-    RandomEngine re(rd());
+    SplatImage splat_image(width, height);
 
-    std::mutex mutex_queue;
+    std::atomic<int> finished_chains = 0;
     std::mutex mutex_callback;
-    std::atomic<int> processed_tiles = 0;
 
-    std::vector<std::thread> extra_threads;
-    extra_threads.reserve(worker_count - 1);
-    for(int i = 0; i < worker_count - 1; i++) {
-        extra_threads.emplace_back(doWork, std::ref(queue), std::ref(output_image), RandomEngine{re()}, progress_callback, std::ref(mutex_queue),
-                                   std::ref(mutex_callback), std::ref(processed_tiles));
-    }
-    doWork(queue, output_image, RandomEngine{re()}, progress_callback, std::ref(mutex_queue), std::ref(mutex_callback), std::ref(processed_tiles));
+    scheduler.run(chain_count, [&](int chain, int) {
+        occluder_cache.clear();
 
-    for(auto &thread : extra_threads) {
-        thread.join();
-    }
-}
+        // Acceptance decisions of each chain are derived from its index, so that chains do not depend on the worker running them
+        RandomEngine chain_re(deriveSeed(deriveSeed(metropolis_seed, 2), chain));
 
-Image<> processJob(const FrameRenderJob &job, const std::function<void(int, int)> &progress_callback, int worker_count) {
-    auto width = std::max(job.options.image_width, 0);
-    auto height = std::max(job.options.image_height, 0);
+        std::int64_t chain_mutation_count = mutation_count / chain_count + (chain < mutation_count % chain_count ? 1 : 0);
 
-    Image<> output_image = Image(width, height);
-    if(width == 0 || height == 0) {
-        return output_image;
+        PrimarySampleSequence sequence(deriveSeed(seed_base, chain_starts[chain]), options.mutation_size, options.large_step_probability);
+        auto current = getMetropolisSample(item, sequence);
+
+        for(std::int64_t mutation = 0; mutation < chain_mutation_count; mutation++) {
+            sequence.startIteration();
+            auto proposal = getMetropolisSample(item, sequence);
+
+            float acceptance = current.contribution > 0.0F ? std::min(proposal.contribution / current.contribution, 1.0F) : 1.0F;
+
+            // Both paths are recorded weighted by their probability of being the next state, rather than only recording the chosen one
+            if(acceptance > 0.0F) {
+                splat_image.add(proposal.x, proposal.y, (proposal.spectrum * (acceptance * brightness / proposal.contribution)).getColor());
+            }
+            if(acceptance < 1.0F) {
+                splat_image.add(current.x, current.y, (current.spectrum * ((1.0F - acceptance) * brightness / current.contribution)).getColor());
+            }
+
+            if(chain_re.getFloat() < acceptance) {
+                current = proposal;
+                sequence.accept();
+            }
+            else {
+                sequence.reject();
+            }
+        }
+
+        splat_image.path_count.fetch_add(chain_mutation_count, std::memory_order_relaxed);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_callback);
+
+            progress_callback(finished_chains.fetch_add(1, std::memory_order_relaxed) + 1, chain_count);
+        }
+
+        recordStatistics(item);
+    });
+
+    for(int y = 0; y < height; y++) {
+        for(int x = 0; x < width; x++) {
+            auto color = splat_image.get(x, y);
+            color[3] = color[0] > 0.0F || color[1] > 0.0F || color[2] > 0.0F ? 1.0F : 0.0F;
+
+            output_image(x, y) = color;
+        }
     }
 
+    return output_image;
+}
+
+std::vector<WorkItem> createWorkItems(const FrameRenderJob &job, int width, int height, PathGuide *path_guide, bool record_path_guide,
+                                      SplatImage *splat_image, PhotonMappingState *photon_state = nullptr, RadianceCache *radiance_cache = nullptr,
+                                      bool record_radiance_cache = false) {
     int tile_size = std::max(std::min(std::min(width, height) / 4, 32), 1);
 
     // Divide by tile_size, rounding up to next integer
     int horizontal_tiles = (width + (tile_size - 1)) / tile_size;
     int vertical_tiles = (height + (tile_size - 1)) / tile_size;
 
-    std::queue<WorkItem> queue;
+    std::vector<WorkItem> items;
     for(int tile_y = 0; tile_y < vertical_tiles; tile_y++) {
         for(int tile_x = 0; tile_x < horizontal_tiles; tile_x++) {
             int offset_x = tile_x * tile_size;
@@ -409,21 +1648,217 @@ Image<> processJob(const FrameRenderJob &job, const std::function<void(int, int)
             int tile_width = std::min(width - offset_x, tile_size);
             int tile_height = std::min(height - offset_y, tile_size);
 
-            queue.emplace(&job, offset_x, offset_y, tile_width, tile_height);
+            items.emplace_back(&job, offset_x, offset_y, tile_width, tile_height, path_guide, record_path_guide, splat_image, photon_state,
+                               radiance_cache, record_radiance_cache);
         }
     }
 
-    int total_tile_count = horizontal_tiles * vertical_tiles;
-    const auto bound_progress_callback = [progress_callback, total_tile_count](int completed_tiles) {
-        return progress_callback(completed_tiles, total_tile_count);
-    };
+    return items;
+}
+
+RenderContext::RenderContext(int worker_count) : scheduler(worker_count) {}
+
+int RenderContext::getWorkerCount() const noexcept {
+    return this->scheduler.getWorkerCount();
+}
+
+Image<> RenderContext::render(const FrameRenderJob &job, const std::function<void(int, int)> &progress_callback) {
+    auto width = std::max(job.options.image_width, 0);
+    auto height = std::max(job.options.image_height, 0);
+
+    Image<> output_image = Image(width, height);
+    if(width == 0 || height == 0) {
+        return output_image;
+    }
+
+    if(job.integrator == Integrator::Metropolis) {
+        return processMetropolisJob(job, progress_callback, this->scheduler);
+    }
+
+    const bool bidirectional = job.integrator == Integrator::Bidirectional;
+
+    std::unique_ptr<PathGuide> path_guide;
+    if(job.options.path_guiding && job.integrator == Integrator::PathTracing) {
+        path_guide = std::make_unique<PathGuide>(job.scene.getBounds());
 
-    doWorkParallel(queue, output_image, bound_progress_callback, worker_count);
+        // Train the guide using passes with doubling sample counts, whose images are discarded
+        for(int pass = 0; pass < job.options.guiding_training_pass_count; pass++) {
+            RenderOptions training_options = job.options;
+            training_options.min_sample_count = 1 << std::min(pass, 16);
+            training_options.max_sample_count = training_options.min_sample_count;
+            training_options.seed = deriveSeed(deriveSeed(job.options.seed, impl::guide_training_seed_stream), pass);
+
+            FrameRenderJob training_job{job.camera, job.scene, training_options, nullptr};
+            Image<> training_image(width, height);
+
+            auto training_items = createWorkItems(training_job, width, height, path_guide.get(), true, nullptr);
+            doWorkParallel(training_items, training_image, [](int) {}, this->scheduler);
+
+            path_guide->update();
+        }
+    }
+
+    std::unique_ptr<RadianceCache> radiance_cache;
+    if(job.options.allow_bias && job.options.radiance_cache_size > 0 && job.integrator == Integrator::PathTracing) {
+        float cell_size = job.options.radiance_cache_cell_size;
+        if(!(cell_size > 0.0F)) {
+            cell_size = 0.03F * impl::getSceneDiagonal(job.scene);
+        }
+
+        radiance_cache = std::make_unique<RadianceCache>(job.options.radiance_cache_size, cell_size);
+
+        // Train the cache using passes of one sample per pixel, whose images are discarded
+        // All passes except the first terminate at the cache, so that they are short and propagate the light of longer paths
+        for(int pass = 0; pass < job.options.radiance_cache_training_pass_count; pass++) {
+            RenderOptions training_options = job.options;
+            training_options.min_sample_count = 1;
+            training_options.max_sample_count = 1;
+            training_options.seed = deriveSeed(deriveSeed(job.options.seed, impl::radiance_cache_training_seed_stream), pass);
+
+            FrameRenderJob training_job{job.camera, job.scene, training_options, nullptr};
+            Image<> training_image(width, height);
+
+            auto training_items = createWorkItems(training_job, width, height, path_guide.get(), false, nullptr, nullptr, radiance_cache.get(), true);
+            doWorkParallel(training_items, training_image, [](int) {}, this->scheduler);
+
+            radiance_cache->update();
+        }
+    }
+
+    std::unique_ptr<SplatImage> splat_image;
+    if(bidirectional) {
+        splat_image = std::make_unique<SplatImage>(width, height);
+    }
+
+    // Photon mapping renders one sample per pixel in each pass, where every pass traces and gathers new photons
+    std::unique_ptr<PhotonMappingState> photon_state;
+    int pass_count = 1;
+    if(job.integrator == Integrator::PhotonMapping) {
+        float radius = job.options.photon_radius;
+        if(!(radius > 0.0F)) {
+            radius = 0.01F * impl::getSceneDiagonal(job.scene);
+        }
+
+        photon_state = std::make_unique<PhotonMappingState>(width, height, radius);
+        pass_count = std::max(job.options.max_sample_count, 1);
+    }
+
+    for(int pass = 0; pass < pass_count; pass++) {
+        if(photon_state) {
+            tracePhotonPass(job, *photon_state, this->scheduler);
+        }
+
+        auto items = createWorkItems(job, width, height, path_guide.get(), false, splat_image.get(), photon_state.get(), radiance_cache.get());
+
+        int pass_tile_count = static_cast<int>(items.size());
+        int total_tile_count = pass_tile_count * pass_count;
+        const auto bound_progress_callback = [progress_callback, pass_tile_count, total_tile_count, pass](int completed_tiles) {
+            return progress_callback(pass * pass_tile_count + completed_tiles, total_tile_count);
+        };
+
+        doWorkParallel(items, output_image, bound_progress_callback, this->scheduler);
+    }
+
+    // Light paths connected to the camera contribute to arbitrary pixels, so they are only added once all tiles are finished
+    if(splat_image) {
+        for(int y = 0; y < height; y++) {
+            for(int x = 0; x < width; x++) {
+                output_image(x, y) += splat_image->get(x, y);
+            }
+        }
+    }
 
     return output_image;
 }
 
-WorkItem::WorkItem() noexcept : job(nullptr), offset_x(0), offset_y(0), width(0), height(0) {}
+Image<> processJob(const FrameRenderJob &job, const std::function<void(int, int)> &progress_callback, int worker_count) {
+    RenderContext context(worker_count);
+
+    return context.render(job, progress_callback);
+}
+
+float RenderStatistics::getOccluderCacheHitRate() const noexcept {
+    auto shadow_rays = this->shadow_ray_count.load(std::memory_order_relaxed);
+    if(shadow_rays <= 0) {
+        return 0.0F;
+    }
+
+    return static_cast<float>(static_cast<double>(this->occluder_cache_hit_count.load(std::memory_order_relaxed)) / static_cast<double>(shadow_rays));
+}
+
+SplatImage::SplatImage(int width, int height) : width(width), height(height), sums(std::make_unique<std::atomic<std::int64_t>[]>(3 * width * height)) {
+    for(int i = 0; i < 3 * width * height; i++) {
+        this->sums[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void SplatImage::add(int x, int y, Color<float> color) noexcept {
+    assert(x >= 0 && x < this->width && y >= 0 && y < this->height);
+
+    for(int channel = 0; channel < 3; channel++) {
+        if(color[channel] != 0.0F && std::isfinite(color[channel])) {
+            // Clamp before converting, so that single huge contributions cannot overflow the sums
+            auto value = std::clamp(static_cast<double>(color[channel]) * impl::splat_scale, -impl::max_splat_value, impl::max_splat_value);
+            this->sums[3 * (y * this->width + x) + channel].fetch_add(std::llround(value), std::memory_order_relaxed);
+        }
+    }
+}
+
+Color<float> SplatImage::get(int x, int y) const noexcept {
+    auto paths = this->path_count.load(std::memory_order_relaxed);
+    if(paths <= 0) {
+        return {};
+    }
+
+    // Each light path estimates every pixel at once, so the sums are averaged over the light paths traced per pixel
+    auto paths_per_pixel = static_cast<float>(static_cast<double>(paths) / (static_cast<double>(this->width) * this->height));
+
+    const auto *sum = &this->sums[3 * (y * this->width + x)];
+    auto divisor = impl::splat_scale * paths_per_pixel;
+    return {static_cast<float>(static_cast<double>(sum[0].load(std::memory_order_relaxed)) / divisor),
+            static_cast<float>(static_cast<double>(sum[1].load(std::memory_order_relaxed)) / divisor),
+            static_cast<float>(static_cast<double>(sum[2].load(std::memory_order_relaxed)) / divisor), 0.0F};
+}
+
+PhotonMappingState::PhotonMappingState(int width, int height, float radius) :
+  width(width), height(height), pixels(static_cast<std::size_t>(width) * height, PhotonPixel{{}, {}, radius, 0.0F, false}) {}
+
+Color<float> PhotonMappingState::get(int x, int y) const noexcept {
+    assert(x >= 0 && x < this->width && y >= 0 && y < this->height);
+
+    const auto &pixel = this->pixels[y * this->width + x];
+    if(this->pass_count <= 0) {
+        return {};
+    }
+
+    // The gathered flux is a density estimate over the disk of the current radius, averaged over all photons emitted so far
+    auto spectrum = pixel.direct / static_cast<float>(this->pass_count);
+    if(this->emitted_photon_count > 0 && pixel.radius > 0.0F) {
+        auto area = static_cast<float>(M_PI) * pixel.radius * pixel.radius;
+        spectrum = spectrum + pixel.flux / static_cast<float>(static_cast<double>(this->emitted_photon_count) * area);
+    }
+
+    auto color = spectrum.getColor();
+    color[3] = pixel.collected ? 1.0F : 0.0F;
+
+    return color;
+}
+
+float PhotonMappingState::getMaxRadius() const noexcept {
+    float max_radius = 0.0F;
+    for(const auto &pixel : this->pixels) {
+        max_radius = std::max(max_radius, pixel.radius);
+    }
+
+    return max_radius;
+}
+
+WorkItem::WorkItem() noexcept :
+  job(nullptr), offset_x(0), offset_y(0), width(0), height(0), path_guide(nullptr), record_path_guide(false), splat_image(nullptr),
+  photon_state(nullptr), radiance_cache(nullptr), record_radiance_cache(false) {}
 
-WorkItem::WorkItem(const FrameRenderJob *job, int offset_x, int offset_y, int width, int height) noexcept :
-  job(job), offset_x(offset_x), offset_y(offset_y), width(width), height(height) {}
+WorkItem::WorkItem(const FrameRenderJob *job, int offset_x, int offset_y, int width, int height, PathGuide *path_guide, bool record_path_guide,
+                   SplatImage *splat_image, PhotonMappingState *photon_state, RadianceCache *radiance_cache, bool record_radiance_cache) noexcept :
+  job(job),
+  offset_x(offset_x), offset_y(offset_y), width(width), height(height), path_guide(path_guide), record_path_guide(record_path_guide),
+  splat_image(splat_image), photon_state(photon_state), radiance_cache(radiance_cache), record_radiance_cache(record_radiance_cache) {}
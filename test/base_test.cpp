@@ -0,0 +1,87 @@
+#include <PathTrace/base.h>
+#include <PathTrace/sampler.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+TEST(RandomEngineTest, ToFloatTest) { // NOLINT
+    // The extreme bits map to the centers of the first and last intervals, which are strictly inside (0, 1)
+    EXPECT_EQ(RandomEngine::toFloat(0U), 0x1p-24F);
+    EXPECT_EQ(RandomEngine::toFloat(0xFFFFFFFFU), 1.0F - 0x1p-24F);
+    EXPECT_THAT(RandomEngine::toFloat(0U), testing::Gt(0.0F));
+    EXPECT_THAT(RandomEngine::toFloat(0xFFFFFFFFU), testing::Lt(1.0F));
+
+    // Only the upper 23 bits are used, so consecutive intervals are 2^-23 apart
+    EXPECT_EQ(RandomEngine::toFloat(0x1FFU), RandomEngine::toFloat(0U));
+    EXPECT_EQ(RandomEngine::toFloat(0x200U) - RandomEngine::toFloat(0U), 0x1p-23F);
+    EXPECT_EQ(RandomEngine::toFloat(0x80000000U), 0.5F + 0x1p-24F);
+}
+
+TEST(RandomEngineTest, GetFloatsTest) { // NOLINT
+    constexpr std::uint64_t seed = 1234;
+
+    // Without a sequence, pairs of numbers are taken from one 64-bit step of the engine and an odd last number from another step
+    RandomEngine re(seed);
+    xorshift engine(seed);
+
+    auto values = re.getFloats<3>();
+    auto pair = engine.next64();
+    EXPECT_EQ(values[0], RandomEngine::toFloat(static_cast<std::uint32_t>(pair >> 32)));
+    EXPECT_EQ(values[1], RandomEngine::toFloat(static_cast<std::uint32_t>(pair)));
+    EXPECT_EQ(values[2], RandomEngine::toFloat(engine()));
+
+    // Both generators must have consumed the same number of steps
+    EXPECT_EQ(re.getFloat(), RandomEngine::toFloat(engine()));
+}
+
+TEST(RandomEngineTest, SequenceTest) { // NOLINT
+    SobolSampler sampler(1234);
+    RandomEngine re(1234);
+    re.setSequence(&sampler);
+
+    // With a sequence, the i-th number must consume the i-th dimension of the sample, as if drawn by getFloat
+    for(int sample = 0; sample < 8; sample++) {
+        sampler.startSample(3, 5, sample);
+        auto values = re.getFloats<5>();
+        auto pair = re.getFloats<2>();
+
+        sampler.startSample(3, 5, sample);
+        std::array<float, 7> expected_values{};
+        for(float &value : expected_values) {
+            value = re.getFloat();
+        }
+
+        EXPECT_THAT(values, testing::ElementsAreArray(expected_values.data(), 5));
+        EXPECT_THAT(pair, testing::ElementsAre(expected_values[5], expected_values[6]));
+    }
+}
+
+TEST(RandomEngineTest, UniformityTest) { // NOLINT
+    constexpr int bin_count = 16;
+    constexpr int draw_count = 100000;
+
+    RandomEngine re(4321);
+
+    // Every bin of a histogram of numbers drawn singly and in odd-sized groups receives close to its expected share
+    std::vector<int> bins(bin_count, 0);
+    double sum = 0.0;
+    for(int draw = 0; draw < draw_count; draw++) {
+        auto values = re.getFloats<3>();
+        for(float value : {values[0], values[1], values[2], re.getFloat()}) {
+            ASSERT_THAT(value, testing::AllOf(testing::Gt(0.0F), testing::Lt(1.0F)));
+
+            bins[static_cast<int>(value * bin_count)]++;
+            sum += value;
+        }
+    }
+
+    constexpr double expected_count = 4.0 * draw_count / bin_count;
+    for(int bin = 0; bin < bin_count; bin++) {
+        EXPECT_THAT(bins[bin], testing::AllOf(testing::Gt(0.97 * expected_count), testing::Lt(1.03 * expected_count))) << "bin " << bin;
+    }
+    EXPECT_THAT(sum / (4.0 * draw_count), testing::DoubleNear(0.5, 0.005));
+}
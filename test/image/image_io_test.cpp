@@ -8,6 +8,9 @@
 
 #include <random>
 #include <sstream>
+#include <bit>
+#include <cstdint>
+#include <stdexcept>
 
 TEST(ImageIOTest, EncodeDecodeTest) { // NOLINT
     const auto test_image = test::getTestImage();
@@ -38,3 +41,61 @@ TEST(ImageIOTest, EncodeDecodeTest) { // NOLINT
         }
     }
 }
+
+TEST(ImageIOTest, EncodeRegionTest) { // NOLINT
+    const auto test_image = test::getTestImage();
+
+    // A region of an image is encoded like an image holding a copy of the region
+    ImageView<const Color<float>> region = ImageView<const Color<float>>(test_image).getRegion(16, 8, 40, 30);
+    ASSERT_THAT(region.getStride(), testing::Eq(test_image.getWidth()));
+
+    Image<> region_copy(region.getWidth(), region.getHeight());
+    for(int y = 0; y < region.getHeight(); y++) {
+        for(int x = 0; x < region.getWidth(); x++) {
+            ASSERT_THAT(&region(x, y), testing::Eq(&test_image.data()[(y + 8) * test_image.getWidth() + x + 16]));
+            region_copy(x, y) = region(x, y);
+        }
+    }
+
+    std::ostringstream region_stream;
+    io::writeRGBImage(region_stream, region);
+    std::ostringstream copy_stream;
+    io::writeRGBImage(copy_stream, region_copy);
+
+    EXPECT_EQ(region_stream.str(), copy_stream.str());
+}
+
+TEST(ImageIOTest, DecodePFMTest) { // NOLINT
+    // 2x2 little endian RGB image, with rows stored from bottom to top
+    std::vector<float> values = {0.0F, 1.0F, 2.0F, 3.0F, 4.0F, 5.0F, 6.0F, 7.0F, 8.0F, 9.0F, 10.0F, 11.5F};
+
+    std::string data = "PF\n2 2\n-1.0\n";
+    for(float value : values) {
+        auto bits = std::bit_cast<std::uint32_t>(value);
+        for(int i = 0; i < 4; i++) {
+            data.push_back(static_cast<char>((bits >> (8 * i)) & 0xFFU));
+        }
+    }
+
+    std::istringstream istream(data);
+    const auto decoded_image = io::readHDRImage(istream);
+
+    ASSERT_THAT(decoded_image.getWidth(), testing::Eq(2));
+    ASSERT_THAT(decoded_image.getHeight(), testing::Eq(2));
+
+    EXPECT_THAT(decoded_image(0, 1).r(), testing::FloatEq(0.0F));
+    EXPECT_THAT(decoded_image(1, 1).b(), testing::FloatEq(5.0F));
+    EXPECT_THAT(decoded_image(0, 0).g(), testing::FloatEq(7.0F));
+    EXPECT_THAT(decoded_image(1, 0).b(), testing::FloatEq(11.5F));
+    EXPECT_THAT(decoded_image(1, 0).a(), testing::FloatEq(1.0F));
+
+    std::istringstream invalid_stream("P6\n2 2\n255\n");
+    EXPECT_THROW(io::readHDRImage(invalid_stream), std::logic_error); // NOLINT
+
+    // Malformed headers must not allocate memory for pixel data that is not present
+    std::istringstream oversized_stream("PF\n2000000000 2000000000\n-1.0\n");
+    EXPECT_THROW(io::readHDRImage(oversized_stream), std::logic_error); // NOLINT
+
+    std::istringstream truncated_stream("PF\n10000 10000\n-1.0\n" + data);
+    EXPECT_THROW(io::readHDRImage(truncated_stream), std::logic_error); // NOLINT
+}
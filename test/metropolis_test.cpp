@@ -0,0 +1,77 @@
+#include <PathTrace/metropolis.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+TEST(MetropolisTest, ReplayTest) { // NOLINT
+    PrimarySampleSequence sequence(1234, 0.01F, 0.3F);
+    PrimarySampleSequence replayed_sequence(1234, 0.01F, 0.3F);
+
+    // The first path only depends on the seed, which allows chains to start from bootstrap paths
+    for(int i = 0; i < 16; i++) {
+        float sample = sequence.nextSample();
+
+        EXPECT_EQ(replayed_sequence.nextSample(), sample);
+        EXPECT_THAT(sample, testing::AllOf(testing::Ge(0.0F), testing::Lt(1.0F)));
+    }
+}
+
+TEST(MetropolisTest, RejectTest) { // NOLINT
+    constexpr int sample_count = 16;
+
+    // Only small steps, whose perturbations would add up to a random walk if rejected mutations were kept
+    PrimarySampleSequence sequence(1234, 0.01F, 0.0F);
+
+    std::vector<float> samples;
+    for(int i = 0; i < sample_count; i++) {
+        samples.push_back(sequence.nextSample());
+    }
+
+    for(int iteration = 0; iteration < 1000; iteration++) {
+        sequence.startIteration();
+        for(int i = 0; i < sample_count; i++) {
+            sequence.nextSample();
+        }
+        sequence.reject();
+    }
+
+    sequence.startIteration();
+    for(int i = 0; i < sample_count; i++) {
+        float offset = std::abs(sequence.nextSample() - samples[i]);
+
+        // Samples wrap around at the borders of [0, 1)
+        EXPECT_THAT(std::min(offset, 1.0F - offset), testing::Lt(0.06F));
+    }
+}
+
+TEST(MetropolisTest, SmallStepTest) { // NOLINT
+    constexpr float mutation_size = 0.01F;
+    constexpr int iteration_count = 10000;
+
+    PrimarySampleSequence sequence(1234, mutation_size, 0.0F);
+
+    float sample = sequence.nextSample();
+
+    // Accepted small steps perturb the sample by normally distributed offsets with the mutation size as their standard deviation
+    double mean = 0.0;
+    double mean_square = 0.0;
+    for(int iteration = 0; iteration < iteration_count; iteration++) {
+        sequence.startIteration();
+        float mutated_sample = sequence.nextSample();
+        sequence.accept();
+
+        float offset = mutated_sample - sample;
+        offset -= std::round(offset);
+        sample = mutated_sample;
+
+        mean += offset / iteration_count;
+        mean_square += offset * offset / iteration_count;
+    }
+
+    EXPECT_THAT(mean, testing::DoubleNear(0.0, 0.001));
+    EXPECT_THAT(std::sqrt(mean_square), testing::DoubleNear(mutation_size, 0.001));
+}
@@ -0,0 +1,55 @@
+#include <PathTrace/path_guide.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <cmath>
+#include <random>
+
+TEST(PathGuideTest, LearnDirectionTest) { // NOLINT
+    constexpr int sample_count = 20000;
+
+    PathGuide guide({{-1.0F, -1.0F, -1.0F}, {1.0F, 1.0F, 1.0F}}, 1000);
+    EXPECT_FALSE(guide.isTrained());
+
+    vec3<float> light_dir = vec3<float>{0.3F, 0.8F, -0.2F}.normalize();
+
+    RandomEngine re(1234);
+    std::uniform_real_distribution<float> dist(0, 1);
+
+    // Radiance arrives only from a narrow cone around the light direction, with directions sampled uniformly
+    // Each iteration refines the directional trees further, so several iterations are needed to resolve the cone
+    for(int iteration = 0; iteration < 4; iteration++) {
+        for(int i = 0; i < sample_count; i++) {
+            vec3<float> pos{dist(re) * 2.0F - 1.0F, dist(re) * 2.0F - 1.0F, dist(re) * 2.0F - 1.0F};
+
+            float z = 2.0F * dist(re) - 1.0F;
+            float r = std::sqrt(std::max(1.0F - z * z, 0.0F));
+            float phi = 2.0F * static_cast<float>(M_PI) * dist(re);
+            vec3<float> dir{r * std::cos(phi), r * std::sin(phi), z};
+
+            float radiance = dot(dir, light_dir) > 0.95F ? 1.0F : 0.0F;
+            guide.record(pos, dir, radiance * 4.0F * static_cast<float>(M_PI));
+        }
+        guide.update();
+    }
+
+    ASSERT_TRUE(guide.isTrained());
+
+    vec3<float> pos{0.1F, -0.2F, 0.3F};
+    int towards_light_count = 0;
+    for(int i = 0; i < 1000; i++) {
+        auto [dir, pd] = guide.sample(pos, dist(re), dist(re));
+        ASSERT_THAT(pd, testing::Gt(0.0F));
+
+        EXPECT_THAT(dir.getLength(), testing::FloatNear(1.0F, 1E-4F));
+        EXPECT_THAT(guide.getPdf(pos, dir), testing::FloatNear(pd, pd * 1E-3F));
+
+        if(dot(dir, light_dir) > 0.9F) {
+            towards_light_count++;
+        }
+    }
+
+    // The cone covers less than 3% of the sphere, but should receive most of the guided samples
+    EXPECT_THAT(towards_light_count, testing::Gt(800));
+}
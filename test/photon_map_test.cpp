@@ -0,0 +1,85 @@
+#include <PathTrace/photon_map.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <random>
+#include <vector>
+
+TEST(PhotonMapTest, GatherTest) { // NOLINT
+    constexpr float radius = 0.1F;
+
+    RandomEngine re(1234);
+    std::uniform_real_distribution<float> dist(-1, 1);
+
+    std::vector<std::vector<Photon>> batches(4);
+    for(auto &batch : batches) {
+        for(int i = 0; i < 1000; i++) {
+            batch.push_back({{dist(re), dist(re), dist(re)}, {0.0F, 1.0F, 0.0F}, {}});
+        }
+    }
+
+    TaskScheduler scheduler(4);
+    PhotonMap photon_map(batches, radius, scheduler);
+    EXPECT_EQ(photon_map.size(), 4000);
+
+    // Gathering must find every photon within the radius exactly once, including around cells with negative coordinates
+    for(int query = 0; query < 100; query++) {
+        vec3<float> pos = {dist(re), dist(re), dist(re)};
+
+        int expected_count = 0;
+        for(const auto &batch : batches) {
+            for(const Photon &photon : batch) {
+                if((photon.pos - pos).getLengthSquared() <= radius * radius) {
+                    expected_count++;
+                }
+            }
+        }
+
+        int count = 0;
+        photon_map.gather(pos, radius, [&count](const Photon &) { count++; });
+
+        EXPECT_EQ(count, expected_count);
+    }
+}
+
+TEST(PhotonMapTest, OrderTest) { // NOLINT
+    constexpr float radius = 0.2F;
+
+    RandomEngine re(4321);
+    std::uniform_real_distribution<float> dist(-1, 1);
+
+    // Photons are numbered by their power, so that the order in which they are gathered can be compared
+    // There are more photons than groups of buckets, so that each group is sorted into several buckets
+    std::vector<std::vector<Photon>> batches(7);
+    float index = 0.0F;
+    for(auto &batch : batches) {
+        for(int i = 0; i < 2000; i++) {
+            batch.push_back({{dist(re), dist(re), dist(re)}, {0.0F, 1.0F, 0.0F}, Spectrum{Color<float>(index, 0.0F, 0.0F, 1.0F)}});
+            index += 1.0F;
+        }
+    }
+
+    auto gatherAll = [&](int worker_count) {
+        TaskScheduler scheduler(worker_count);
+        PhotonMap photon_map(batches, radius, scheduler);
+
+        std::vector<float> indices;
+        for(int z = -5; z <= 5; z++) {
+            for(int y = -5; y <= 5; y++) {
+                for(int x = -5; x <= 5; x++) {
+                    vec3<float> pos = {static_cast<float>(x) * radius, static_cast<float>(y) * radius, static_cast<float>(z) * radius};
+                    photon_map.gather(pos, radius, [&indices](const Photon &photon) { indices.push_back(photon.power.getColor()[0]); });
+                }
+            }
+        }
+
+        return indices;
+    };
+
+    // The photons of each bucket are stored in the order of the batches, independently of how the batches are split among workers
+    auto indices = gatherAll(1);
+    EXPECT_FALSE(indices.empty());
+    EXPECT_EQ(gatherAll(3), indices);
+    EXPECT_EQ(gatherAll(8), indices);
+}
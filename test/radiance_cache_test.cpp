@@ -0,0 +1,31 @@
+#include <PathTrace/radiance_cache.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+TEST(RadianceCacheTest, RecordTest) { // NOLINT
+    RadianceCache cache(1024, 0.1F);
+
+    vec3<float> pos = {0.25F, -0.32F, 0.5F};
+    vec3<float> up = {0.0F, 1.0F, 0.0F};
+    vec3<float> down = {0.0F, -1.0F, 0.0F};
+
+    for(int i = 0; i < 16; i++) {
+        cache.record(pos + vec3<float>{0.01F, 0.0F, 0.01F} * static_cast<float>(i % 4), up, {i % 2 == 0 ? 1.0F : 3.0F, 0.5F, 0.0F, 1.0F});
+    }
+
+    // Recorded radiance is only available after an update
+    EXPECT_FALSE(std::get<1>(cache.get(pos, up)));
+
+    cache.update();
+
+    auto [radiance, found] = cache.get(pos, up);
+    EXPECT_TRUE(found);
+    EXPECT_THAT(radiance[0], testing::FloatEq(2.0F));
+    EXPECT_THAT(radiance[1], testing::FloatEq(0.5F));
+    EXPECT_THAT(radiance[2], testing::FloatEq(0.0F));
+
+    // Surfaces facing in other directions and other cells are cached separately
+    EXPECT_FALSE(std::get<1>(cache.get(pos, down)));
+    EXPECT_FALSE(std::get<1>(cache.get(pos + vec3<float>{0.1F, 0.0F, 0.0F}, up)));
+}
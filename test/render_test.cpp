@@ -3,11 +3,13 @@
 #include <PathTrace/scene/scene.h>
 #include <PathTrace/scene/object.h>
 #include <PathTrace/scene/light.h>
+#include <PathTrace/scene/mesh.h>
 #include <PathTrace/camera.h>
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <cmath>
 #include <vector>
 #include <memory>
 
@@ -88,3 +90,247 @@ TEST(RenderTest, AdvancedSceneRenderTest) { // NOLINT
     EXPECT_THAT(output_image(0, 0), testing::Eq(Color<float>{0.0F, 0.0F, 0.0F, 0.0F}));
     EXPECT_THAT(output_image(64, 32)[3], testing::Gt(0.0F));
 }
+
+TEST(RenderTest, OccluderCacheRenderTest) { // NOLINT
+    Camera camera({0.0F, 0.0F, 0.0F}, {0.0F, -1.0F, 2.0F}, {0.0F, 1.0F, 0.0F}, 1.0F, 1.0F, 1.0F);
+
+    std::vector<std::unique_ptr<Object>> objects;
+    std::vector<std::unique_ptr<LightSource>> light_sources;
+
+    light_sources.emplace_back(std::make_unique<PointLightSource>(vec3<float>{0.0F, 2.0F, 2.0F}, Color<float>{1.0F, 1.0F, 1.0F, 1.0F}));
+
+    // The sphere casts a shadow onto the ground right below it
+    auto sphere = std::make_unique<Sphere>(vec3<float>{0.0F, 0.0F, 2.0F}, 0.5F);
+    objects.emplace_back(std::move(sphere));
+
+    auto ground = std::make_unique<Triangle>(vec3<float>{5.0F, -1.0F, 5.0F}, vec3<float>{0.0F, -1.0F, -5.0F}, vec3<float>{-5.0F, -1.0F, 5.0F});
+    objects.emplace_back(std::move(ground));
+
+    Scene scene(std::move(objects), std::move(light_sources));
+
+    RenderOptions options{16, 16, 4, 4, 1E-3F};
+
+    RenderStatistics statistics;
+    FrameRenderJob job{camera, scene, options, &statistics};
+
+    processJob(job);
+
+    EXPECT_THAT(statistics.shadow_ray_count.load(), testing::Gt(0));
+    EXPECT_THAT(statistics.occluder_cache_hit_count.load(), testing::Gt(0));
+    EXPECT_THAT(statistics.getOccluderCacheHitRate(), testing::AllOf(testing::Gt(0.0F), testing::Le(1.0F)));
+}
+
+// Adds the faces of the box spanning [-1, 1] on every axis, all oriented towards the inside of the box
+void addInwardBox(std::vector<std::unique_ptr<Object>> &objects, const std::shared_ptr<MaterialHandler> &material_handler) {
+    for(const Triangle &triangle : makeBox(vec3<float>{-1.0F, -1.0F, -1.0F}, vec3<float>{1.0F, 1.0F, 1.0F})) {
+        auto center = (triangle.getA() + triangle.getB() + triangle.getC()) / 3.0F;
+        bool outwards = dot(triangle.getSurfaceNormal(center), center) > 0.0F;
+
+        auto inward_triangle =
+          std::make_unique<Triangle>(triangle.getA(), outwards ? triangle.getC() : triangle.getB(), outwards ? triangle.getB() : triangle.getC());
+        inward_triangle->setMaterialHandler(material_handler);
+        objects.emplace_back(std::move(inward_triangle));
+    }
+}
+
+// Renders a closed box emitting E with albedo a everywhere from the inside, in which the radiance is E / (1 - a) = 0.2 in every direction,
+//  returning the mean of the red channel of the image
+Image<> renderFurnaceBoxImage(const RenderOptions &options, Integrator integrator, RenderContext &context) {
+    Camera camera({0.0F, 0.0F, -0.5F}, {0.0F, 0.0F, 0.0F}, {0.0F, 1.0F, 0.0F}, 1.0F, 1.0F, 1.0F);
+
+    std::vector<std::unique_ptr<Object>> objects;
+    std::vector<std::unique_ptr<LightSource>> light_sources;
+
+    auto box_material = std::make_shared<ConstantMaterial>(Color<float>(0.5F, 0.5F, 0.5F, 1.0F), 1.0F, Spectrum(Color<float>{0.1F, 0.1F, 0.1F, 1.0F}));
+    auto box_material_handler = std::make_shared<ConstantMaterialHandler>(box_material, std::make_shared<LambertianBRDF>());
+
+    addInwardBox(objects, box_material_handler);
+
+    Scene scene(std::move(objects), std::move(light_sources));
+
+    FrameRenderJob job{camera, scene, options, nullptr, integrator};
+
+    return context.render(job);
+}
+
+Image<> renderFurnaceBoxImage(const RenderOptions &options, Integrator integrator, int worker_count = 0) {
+    RenderContext context(worker_count);
+
+    return renderFurnaceBoxImage(options, integrator, context);
+}
+
+float getMeanRed(const Image<> &output_image, const RenderOptions &options) {
+    float mean = 0.0F;
+    for(int y = 0; y < options.image_height; y++) {
+        for(int x = 0; x < options.image_width; x++) {
+            EXPECT_THAT(output_image(x, y)[3], testing::Gt(0.0F));
+
+            mean += output_image(x, y)[0] / static_cast<float>(options.image_width * options.image_height);
+        }
+    }
+
+    return mean;
+}
+
+float renderFurnaceBox(const RenderOptions &options, Integrator integrator) {
+    return getMeanRed(renderFurnaceBoxImage(options, integrator), options);
+}
+
+// Renders a closed, non-emissive box with albedo 0.5 lit only by a small emissive sphere inside of it, returning the mean of the red channel of the image
+float renderSphereLitBox(const RenderOptions &options, Integrator integrator) {
+    Camera camera({0.0F, 0.0F, -0.9F}, {0.0F, 0.0F, 1.0F}, {0.0F, 1.0F, 0.0F}, 1.0F, 1.0F, 1.0F);
+
+    std::vector<std::unique_ptr<Object>> objects;
+    std::vector<std::unique_ptr<LightSource>> light_sources;
+
+    auto lambertian_bsdf = std::make_shared<LambertianBRDF>();
+
+    auto box_material = std::make_shared<ConstantMaterial>(Color<float>(0.5F, 0.5F, 0.5F, 1.0F));
+    addInwardBox(objects, std::make_shared<ConstantMaterialHandler>(box_material, lambertian_bsdf));
+
+    // Light emitted into the sphere would escape through its surface, as rays leaving its inside do not intersect it
+    auto sphere = std::make_unique<Sphere>(vec3<float>{0.0F, 0.6F, 0.5F}, 0.2F);
+    auto sphere_material = std::make_shared<ConstantMaterial>(Color<float>(0.0F, 0.0F, 0.0F, 1.0F), 1.0F, Spectrum(Color<float>{1.0F, 1.0F, 1.0F, 1.0F}));
+    sphere->setMaterialHandler(std::make_shared<ConstantMaterialHandler>(sphere_material, lambertian_bsdf));
+    objects.emplace_back(std::move(sphere));
+
+    Scene scene(std::move(objects), std::move(light_sources));
+
+    FrameRenderJob job{camera, scene, options, nullptr, integrator};
+
+    return getMeanRed(processJob(job), options);
+}
+
+TEST(RenderTest, RadianceCacheRenderTest) { // NOLINT
+    RenderOptions options{8, 8, 16, 16, 1E-3F};
+    options.allow_bias = true;
+    options.radiance_cache_size = 1 << 18;
+
+    EXPECT_THAT(renderFurnaceBox(options, Integrator::PathTracing), testing::FloatNear(0.2F, 0.01F));
+}
+
+TEST(RenderTest, PathGuidingRenderTest) { // NOLINT
+    RenderOptions options{8, 8, 64, 64, 1E-3F};
+    options.path_guiding = true;
+
+    EXPECT_THAT(renderFurnaceBox(options, Integrator::PathTracing), testing::FloatNear(0.2F, 0.01F));
+
+    // Radiance arriving from the sphere is far from uniform, so that guided sampling differs from BSDF sampling
+    RenderOptions reference_options{8, 8, 64, 64, 1E-3F};
+    auto reference = renderSphereLitBox(reference_options, Integrator::PathTracing);
+
+    EXPECT_THAT(renderSphereLitBox(options, Integrator::PathTracing), testing::FloatNear(reference, 0.03F * reference));
+}
+
+TEST(RenderTest, MaxPathLengthRenderTest) { // NOLINT
+    constexpr float emission = 0.1F;
+    constexpr float albedo = 0.5F;
+
+    // Paths of at most L vertices collect the emission of L + 1 vertices, including the one reached by sampling the lights at the last vertex,
+    //  so the radiance is E (1 - a^(L + 1)) / (1 - a), which is underestimated if the light samples at the last vertex are weighted against BSDF sampling
+    for(int max_path_length : {1, 2, 3}) {
+        RenderOptions options{8, 8, 64, 64, 1E-3F};
+        options.max_path_length = max_path_length;
+
+        float expected = emission * (1.0F - std::pow(albedo, static_cast<float>(max_path_length + 1))) / (1.0F - albedo);
+        EXPECT_THAT(renderFurnaceBox(options, Integrator::PathTracing), testing::FloatNear(expected, 0.003F)) << "max path length " << max_path_length;
+    }
+}
+
+TEST(RenderTest, ResampledDirectLightingRenderTest) { // NOLINT
+    RenderOptions options{8, 8, 64, 64, 1E-3F};
+
+    auto reference = renderFurnaceBox(options, Integrator::PathTracing);
+
+    // Resampled light samples account for all emission they can reach, so emission found by BSDF sampling has to be ignored to not count it twice
+    options.direct_lighting = DirectLighting::Resampled;
+    auto resampled = renderFurnaceBox(options, Integrator::PathTracing);
+
+    EXPECT_THAT(resampled, testing::FloatNear(0.2F, 0.01F));
+    EXPECT_THAT(resampled, testing::FloatNear(reference, 0.01F));
+}
+
+TEST(RenderTest, MultipleImportanceSamplingRenderTest) { // NOLINT
+    RenderOptions options{8, 8, 64, 64, 1E-3F};
+
+    auto reference = renderSphereLitBox(options, Integrator::PathTracing);
+
+    // Without MIS, emission that light sampling can find is only collected by light sampling, which gives the same expected image
+    options.multiple_importance_sampling = false;
+
+    EXPECT_THAT(renderSphereLitBox(options, Integrator::PathTracing), testing::FloatNear(reference, 0.03F * reference));
+}
+
+TEST(RenderTest, BidirectionalRenderTest) { // NOLINT
+    RenderOptions options{8, 8, 64, 64, 1E-3F};
+
+    EXPECT_THAT(renderFurnaceBox(options, Integrator::Bidirectional), testing::FloatNear(0.2F, 0.01F));
+}
+
+TEST(RenderTest, BidirectionalSphereEmitterRenderTest) { // NOLINT
+    RenderOptions options{8, 8, 64, 64, 1E-3F};
+
+    auto reference = renderSphereLitBox(options, Integrator::PathTracing);
+
+    EXPECT_THAT(renderSphereLitBox(options, Integrator::Bidirectional), testing::FloatNear(reference, 0.03F * reference));
+}
+
+TEST(RenderTest, PhotonMappingRenderTest) { // NOLINT
+    RenderOptions options{8, 8, 16, 16, 1E-3F};
+    options.photon_count = 20000;
+    options.photon_radius = 0.1F;
+
+    EXPECT_THAT(renderFurnaceBox(options, Integrator::PhotonMapping), testing::FloatNear(0.2F, 0.01F));
+}
+
+TEST(RenderTest, PhotonMappingSphereEmitterRenderTest) { // NOLINT
+    RenderOptions options{8, 8, 16, 16, 1E-3F};
+    options.photon_count = 5000;
+    options.photon_radius = 0.1F;
+
+    RenderOptions reference_options{8, 8, 64, 64, 1E-3F};
+    auto reference = renderSphereLitBox(reference_options, Integrator::PathTracing);
+
+    EXPECT_THAT(renderSphereLitBox(options, Integrator::PhotonMapping), testing::FloatNear(reference, 0.03F * reference));
+}
+
+TEST(RenderTest, MetropolisRenderTest) { // NOLINT
+    RenderOptions options{8, 8, 64, 64, 1E-3F};
+    options.bootstrap_sample_count = 10000;
+    options.metropolis_chain_count = 64;
+
+    EXPECT_THAT(renderFurnaceBox(options, Integrator::Metropolis), testing::FloatNear(0.2F, 0.01F));
+}
+
+TEST(RenderTest, DeterministicRenderTest) { // NOLINT
+    RenderOptions options{8, 8, 4, 4, 1E-3F};
+    options.photon_count = 10000;
+    options.photon_radius = 0.1F;
+    options.bootstrap_sample_count = 1000;
+    options.metropolis_chain_count = 16;
+
+    RenderOptions other_seed_options = options;
+    other_seed_options.seed = 1;
+
+    // All parallel renders reuse the workers of the same context
+    RenderContext context(3);
+
+    for(auto integrator : {Integrator::PathTracing, Integrator::Bidirectional, Integrator::PhotonMapping, Integrator::Metropolis}) {
+        auto image = renderFurnaceBoxImage(options, integrator, 1);
+        auto parallel_image = renderFurnaceBoxImage(options, integrator, context);
+        auto other_seed_image = renderFurnaceBoxImage(other_seed_options, integrator, context);
+
+        // Images only depend on the seed, not on the number of workers
+        bool other_seed_differs = false;
+        for(int y = 0; y < options.image_height; y++) {
+            for(int x = 0; x < options.image_width; x++) {
+                for(int channel = 0; channel < 4; channel++) {
+                    EXPECT_EQ(parallel_image(x, y)[channel], image(x, y)[channel]);
+                    other_seed_differs = other_seed_differs || other_seed_image(x, y)[channel] != image(x, y)[channel];
+                }
+            }
+        }
+
+        EXPECT_TRUE(other_seed_differs);
+    }
+}
@@ -0,0 +1,132 @@
+#include <PathTrace/sampler.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <set>
+#include <utility>
+#include <vector>
+
+TEST(SamplerTest, SobolStratificationTest) { // NOLINT
+    SobolSampler sampler(1234);
+
+    // Every pair of dimensions of the first 16 samples has one point in each cell of a 4x4 grid, and in each of 16 rows or columns
+    for(int pair = 0; pair < 4; pair++) {
+        std::set<std::pair<std::uint32_t, std::uint32_t>> grid_cells;
+        std::set<std::uint32_t> rows;
+        std::set<std::uint32_t> columns;
+
+        for(int sample = 0; sample < 16; sample++) {
+            sampler.startSample(3, 5, sample);
+            for(int dimension = 0; dimension < 2 * pair; dimension++) {
+                sampler.next();
+            }
+
+            auto u = sampler.next();
+            auto v = sampler.next();
+
+            grid_cells.emplace(u >> 30, v >> 30);
+            columns.insert(u >> 28);
+            rows.insert(v >> 28);
+        }
+
+        EXPECT_EQ(grid_cells.size(), 16);
+        EXPECT_EQ(columns.size(), 16);
+        EXPECT_EQ(rows.size(), 16);
+    }
+}
+
+TEST(SamplerTest, FixedDimensionTest) { // NOLINT
+    SobolSampler sampler(1234);
+
+    sampler.startSample(3, 5, 7);
+    sampler.next();
+    sampler.next();
+    auto expected = sampler.next();
+
+    // A dimension gives the same number no matter how many numbers were drawn before it, and independent numbers consume no dimension
+    sampler.startSample(3, 5, 7);
+    for(int i = 0; i < 5; i++) {
+        sampler.next();
+        sampler.nextIndependent();
+    }
+    sampler.setDimension(2);
+    EXPECT_EQ(sampler.next(), expected);
+
+    sampler.startSample(3, 5, 7);
+    sampler.nextIndependent();
+    sampler.nextIndependent();
+    EXPECT_EQ(sampler.getDimension(), 0);
+    sampler.next();
+    sampler.next();
+    EXPECT_EQ(sampler.next(), expected);
+
+    // Independent numbers depend on the sample, but not on the dimension
+    sampler.startSample(3, 5, 7);
+    auto independent = sampler.nextIndependent();
+    sampler.startSample(3, 5, 7);
+    sampler.setDimension(9);
+    EXPECT_EQ(sampler.nextIndependent(), independent);
+    sampler.startSample(3, 5, 8);
+    EXPECT_NE(sampler.nextIndependent(), independent);
+}
+
+TEST(SamplerTest, HaltonStratificationTest) { // NOLINT
+    HaltonSampler sampler(1234);
+
+    // The first 8 samples of the first dimension fall into different eighths, and the first 9 samples of the second dimension into different ninths
+    std::set<std::uint64_t> eighths;
+    std::set<std::uint64_t> ninths;
+    for(int sample = 0; sample < 9; sample++) {
+        sampler.startSample(3, 5, sample);
+
+        auto u = static_cast<std::uint64_t>(sampler.next());
+        auto v = static_cast<std::uint64_t>(sampler.next());
+
+        if(sample < 8) {
+            eighths.insert(u * 8 >> 32);
+        }
+        ninths.insert(v * 9 >> 32);
+    }
+
+    EXPECT_EQ(eighths.size(), 8);
+    EXPECT_EQ(ninths.size(), 9);
+}
+
+TEST(SamplerTest, BlueNoiseTest) { // NOLINT
+    constexpr int size = 64;
+
+    BlueNoiseSampler sampler(1234);
+
+    // The first samples of a tile of pixels cover the intervals of all ranks of the mask, and their averages over blocks of 4x4 pixels
+    //  vary far less than those of independent random numbers would, whose variance is 1 / (12 * 16)
+    std::set<std::uint32_t> intervals;
+    std::vector<double> values(size * size);
+    for(int y = 0; y < size; y++) {
+        for(int x = 0; x < size; x++) {
+            sampler.startSample(x, y, 0);
+
+            auto value = sampler.next();
+            intervals.insert(value >> 20);
+            values[y * size + x] = static_cast<double>(value) / 4294967296.0;
+        }
+    }
+
+    EXPECT_EQ(intervals.size(), size * size);
+
+    double block_variance = 0.0;
+    for(int block_y = 0; block_y < size / 4; block_y++) {
+        for(int block_x = 0; block_x < size / 4; block_x++) {
+            double block_mean = 0.0;
+            for(int y = 0; y < 4; y++) {
+                for(int x = 0; x < 4; x++) {
+                    block_mean += values[(4 * block_y + y) * size + 4 * block_x + x] / 16.0;
+                }
+            }
+
+            block_variance += (block_mean - 0.5) * (block_mean - 0.5) / ((size / 4) * (size / 4));
+        }
+    }
+
+    EXPECT_THAT(block_variance, testing::Lt(0.5 / (12.0 * 16.0)));
+}
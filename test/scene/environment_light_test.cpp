@@ -0,0 +1,50 @@
+#include <PathTrace/scene/environment_light.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <cmath>
+
+TEST(EnvironmentLightTest, ImportanceSampleTest) { // NOLINT
+    constexpr int sample_count = 20000;
+    constexpr float pi = static_cast<float>(M_PI);
+
+    // Dim environment with a small bright region
+    Image<> image(16, 8);
+    for(int y = 0; y < image.getHeight(); y++) {
+        for(int x = 0; x < image.getWidth(); x++) {
+            image(x, y) = {0.1F, 0.1F, 0.1F, 1.0F};
+        }
+    }
+    image(5, 2) = {50.0F, 40.0F, 30.0F, 1.0F};
+
+    EnvironmentLight light(std::move(image));
+    light.setSceneBounds({0.0F, 0.0F, 0.0F}, 1.0F);
+
+    // Integral of the red channel over the sphere of directions
+    float bright_solid_angle = 2.0F * pi / 16.0F * (std::cos(2.0F * pi / 8.0F) - std::cos(3.0F * pi / 8.0F));
+    float expected_integral = 0.1F * (4.0F * pi - bright_solid_angle) + 50.0F * bright_solid_angle;
+
+    RandomEngine re(1234);
+    vec3<float> pos{0.2F, -0.3F, 0.1F};
+
+    float integral = 0.0F;
+    int mismatch_count = 0;
+    for(int i = 0; i < sample_count; i++) {
+        auto [target, pd] = light.importanceSample(pos, re);
+        ASSERT_THAT(pd, testing::Gt(0.0F));
+
+        // Samples should be placed outside of the scene
+        EXPECT_THAT((target - pos).getLength(), testing::Gt(1.0F));
+
+        auto dir = (target - pos).normalize();
+        // Directions recovered from the sampled point may round into a neighboring pixel
+        if(std::abs(light.getPdf(pos, dir) - pd) > pd * 1E-3F) {
+            mismatch_count++;
+        }
+
+        integral += light.getSpectrum({pos, dir}).getColor()[0] / pd;
+    }
+    EXPECT_THAT(mismatch_count, testing::Lt(sample_count / 1000));
+    EXPECT_THAT(integral / sample_count, testing::FloatNear(expected_integral, expected_integral * 1E-2F));
+}
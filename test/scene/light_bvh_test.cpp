@@ -0,0 +1,59 @@
+#include <PathTrace/scene/light_bvh.h>
+#include <PathTrace/scene/object.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <random>
+#include <vector>
+
+TEST(LightBVHTest, ProbabilityTest) { // NOLINT
+    RandomEngine re(1234);
+    std::uniform_real_distribution<float> dist(-1.0F, 1.0F);
+
+    std::vector<Triangle> triangles;
+    std::vector<const Object *> emitters;
+    std::vector<float> powers;
+
+    triangles.reserve(64);
+    for(int i = 0; i < 64; i++) {
+        vec3<float> center = vec3<float>{dist(re), dist(re), dist(re)} * 4.0F;
+        triangles.emplace_back(center + vec3<float>{dist(re), dist(re), dist(re)} * 0.3F, center + vec3<float>{dist(re), dist(re), dist(re)} * 0.3F,
+                               center + vec3<float>{dist(re), dist(re), dist(re)} * 0.3F, i % 2 == 0);
+    }
+    for(const auto &triangle : triangles) {
+        emitters.push_back(&triangle);
+        powers.push_back(triangle.getSurfaceArea() * (1.5F + dist(re)));
+    }
+
+    LightBVH light_bvh(emitters, powers);
+    EXPECT_FALSE(light_bvh.empty());
+
+    for(int i = 0; i < 32; i++) {
+        vec3<float> pos = vec3<float>{dist(re), dist(re), dist(re)} * 6.0F;
+        vec3<float> n = vec3<float>{dist(re), dist(re), dist(re)}.normalize();
+
+        float total_probability = 0.0F;
+        for(int emitter_index = 0; emitter_index < static_cast<int>(emitters.size()); emitter_index++) {
+            auto probability = light_bvh.getProbability(pos, n, emitter_index);
+            EXPECT_THAT(probability, testing::Ge(0.0F));
+
+            // Every emitter that may illuminate the point must be chosen with non-zero probability
+            auto [axis, cos_theta_o, two_sided] = emitters[emitter_index]->getNormalBounds();
+            LightBounds light_bounds = {emitters[emitter_index]->getBoundingVolume(), axis, cos_theta_o, 0.0F, powers[emitter_index], two_sided};
+            if(light_bounds.getImportance(pos, n) > 0.0F) {
+                EXPECT_THAT(probability, testing::Gt(0.0F)) << "pos=" << i << ", emitter=" << emitter_index;
+            }
+
+            total_probability += probability;
+        }
+
+        // Probability is lost only where no emitter of a subtree can illuminate the point
+        EXPECT_THAT(total_probability, testing::Le(1.0F + 1E-4F)) << "pos=" << i;
+
+        auto [emitter_index, probability] = light_bvh.sample(pos, n, (dist(re) + 1.0F) / 2.0F);
+        if(emitter_index >= 0) {
+            EXPECT_THAT(probability, testing::FloatNear(light_bvh.getProbability(pos, n, emitter_index), 1E-5F)) << "pos=" << i;
+        }
+    }
+}
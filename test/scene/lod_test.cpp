@@ -0,0 +1,77 @@
+#include <PathTrace/scene/lod.h>
+#include <PathTrace/scene/mesh.h>
+#include <PathTrace/camera.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <vector>
+
+namespace {
+
+    std::vector<Triangle> makeGrid(int resolution) {
+        std::vector<Triangle> triangles;
+
+        for(int z = 0; z < resolution; z++) {
+            for(int x = 0; x < resolution; x++) {
+                auto x0 = static_cast<float>(x) / static_cast<float>(resolution);
+                auto x1 = static_cast<float>(x + 1) / static_cast<float>(resolution);
+                auto z0 = static_cast<float>(z) / static_cast<float>(resolution);
+                auto z1 = static_cast<float>(z + 1) / static_cast<float>(resolution);
+
+                auto cell = makePlane(vec3<float>(x0, 0.0F, z0), vec3<float>(x1, 0.0F, z1));
+                triangles.insert(triangles.end(), cell.begin(), cell.end());
+            }
+        }
+
+        return triangles;
+    }
+
+}
+
+TEST(LODTest, SimplifyPlaneTest) { // NOLINT
+    auto triangles = makeGrid(16);
+
+    auto simplified = simplifyMesh(triangles, 32);
+
+    EXPECT_THAT(simplified.size(), testing::Gt(0));
+    EXPECT_THAT(simplified.size(), testing::Le(32));
+
+    for(const auto &triangle : simplified) {
+        // Simplifying a flat plane should keep all vertices on the plane and inside the boundary
+        for(const auto &vertex : {triangle.getA(), triangle.getB(), triangle.getC()}) {
+            EXPECT_THAT(vertex[1], testing::FloatNear(0.0F, 1E-4F));
+            EXPECT_THAT(vertex[0], testing::AllOf(testing::Ge(-1E-4F), testing::Le(1.0F + 1E-4F)));
+            EXPECT_THAT(vertex[2], testing::AllOf(testing::Ge(-1E-4F), testing::Le(1.0F + 1E-4F)));
+        }
+    }
+}
+
+TEST(LODTest, SelectLevelTest) { // NOLINT
+    MeshLODChain chain(makeGrid(32), 4, 0.25F, 16);
+
+    EXPECT_THAT(chain.getLevelCount(), testing::Gt(1));
+
+    for(int level = 1; level < chain.getLevelCount(); level++) {
+        EXPECT_THAT(chain.getLevel(level).size(), testing::Lt(chain.getLevel(level - 1).size()));
+    }
+
+    Camera close_camera({0.5F, 1.0F, 0.5F}, {0.5F, 0.0F, 0.5F}, {0.0F, 0.0F, 1.0F}, 1.0F, 1.0F, 1.0F);
+    Camera far_camera({0.5F, 1000.0F, 0.5F}, {0.5F, 0.0F, 0.5F}, {0.0F, 0.0F, 1.0F}, 1.0F, 1.0F, 1.0F);
+
+    EXPECT_THAT(chain.selectLevel(close_camera, 1024), testing::Eq(0));
+    EXPECT_THAT(chain.selectLevel(far_camera, 1024), testing::Eq(chain.getLevelCount() - 1));
+}
+
+TEST(LODTest, TriangleCountTest) { // NOLINT
+    auto triangles = makeGrid(32);
+
+    Camera close_camera({0.5F, 1.0F, 0.5F}, {0.5F, 0.0F, 0.5F}, {0.0F, 0.0F, 1.0F}, 1.0F, 1.0F, 1.0F);
+    Camera far_camera({0.5F, 1000.0F, 0.5F}, {0.5F, 0.0F, 0.5F}, {0.0F, 0.0F, 1.0F}, 1.0F, 1.0F, 1.0F);
+
+    EXPECT_THAT(getLODTriangleCount(triangles, close_camera, 1024), testing::Eq(static_cast<int>(triangles.size())));
+
+    auto far_count = getLODTriangleCount(triangles, far_camera, 1024);
+    EXPECT_THAT(far_count, testing::Ge(1));
+    EXPECT_THAT(far_count, testing::Lt(static_cast<int>(triangles.size()) / 4));
+}
@@ -0,0 +1,72 @@
+#include <PathTrace/scene/object.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <cmath>
+
+TEST(ObjectTest, SolidAngleSamplingTest) { // NOLINT
+    constexpr int sample_count = 20000;
+
+    RandomEngine re(1234);
+    vec3<float> from{0.2F, 0.1F, -2.0F};
+
+    Sphere sphere({0.0F, 0.0F, 0.0F}, 0.5F);
+    Triangle triangle({-1.0F, -1.0F, 0.5F}, {1.0F, -1.0F, 0.5F}, {0.0F, 1.0F, 0.5F});
+
+    // The expected value of the reciprocal density is the solid angle covered by the samples
+    auto sin2_theta_max = 0.25F / from.getLengthSquared();
+    auto sphere_solid_angle = 2.0F * static_cast<float>(M_PI) * (1.0F - std::sqrt(1.0F - sin2_theta_max));
+
+    float sphere_estimate = 0.0F;
+    for(int i = 0; i < sample_count; i++) {
+        auto [pos, p, cull] = sphere.sampleSurface(from, re);
+        ASSERT_THAT(p, testing::Gt(0.0F));
+
+        // Samples should only be taken on the visible side of the sphere
+        EXPECT_THAT(pos.getLength(), testing::FloatNear(0.5F, 1E-4F));
+        EXPECT_THAT(dot(pos, from - pos), testing::Ge(-1E-4F));
+        EXPECT_THAT(sphere.getSamplePdf(from, pos), testing::FloatNear(p, p * 1E-4F));
+
+        sphere_estimate += 1.0F / p;
+    }
+    EXPECT_THAT(sphere_estimate / sample_count, testing::FloatNear(sphere_solid_angle, sphere_solid_angle * 1E-3F));
+
+    float triangle_estimate = 0.0F;
+    float triangle_area_estimate = 0.0F;
+    for(int i = 0; i < sample_count; i++) {
+        auto [pos, p, cull] = triangle.sampleSurface(from, re);
+        ASSERT_THAT(p, testing::Gt(0.0F));
+
+        EXPECT_THAT(pos[2], testing::FloatNear(0.5F, 1E-4F));
+        EXPECT_THAT(triangle.getSamplePdf(from, pos), testing::FloatNear(p, p * 1E-4F));
+
+        triangle_estimate += 1.0F / p;
+
+        // Compare against area sampling converted to solid angle
+        auto [area_pos, area_p, area_cull] = triangle.sampleSurface(re);
+        auto to_surface = area_pos - from;
+        triangle_area_estimate += std::abs(to_surface.normalize()[2]) / (area_p * to_surface.getLengthSquared());
+    }
+    EXPECT_THAT(triangle_estimate / sample_count, testing::FloatNear(triangle_area_estimate / sample_count, triangle_area_estimate / sample_count * 2E-2F));
+}
+
+TEST(ObjectTest, TriangleTest) { // NOLINT
+    vec3<float> a{0.3F, -0.2F, 1.1F};
+    vec3<float> b{1.7F, 0.4F, 0.2F};
+    vec3<float> c{-0.5F, 1.3F, 0.8F};
+    Triangle triangle(a, b, c);
+
+    EXPECT_EQ(triangle.getA(), a);
+    EXPECT_EQ(triangle.getB(), b);
+    EXPECT_EQ(triangle.getC(), c);
+    EXPECT_THAT(triangle.getSurfaceArea(), testing::FloatNear(cross(b - a, c - a).getLength() / 2.0F, 1E-5F));
+
+    // Rays towards points given by barycentric coordinates hit the triangle at the expected distance if the point lies inside of it
+    vec3<float> origin{0.1F, 0.2F, -3.0F};
+    auto inside = a + (b - a) * 0.2F + (c - a) * 0.3F;
+    auto outside = a + (b - a) * 0.7F + (c - a) * 0.6F;
+
+    EXPECT_THAT(triangle.getIntersection({origin, (inside - origin).normalize()}), testing::FloatNear((inside - origin).getLength(), 1E-4F));
+    EXPECT_THAT(triangle.getIntersection({origin, (outside - origin).normalize()}), testing::Lt(0.0F));
+}
@@ -4,6 +4,8 @@
 #include <gmock/gmock.h>
 
 #include <memory>
+#include <random>
+#include <vector>
 
 TEST(SceneTest, IntersectionTest) { // NOLINT
     std::vector<std::unique_ptr<Object>> objects;
@@ -45,3 +47,76 @@ TEST(SceneTest, IntersectionTest) { // NOLINT
         EXPECT_THAT(t, testing::Lt(0.0F));
     }
 }
+
+TEST(SceneTest, LazyIntersectionTest) { // NOLINT
+    std::vector<std::unique_ptr<Object>> objects;
+    std::vector<std::unique_ptr<Object>> lazy_objects;
+
+    RandomEngine re(1234);
+    std::uniform_real_distribution<float> dist(-1.0F, 1.0F);
+
+    for(int i = 0; i < 256; i++) {
+        auto sphere = Sphere(vec3<float>(dist(re), dist(re), dist(re)) * 5.0F, 0.1F + 0.1F * std::abs(dist(re)));
+
+        objects.push_back(std::make_unique<Sphere>(sphere));
+        lazy_objects.push_back(std::make_unique<Sphere>(sphere));
+    }
+
+    SceneOptions lazy_options;
+    lazy_options.lazy_bvh = true;
+    lazy_options.eager_bvh_depth = 2;
+
+    Scene scene = Scene(std::move(objects), {});
+    Scene lazy_scene = Scene(std::move(lazy_objects), {}, lazy_options);
+
+    for(int i = 0; i < 256; i++) {
+        Ray ray = Ray{vec3<float>(dist(re), dist(re), dist(re)) * 8.0F, vec3<float>(dist(re), dist(re), dist(re)).normalize()};
+
+        auto [t, intersected] = scene.getIntersection(ray);
+        auto [lazy_t, lazy_intersected] = lazy_scene.getIntersection(ray);
+
+        EXPECT_THAT(lazy_t >= 0.0F, testing::Eq(t >= 0.0F)) << "ray=" << i;
+        if(t >= 0.0F && lazy_t >= 0.0F) {
+            EXPECT_THAT(lazy_t, testing::FloatEq(t)) << "ray=" << i;
+        }
+    }
+}
+
+TEST(SceneTest, LightSampleCountTest) { // NOLINT
+    constexpr int light_source_count = 100;
+    constexpr int iteration_count = 20000;
+
+    std::vector<std::unique_ptr<Object>> objects;
+    std::vector<std::unique_ptr<LightSource>> light_sources;
+
+    float total_intensity = 0.0F;
+    for(int i = 0; i < light_source_count; i++) {
+        auto intensity = 0.01F * static_cast<float>(i + 1);
+        total_intensity += intensity;
+
+        light_sources.push_back(
+          std::make_unique<PointLightSource>(vec3<float>(static_cast<float>(i), 1.0F, 0.0F), Color<float>{intensity, intensity, intensity, 1.0F}));
+    }
+
+    SceneOptions options;
+    options.light_sample_count = 2;
+
+    Scene scene(std::move(objects), std::move(light_sources), options);
+    EXPECT_THAT(scene.getMaxLightSampleCount(), testing::Eq(2));
+
+    RandomEngine re(1234);
+    std::vector<LightSample> lights(scene.getMaxLightSampleCount());
+
+    // Weighting each sample by its density should estimate the total intensity of all light sources
+    double estimate = 0.0;
+    for(int i = 0; i < iteration_count; i++) {
+        int light_count = scene.sampleLights(vec3<float>(0.0F, 0.0F, 0.0F), vec3<float>(0.0F, 1.0F, 0.0F), re, lights);
+        ASSERT_THAT(light_count, testing::Le(2));
+
+        for(int j = 0; j < light_count; j++) {
+            estimate += lights[j].spectrum.getColor()[0] / lights[j].pd;
+        }
+    }
+
+    EXPECT_THAT(estimate / iteration_count, testing::DoubleNear(total_intensity, total_intensity * 1E-3));
+}
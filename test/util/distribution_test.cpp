@@ -0,0 +1,32 @@
+#include <PathTrace/util/distribution.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <vector>
+
+TEST(AliasTableTest, SampleTest) { // NOLINT
+    std::vector<float> weights = {1.0F, 0.0F, 3.0F, 4.0F, 2.0F};
+    AliasTable table(weights);
+
+    ASSERT_THAT(table.size(), testing::Eq(5));
+
+    constexpr int sample_count = 10000;
+    std::vector<int> counts(weights.size(), 0);
+
+    for(int i = 0; i < sample_count; i++) {
+        float u = (static_cast<float>(i) + 0.5F) / static_cast<float>(sample_count);
+        auto [index, p] = table.sample(u);
+
+        ASSERT_THAT(index, testing::AllOf(testing::Ge(0), testing::Lt(table.size())));
+        EXPECT_THAT(p, testing::FloatEq(table.getProbability(index)));
+
+        counts[index]++;
+    }
+
+    for(int i = 0; i < table.size(); i++) {
+        EXPECT_THAT(table.getProbability(i), testing::FloatNear(weights[i] / 10.0F, 1E-6F));
+        // Stratified inputs should reproduce the distribution almost exactly
+        EXPECT_THAT(static_cast<float>(counts[i]) / sample_count, testing::FloatNear(weights[i] / 10.0F, 1E-3F));
+    }
+}
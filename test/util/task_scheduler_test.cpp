@@ -0,0 +1,69 @@
+#include <PathTrace/util/task_scheduler.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+TEST(TaskSchedulerTest, DequeOrderTest) { // NOLINT
+    constexpr int task_count = 200;
+
+    // More tasks than the initial capacity, so that the deque grows while holding tasks
+    WorkStealingDeque deque(16);
+    for(int task = 0; task < task_count; task++) {
+        deque.push(task);
+    }
+
+    // The owner takes the tasks pushed last, while thieves take the tasks pushed first
+    EXPECT_EQ(deque.pop(), task_count - 1);
+    EXPECT_EQ(std::get<0>(deque.steal()), 0);
+    EXPECT_EQ(std::get<0>(deque.steal()), 1);
+
+    for(int task = task_count - 2; task >= 2; task--) {
+        ASSERT_EQ(deque.pop(), task);
+    }
+
+    EXPECT_EQ(deque.pop(), WorkStealingDeque::empty);
+    EXPECT_THAT(deque.steal(), testing::FieldsAre(WorkStealingDeque::empty, true));
+}
+
+TEST(TaskSchedulerTest, RunTest) { // NOLINT
+    constexpr int worker_count = 8;
+    constexpr int task_count = 800;
+    constexpr int slow_task_count = 50;
+
+    TaskScheduler scheduler(worker_count);
+    ASSERT_EQ(scheduler.getWorkerCount(), worker_count);
+
+    // Schedulers are reused, so every task must be run exactly once in each run
+    for(int run = 0; run < 2; run++) {
+        auto counts = std::make_unique<std::atomic<int>[]>(task_count);
+        for(int task = 0; task < task_count; task++) {
+            counts[task].store(0);
+        }
+        std::atomic<int> stolen_slow_tasks = 0;
+
+        // The first worker starts with all slow tasks, so that the other workers finish their own tasks first and steal them
+        scheduler.run(task_count, [&](int task, int worker) {
+            ASSERT_THAT(worker, testing::AllOf(testing::Ge(0), testing::Lt(worker_count)));
+
+            if(task < slow_task_count) {
+                std::this_thread::sleep_for(std::chrono::microseconds(500));
+
+                if(worker != 0) {
+                    stolen_slow_tasks.fetch_add(1);
+                }
+            }
+
+            counts[task].fetch_add(1);
+        });
+
+        for(int task = 0; task < task_count; task++) {
+            EXPECT_EQ(counts[task].load(), 1) << "task " << task;
+        }
+        EXPECT_THAT(stolen_slow_tasks.load(), testing::Gt(0));
+    }
+}